@@ -264,4 +264,23 @@ namespace hmssql {
       return fmt::format("USE {}", database_name_);
     }
   };
+
+  class TransactionStatement : public BoundStatement {
+    public:
+    explicit TransactionStatement(TransactionStatementKind kind)
+        : BoundStatement(StatementType::TRANSACTION_STATEMENT), kind_(kind) {}
+
+    TransactionStatementKind kind_;
+
+    auto ToString() const -> std::string override {
+      switch (kind_) {
+        case TransactionStatementKind::BEGIN:
+          return "BEGIN";
+        case TransactionStatementKind::COMMIT:
+          return "COMMIT";
+        default:
+          return "ROLLBACK";
+      }
+    }
+  };
 }  // namespace hmssql
@@ -150,8 +150,8 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   Page *pages_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
-  /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  /** Pointer to the log manager, nullptr disables the WAL check on page writes. */
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
   /** Replacer to find unpinned pages for replacement. */
@@ -175,6 +175,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
     // This is a no-nop right now without a more complex data structure to track deallocated pages
   }
 
-  // TODO(student): You may add additional private members and helper functions
+  /**
+   * @brief Write a page back to disk, forcing the log first if the page carries changes that are not durable yet
+   * (write-ahead logging). The log is only flushed when the page LSN is newer than the persistent LSN.
+   * Caller should acquire the latch before calling this function.
+   * @param frame_id frame holding the page to write
+   */
+  void WritePageToDisk(frame_id_t frame_id);
 };
 }  // namespace hmssql
@@ -35,19 +35,44 @@ constexpr int LOG_BUFFER_SIZE = (BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE;
 constexpr int BUCKET_SIZE = 50;
 constexpr int LRUK_REPLACER_K = 10; // Added this constant for backward compatibility
 constexpr int VARCHAR_DEFAULT_LENGTH = 128;
+constexpr int LOG_SEGMENT_SIZE = 4 * 1024 * 1024;  // size of one WAL segment file, header included
+constexpr int MAX_RECYCLED_LOG_SEGMENTS = 4;       // preallocated segments kept around for reuse
+constexpr uint32_t TUPLE_BATCH_SIZE = 1024;        // rows handed between executors by one NextBatch call
+constexpr uint32_t TUPLE_INLINE_SIZE = 32;         // tuple bytes kept inside the Tuple itself, longer ones on the heap
+constexpr size_t ARENA_CHUNK_SIZE = 64 << 10;      // largest chunk an ArenaPool grows to, large allocations get one of their own
+constexpr uint32_t MORSEL_PAGES = 16;              // heap pages a parallel scan worker claims at a time
+constexpr size_t EXCHANGE_QUEUE_CAPACITY = 8;      // batches an exchange buffers before its producers wait
+constexpr size_t MAX_PARALLEL_WORKERS = 64;        // upper bound of the max_parallel_workers session variable
+constexpr size_t PARALLEL_SCAN_MIN_ROWS = 10000;   // tables known to be smaller are not scanned in parallel
+constexpr size_t DEFAULT_WORK_MEM = 64 << 20;      // bytes a hash join build side or a sort holds before it spills
+constexpr uint32_t HASH_JOIN_SPILL_PARTITIONS = 16; // partitions a hash join over work_mem splits its inputs into
+constexpr size_t SORT_MERGE_FAN_IN = 64;           // spilled sort runs merged at once, each holds a page in memory
+constexpr size_t SORT_KEY_VARCHAR_PREFIX = 16;     // bytes of a varchar in a normalized sort key, longer ones tie-break
+constexpr size_t SORT_SPLITTER_SAMPLES = 64;       // rows of each worker's share a parallel sort picks splitters from
+constexpr size_t RADIX_JOIN_MIN_ROWS = 100000;      // parallel joins of inputs estimated this large are radix-partitioned
+constexpr uint32_t RADIX_JOIN_BITS = 6;             // hash bits a radix join partitions by in one pass
+constexpr size_t RADIX_JOIN_PARTITION_BYTES = 256 << 10;  // build side of a radix join partition, about an L2 cache
+constexpr size_t RUNTIME_FILTER_BITS_PER_KEY = 16;  // bloom filter bits per build key a hash join pushes into its probe scan
+constexpr size_t RUNTIME_FILTER_SAMPLE_ROWS = 4096; // probe rows after which a runtime filter that drops too few is off
+constexpr uint32_t VERSION_MAP_SHARDS = 256;        // latches the row version chains are split over, by page id
 
 // Type definitions (moved outside of class to be accessible everywhere)
 using frame_id_t = int32_t;
 using page_id_t = int32_t;
 using txn_id_t = int32_t;
+using timestamp_t = int64_t;
 using lsn_t = int32_t;
 using slot_offset_t = size_t;
 using oid_t = uint16_t;
+using table_oid_t = uint32_t;
 
 // For backward compatibility
 extern std::atomic<bool> enable_logging;
+/** The log flush thread writes the log buffer out this often, an asynchronous commit can lose at most that long */
 extern std::chrono::milliseconds log_timeout;
 extern std::chrono::milliseconds cycle_detection_interval;
+/** A session idle for longer is rolled back and ended, zero keeps sessions open until they end */
+extern std::chrono::milliseconds session_idle_timeout;
 
 /**
  * @brief Configuration manager for HMSSQL
@@ -155,12 +180,16 @@ class Config {
   static constexpr const char* ENABLE_LOGGING = "enable_logging";
   static constexpr const char* LOG_TIMEOUT_MS = "log_timeout_ms";
   static constexpr const char* CYCLE_DETECTION_INTERVAL_MS = "cycle_detection_interval_ms";
+  static constexpr const char* SESSION_IDLE_TIMEOUT_MS = "session_idle_timeout_ms";
   static constexpr const char* PAGE_SIZE = "page_size";
   static constexpr const char* BUFFER_POOL_SIZE = "buffer_pool_size";
   static constexpr const char* LOG_BUFFER_SIZE = "log_buffer_size";
   static constexpr const char* BUCKET_SIZE = "bucket_size";
   static constexpr const char* LRUK_REPLACER_K = "lruk_replacer_k";
   static constexpr const char* VARCHAR_DEFAULT_LENGTH = "varchar_default_length";
+  static constexpr const char* LOG_SEGMENT_SIZE = "log_segment_size";
+  static constexpr const char* MAX_RECYCLED_LOG_SEGMENTS = "max_recycled_log_segments";
+  static constexpr const char* LOG_COMPRESSION = "log_compression";
 
  private:
   Config();
@@ -200,6 +229,10 @@ inline std::chrono::milliseconds GetCycleDetectionInterval() {
   return Config::GetInstance().GetDuration(Config::CYCLE_DETECTION_INTERVAL_MS);
 }
 
+inline std::chrono::milliseconds GetSessionIdleTimeout() {
+  return Config::GetInstance().GetDuration(Config::SESSION_IDLE_TIMEOUT_MS);
+}
+
 inline int GetPageSize() {
   return Config::GetInstance().GetInt(Config::PAGE_SIZE);
 }
@@ -224,4 +257,20 @@ inline int GetVarcharDefaultLength() {
   return Config::GetInstance().GetInt(Config::VARCHAR_DEFAULT_LENGTH);
 }
 
+inline int GetLogSegmentSize() {
+  return Config::GetInstance().GetInt(Config::LOG_SEGMENT_SIZE, LOG_SEGMENT_SIZE);
+}
+
+inline int GetMaxRecycledLogSegments() {
+  return Config::GetInstance().GetInt(Config::MAX_RECYCLED_LOG_SEGMENTS, MAX_RECYCLED_LOG_SEGMENTS);
+}
+
+inline bool GetLogCompression() {
+  return Config::GetInstance().GetBool(Config::LOG_COMPRESSION);
+}
+
+inline void SetLogCompression(bool value) {
+  Config::GetInstance().SetBool(Config::LOG_COMPRESSION, value);
+}
+
 }  // namespace hmssql
\ No newline at end of file
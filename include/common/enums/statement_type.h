@@ -35,8 +35,11 @@ enum class StatementType : uint8_t {
   CREATE_TEMP_TABLE_STATEMENT,
   CREATE_DATABASE_STATEMENT,
   USE_STATEMENT,
+  TRANSACTION_STATEMENT,    // begin, commit or rollback
 };
 
+enum class TransactionStatementKind : uint8_t { BEGIN, COMMIT, ROLLBACK };
+
 }  // namespace hmssql
 
 template <>
@@ -90,6 +93,9 @@ struct fmt::formatter<hmssql::StatementType> : formatter<string_view> {
       case hmssql::StatementType::USE_STATEMENT:
         name = "Use";
         break;
+      case hmssql::StatementType::TRANSACTION_STATEMENT:
+        name = "Transaction";
+        break;
     }
     return formatter<string_view>::format(name, ctx);
   }
@@ -11,19 +11,27 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <shared_mutex>
 #include <sstream>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "../include/catalog/catalog.h"
 #include "../include/common/config.h"
+#include "../include/common/enums/statement_type.h"
 #include "../include/common/util/string_util.h"
+#include "../include/concurrency/transaction.h"
 #include "libfort/lib/fort.hpp"
 #include "../include/type/value.h"
 
@@ -34,8 +42,12 @@ class DiskManager;
 class BufferPoolManager;
 class LogManager;
 class CheckpointManager;
+class BackupManager;
 class Catalog;
 class ExecutionEngine;
+class Transaction;
+class LockManager;
+class TransactionManager;
 
 class ResultWriter {
  public:
@@ -78,13 +90,15 @@ class FortTableWriter : public ResultWriter {
 class HMSSQL {
  private:
   /**
-   * Get the executor context from the HMSSQL instance.
+   * Get the executor context from the HMSSQL instance, set up with the variables of session.
    */
-  auto MakeExecutorContext() -> std::unique_ptr<ExecutorContext>;
+  auto MakeExecutorContext(Transaction *txn, const std::string *session = nullptr)
+      -> std::unique_ptr<ExecutorContext>;
   std::string current_database_;
   std::unordered_map<std::string, std::unique_ptr<Catalog>> databases_;
   std::shared_mutex databases_lock_;
-  const std::string state_file_ = "hmssql_state.db";
+  static constexpr const char *STATE_FILE = "hmssql_state.db";
+  const std::string state_file_ = STATE_FILE;
 
  public:
   explicit HMSSQL(const std::string &db_file_name);
@@ -97,6 +111,12 @@ class HMSSQL {
 
   auto SaveState() -> bool;
   auto LoadState() -> bool;
+
+  /**
+   * Rebuild db_file from a backup taken with `\backup`, including the saved database state. Must be called before
+   * an instance is opened on db_file.
+   */
+  static void RestoreBackup(const std::string &backup_dir, const std::string &db_file);
   auto Checkpoint() -> bool;  // Add semicolon here
 
   void CmdDisplayDatabases(ResultWriter &writer);  // Change return type from auto
@@ -105,16 +125,27 @@ class HMSSQL {
   auto GetCurrentDatabase() const -> std::string { return current_database_; }
 
   /**
-   * Execute a SQL query in the HMSSQL instance.
+   * Execute a SQL query in the HMSSQL instance. Statements run in the transaction of the session, or each in a
+   * transaction of its own.
+   *
+   * session holds the id the first BEGIN or SET of the client issues, the client passes it back with every statement.
+   * The session keeps the transaction BEGIN opened until COMMIT, ROLLBACK or a failed statement ends it, and the
+   * variables SET changed. It ends once idle for session_idle_timeout. Without session BEGIN is refused and SET
+   * changes the variables of the clients without a session.
    */
-  auto ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool;
+  auto ExecuteSql(const std::string &sql, ResultWriter &writer, std::string *session = nullptr) -> bool;
 
-  auto ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -> bool;
+  /**
+   * Execute a SQL query. With txn every statement runs in that transaction and the caller commits or aborts it,
+   * otherwise in the transaction of session as in ExecuteSql.
+   */
+  auto ExecuteSqlStatement(const std::string &sql, ResultWriter &writer, Transaction *txn = nullptr,
+                           std::string *session = nullptr) -> bool;
 
   /**
    * Execute a SQL query in the HMSSQL instance with provided txn.
    */
-  auto ExecuteSqlTxn(const std::string &sql, ResultWriter &writer) -> bool;
+  auto ExecuteSqlTxn(const std::string &sql, ResultWriter &writer, Transaction *txn) -> bool;
 
   #ifndef ISDEBUG
 
@@ -141,28 +172,110 @@ class HMSSQL {
   BufferPoolManager *buffer_pool_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  BackupManager *backup_manager_{nullptr};
+  LockManager *lock_manager_{nullptr};
+  TransactionManager *txn_manager_{nullptr};
   Catalog *catalog_;
-  ExecutionEngine *execution_engine_;
+  ExecutionEngine *execution_engine_{nullptr};
   std::shared_mutex catalog_lock_;
 
-  auto GetSessionVariable(const std::string &key) -> std::string {
-    if (session_variables_.find(key) != session_variables_.end()) {
-      return session_variables_[key];
-    }
-    return "";
-  }
+  /** @return the variable as SET in session, or by clients without a session if session is nullptr, "" if unset */
+  auto GetSessionVariable(const std::string *session, const std::string &key) -> std::string;
 
-  auto IsForceStarterRule() -> bool {
-    auto variable = StringUtil::Lower(GetSessionVariable("force_optimizer_starter_rule"));
+  auto IsForceStarterRule(const std::string *session) -> bool {
+    auto variable = StringUtil::Lower(GetSessionVariable(session, "force_optimizer_starter_rule"));
     return variable == "1" || variable == "true" || variable == "yes";
   }
 
+  /**
+   * `SET synchronous_commit = off` lets the modifying statements of the session return as soon as their commit record
+   * is in the log buffer. The log flush thread writes it out within log_timeout, which bounds what a crash can lose.
+   * Other sessions still wait for their commits to be durable.
+   */
+  auto IsSynchronousCommit(const std::string *session) -> bool {
+    auto variable = StringUtil::Lower(GetSessionVariable(session, "synchronous_commit"));
+    return !(variable == "0" || variable == "false" || variable == "no" || variable == "off");
+  }
+
+  /**
+   * SET concurrency_control = optimistic: new transactions of the session validate their reads at commit instead of
+   * locking rows
+   */
+  auto GetConcurrencyControl(const std::string *session) -> ConcurrencyControl {
+    auto variable = StringUtil::Lower(GetSessionVariable(session, "concurrency_control"));
+    return variable == "optimistic" || variable == "occ" ? ConcurrencyControl::OPTIMISTIC : ConcurrencyControl::LOCKING;
+  }
+
+  /**
+   * SET max_parallel_workers = n: the queries of the session over large tables run as parallel pipelines of n
+   * workers, see Optimizer::OptimizeParallelPlan. Unset, 0 or 1 keeps queries serial.
+   */
+  auto GetMaxParallelWorkers(const std::string *session) -> size_t {
+    auto variable = GetSessionVariable(session, "max_parallel_workers");
+    char *end = nullptr;
+    auto workers = std::strtoul(variable.c_str(), &end, 10);
+    return *end == '\0' ? std::min<size_t>(workers, MAX_PARALLEL_WORKERS) : 0;
+  }
+
+  /**
+   * SET work_mem = n: hash joins hold up to n kilobytes of their build side in memory and sorts up to n kilobytes of
+   * their input, the rest is spilled to temporary pages. Unset or invalid keeps DEFAULT_WORK_MEM.
+   */
+  auto GetWorkMem(const std::string *session) -> size_t {
+    auto variable = GetSessionVariable(session, "work_mem");
+    char *end = nullptr;
+    auto kilobytes = std::strtoull(variable.c_str(), &end, 10);
+    return !variable.empty() && *end == '\0' && kilobytes > 0 ? kilobytes * 1024 : DEFAULT_WORK_MEM;
+  }
+
 private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdBackup(const std::string &backup_dir, ResultWriter &writer, Transaction *txn);
+  void CmdTransaction(TransactionStatementKind kind, ResultWriter &writer, std::string *session);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
+  /** @return a new session id, 128 random bits in hex so that one client cannot guess the session of another */
+  static auto NewSessionId() -> std::string;
+  /**
+   * Mark the session busy until ReleaseSession, the reaper leaves it alone meanwhile. Throws if the session runs a
+   * statement already, or if it does not exist (anymore), then session is cleared.
+   */
+  void AcquireSession(std::string *session);
+  /** Set a variable of session, a session is opened if session is empty. Without session of the sessionless clients. */
+  void SetSessionVariable(std::string *session, const std::string &key, const std::string &value);
+  /** Mark the session idle, its idle timeout starts over. */
+  void ReleaseSession(const std::string &session_id);
+  /** @return the transaction of the session, nullptr outside of BEGIN ... COMMIT */
+  auto GetSessionTransaction(const std::string *session) -> Transaction *;
+  /** Roll back the transaction of the session, the session stays open. */
+  void AbortSessionTransaction(std::string *session);
+  /** Start the thread that rolls back sessions idle for longer than session_idle_timeout. */
+  void StartSessionReaper();
+  /** Stop and join the reaper, then roll back the sessions left. */
+  void StopSessionReaper();
+  /** End the sessions idle for longer than session_idle_timeout and roll back their transactions. */
+  void ReapIdleSessions();
+
+  /** The state of one client, opened by its first BEGIN or SET */
+  struct Session {
+    /** The transaction BEGIN opened, nullptr outside of BEGIN ... COMMIT */
+    Transaction *txn_{nullptr};
+    std::chrono::steady_clock::time_point last_used_{};
+    /** A statement of the session is running */
+    bool busy_{false};
+    /** The variables SET in the session */
+    std::unordered_map<std::string, std::string> variables_;
+  };
+
+  /** The variables SET by clients without a session, guarded by session_latch_ */
   std::unordered_map<std::string, std::string> session_variables_;
+  /** Open sessions by the id they were issued */
+  std::unordered_map<std::string, Session> sessions_;
+  std::mutex session_latch_;
+  std::condition_variable session_cv_;
+  bool reap_sessions_{false};
+  std::thread session_reaper_;
 };
 
 }  // namespace hmssql
@@ -0,0 +1,50 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// compression_util.h
+//
+// Identification: src/include/common/util/compression_util.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hmssql {
+
+/**
+ * CompressionUtil implements a small LZ77 block codec that produces the LZ4 block format (token, literals, 2-byte
+ * offset, extra match length). It favours speed over ratio and is meant for log buffers and spilled pages, where
+ * repeated tuple headers and padding compress well.
+ */
+class CompressionUtil {
+ public:
+  /** @return the worst-case size of compressing input_size bytes */
+  static auto MaxCompressedSize(size_t input_size) -> size_t { return input_size + input_size / 255 + 16; }
+
+  /**
+   * Compress a block.
+   * @param src input bytes
+   * @param src_size number of input bytes
+   * @param[out] dst output buffer
+   * @param dst_capacity size of the output buffer
+   * @return the compressed size, or 0 if the result does not fit into dst_capacity
+   */
+  static auto Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t;
+
+  /**
+   * Decompress a block produced by Compress.
+   * @param src compressed bytes
+   * @param src_size number of compressed bytes
+   * @param[out] dst output buffer
+   * @param dst_capacity size of the output buffer
+   * @return the decompressed size, or -1 if the input is malformed or does not fit into dst_capacity
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> int64_t;
+};
+
+}  // namespace hmssql
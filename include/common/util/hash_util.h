@@ -99,6 +99,23 @@ class HashUtil {
       }
     }
   }
+
+  /**
+   * @return the hash of a key of count values, with the bits of HashValue spread by the murmur3 finalizer so both
+   * ends of it can be used. HashBytes leaves the top bits of small integers zero.
+   */
+  static inline auto HashValues(const Value *values, size_t count) -> hash_t {
+    uint64_t hash = HashValue(&values[0]);
+    for (size_t i = 1; i < count; i++) {
+      hash = CombineHashes(hash, HashValue(&values[i]));
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
 };
 
 }  // namespace hmssql
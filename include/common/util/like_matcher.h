@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// like_matcher.h
+//
+// Identification: src/include/common/util/like_matcher.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace hmssql {
+
+/**
+ * LikeMatcher matches strings against a LIKE pattern compiled once, % standing for any run of characters, _ for any
+ * one character and every other character for itself.
+ *
+ * The pattern is cut at every % into segments. The first segment has to match at the start of the string, the last
+ * one at its end, and those between are searched left to right, each at its leftmost match after the one before. A
+ * prefix, a suffix or an exact pattern thus costs a memcmp, and 'abc' between two % a substring search that skips
+ * ahead with memchr.
+ */
+class LikeMatcher {
+ public:
+  explicit LikeMatcher(const std::string &pattern);
+
+  /** @return true if the length bytes at data match the pattern */
+  auto Match(const char *data, size_t length) const -> bool;
+
+ private:
+  /** A piece of the pattern between two %, _ matches any character in it */
+  struct Segment {
+    std::string text_;
+    bool has_any_;
+
+    /** @return true if the segment matches the bytes at data */
+    auto MatchesAt(const char *data) const -> bool;
+
+    /** @return the leftmost position from on where the segment matches and ends by end, npos if there is none */
+    auto Find(const char *data, size_t from, size_t end) const -> size_t;
+  };
+
+  /** At least one segment, the first and the last one may be empty, those between are not */
+  std::vector<Segment> segments_;
+};
+
+}  // namespace hmssql
@@ -0,0 +1,173 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// lock_manager.h
+//
+// Identification: src/include/concurrency/lock_manager.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/common/config.h"
+#include "../include/common/rid.h"
+#include "../include/concurrency/transaction.h"
+
+namespace hmssql {
+
+/**
+ * LockManager hands out table and row locks under strict two-phase locking: a transaction keeps every lock until
+ * TransactionManager releases them at commit or abort. Locks are hierarchical, a row lock needs a table lock that
+ * covers it (IS or more for SHARED, IX, SIX or X for EXCLUSIVE), so writers to different rows of one table only
+ * share the compatible IX table lock and proceed in parallel.
+ *
+ * Every table and row has a FIFO queue of requests. A request is granted once it is compatible with the granted
+ * requests and nothing waits in front of it; upgrades go first. A background thread looks for cycles in the
+ * waits-for graph every cycle_detection_interval and taints the youngest transaction of each cycle, which stops
+ * waiting and has to roll back.
+ */
+class LockManager {
+ public:
+  /** A lock request of one transaction on a table or a row. */
+  struct LockRequest {
+    LockRequest(Transaction *txn, LockMode lock_mode) : txn_(txn), lock_mode_(lock_mode) {}
+
+    /** Valid while the request is queued, a transaction releases its locks before it is freed. */
+    Transaction *txn_;
+    LockMode lock_mode_;
+    bool granted_{false};
+  };
+
+  /** The requests on one table or row, oldest first. */
+  struct LockRequestQueue {
+    std::list<std::shared_ptr<LockRequest>> request_queue_;
+    /** Notified whenever a request leaves the queue or a waiting transaction is tainted. */
+    std::condition_variable cv_;
+    /** The transaction upgrading its lock, at most one at a time. */
+    txn_id_t upgrading_{INVALID_TXN_ID};
+    std::mutex latch_;
+  };
+
+  LockManager() = default;
+
+  ~LockManager() { StopDeadlockDetection(); }
+
+  DISALLOW_COPY_AND_MOVE(LockManager);
+
+  /** Start the deadlock detection thread, it checks the waits-for graph every cycle_detection_interval. */
+  void StartDeadlockDetection();
+
+  /** Stop and join the deadlock detection thread. */
+  void StopDeadlockDetection();
+
+  /**
+   * Lock a table, blocking until the lock is granted. A lock the transaction holds already is upgraded to the weakest
+   * mode covering both, IX plus S becomes SIX.
+   * @return false if the transaction was tainted, while waiting or because another upgrade on the table is pending
+   */
+  auto LockTable(Transaction *txn, LockMode lock_mode, table_oid_t oid) -> bool;
+
+  /**
+   * Release a table lock. The transaction must not hold row locks on the table anymore.
+   * @return false if the transaction holds no lock on the table
+   */
+  auto UnlockTable(Transaction *txn, table_oid_t oid) -> bool;
+
+  /**
+   * Lock a row, blocking until the lock is granted. Only SHARED and EXCLUSIVE are allowed and the transaction must
+   * hold a table lock that permits it. Nothing is queued if the table lock covers the row already (S, SIX or X).
+   * @return false if the transaction was tainted, while waiting or because another upgrade on the row is pending
+   */
+  auto LockRow(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid) -> bool;
+
+  /**
+   * Release a row lock.
+   * @return false if the transaction holds no lock on the row
+   */
+  auto UnlockRow(Transaction *txn, table_oid_t oid, const RID &rid) -> bool;
+
+  /** Release every lock of a transaction, rows first. Called when it commits or aborts. */
+  void UnlockAll(Transaction *txn);
+
+  /** Waits-for graph, exposed for inspection. t1 waits for t2. */
+  void AddEdge(txn_id_t t1, txn_id_t t2);
+  void RemoveEdge(txn_id_t t1, txn_id_t t2);
+
+  /**
+   * Find a cycle in the waits-for graph. Transactions and their edges are visited in ascending id order, so the
+   * result does not depend on the order the edges were added in.
+   * @param[out] txn_id the youngest (largest id) transaction of the cycle
+   * @return true if there is a cycle
+   */
+  auto HasCycle(txn_id_t *txn_id) -> bool;
+
+  /** @return the edges of the waits-for graph */
+  auto GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>>;
+
+  /** Build the waits-for graph from the lock queues and taint one transaction of every cycle. */
+  void DetectDeadlocks();
+
+ private:
+  /** @return true if a lock held in mode held satisfies a request for mode wanted */
+  static auto Covers(LockMode held, LockMode wanted) -> bool;
+  static auto AreCompatible(LockMode a, LockMode b) -> bool;
+  /** @return the weakest mode covering both */
+  static auto Supremum(LockMode a, LockMode b) -> LockMode;
+
+  /**
+   * @return the queue of a table or row, created on first use, with its latch held in lock. Row queues are looked
+   * up and latched under the map latch, so an empty one can be dropped without racing a new request.
+   */
+  auto LatchTableQueue(table_oid_t oid, std::unique_lock<std::mutex> *lock) -> std::shared_ptr<LockRequestQueue>;
+  auto LatchRowQueue(const RID &rid, std::unique_lock<std::mutex> *lock) -> std::shared_ptr<LockRequestQueue>;
+
+  /** Drop the queue of a row nobody requests anymore, there is one per row ever locked otherwise. */
+  void EraseRowQueueIfEmpty(const RID &rid);
+
+  /**
+   * Queue a request, or an upgrade of the lock held in mode held, and wait until it is granted. The caller holds
+   * the queue latch in lock.
+   * @return false if the transaction was tainted, an upgrade keeps the lock held before then
+   */
+  auto Acquire(LockRequestQueue *queue, std::unique_lock<std::mutex> *lock, Transaction *txn, LockMode lock_mode,
+               const LockMode *held) -> bool;
+
+  /** Remove the granted request of txn and wake up the waiters. The caller holds the queue latch. */
+  static void Release(LockRequestQueue *queue, Transaction *txn);
+
+  /** @return true if the request can be granted: compatible with the granted ones and first among the waiting */
+  static auto Grantable(const LockRequestQueue &queue, const LockRequest *request) -> bool;
+
+  /** Look for a cycle reachable from txn_id with DFS, path holds the transactions on the way from the start. */
+  auto FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *path, std::set<txn_id_t> *visited, txn_id_t *victim)
+      -> bool;
+
+  /** Table queues are kept, there are few of them. */
+  std::mutex table_lock_map_latch_;
+  std::unordered_map<table_oid_t, std::shared_ptr<LockRequestQueue>> table_lock_map_;
+  std::mutex row_lock_map_latch_;
+  std::unordered_map<RID, std::shared_ptr<LockRequestQueue>> row_lock_map_;
+
+  /** Waits-for graph, only used by the thread running deadlock detection. */
+  std::map<txn_id_t, std::set<txn_id_t>> waits_for_;
+
+  std::mutex detection_latch_;
+  std::condition_variable detection_cv_;
+  bool enable_cycle_detection_{false};
+  std::thread *cycle_detection_thread_{nullptr};
+};
+
+}  // namespace hmssql
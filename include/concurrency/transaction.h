@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// transaction.h
+//
+// Identification: src/include/concurrency/transaction.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/common/config.h"
+#include "../include/common/macros.h"
+#include "../include/common/rid.h"
+#include "../include/storage/table/tuple.h"
+
+namespace hmssql {
+
+class Index;
+class TableHeap;
+class LockManager;
+class TransactionManager;
+
+/**
+ * Commit timestamps count up from 1, timestamp 0 stands for data that was committed before any running transaction
+ * started. Versions written by a transaction that has not committed yet carry TXN_START_TS plus its id, which is
+ * larger than every commit timestamp, so no other snapshot can read them.
+ */
+static constexpr timestamp_t TXN_START_TS = static_cast<timestamp_t>(1) << 62;
+
+/**
+ * RUNNING: the transaction may read and write.
+ * TAINTED: a write conflicted with another transaction, the transaction was chosen to break a deadlock or it failed
+ * validation, it can only be rolled back.
+ * COMMITTING: an optimistic transaction passed validation and is writing its commit record.
+ * COMMITTED / ABORTED: the transaction is finished.
+ */
+enum class TransactionState { RUNNING, TAINTED, COMMITTING, COMMITTED, ABORTED };
+
+/**
+ * How a transaction keeps out of the way of concurrent writers.
+ * LOCKING: writers lock the rows they write until they finish, a second writer of a row waits for the first.
+ * OPTIMISTIC: rows are not locked. The transaction remembers the version of every row it reads and commits only if
+ * none of them was overwritten by a commit in the meantime, a conflicting write fails right away.
+ */
+enum class ConcurrencyControl { LOCKING, OPTIMISTIC };
+
+/**
+ * Lock modes of LockManager. Tables take all of them, rows only SHARED and EXCLUSIVE.
+ *
+ *            IS   IX   S    SIX  X
+ *      IS    +    +    +    +
+ *      IX    +    +
+ *      S     +         +
+ *      SIX   +
+ *      X
+ */
+enum class LockMode { SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE };
+
+/** A row the transaction inserted, updated or deleted, undone on abort. */
+struct TableWriteRecord {
+  TableHeap *table_;
+  RID rid_;
+};
+
+/** A row an optimistic transaction read and the commit timestamp of the version it saw. */
+struct ReadRecord {
+  RID rid_;
+  timestamp_t version_;
+};
+
+/** An index entry the transaction inserted or deleted, undone on abort. */
+struct IndexWriteRecord {
+  Index *index_;
+  Tuple key_;
+  RID rid_;
+  bool is_insert_;
+};
+
+/**
+ * Transaction tracks the snapshot a transaction reads and the writes it made. It is created by
+ * TransactionManager::Begin and freed by Commit or Abort.
+ */
+class Transaction {
+ public:
+  Transaction(txn_id_t txn_id, timestamp_t read_ts, TransactionManager *txn_manager,
+              ConcurrencyControl concurrency_control = ConcurrencyControl::LOCKING)
+      : txn_id_(txn_id), read_ts_(read_ts), concurrency_control_(concurrency_control), txn_manager_(txn_manager) {}
+
+  ~Transaction() = default;
+
+  DISALLOW_COPY(Transaction);
+
+  /** @return the id of this transaction */
+  inline auto GetTransactionId() const -> txn_id_t { return txn_id_; }
+
+  /** @return the commit timestamp of the snapshot this transaction reads */
+  inline auto GetReadTs() const -> timestamp_t { return read_ts_; }
+
+  /** @return the timestamp of the versions this transaction wrote but did not commit yet */
+  inline auto GetTempTs() const -> timestamp_t { return TXN_START_TS + txn_id_; }
+
+  /** @return the commit timestamp, valid once the transaction committed */
+  inline auto GetCommitTs() const -> timestamp_t { return commit_ts_; }
+
+  /** @return the state of this transaction */
+  inline auto GetState() const -> TransactionState { return state_; }
+
+  /** @return how this transaction deals with concurrent writers */
+  inline auto GetConcurrencyControl() const -> ConcurrencyControl { return concurrency_control_; }
+
+  /** @return true if this transaction validates its reads at commit instead of locking */
+  inline auto IsOptimistic() const -> bool { return concurrency_control_ == ConcurrencyControl::OPTIMISTIC; }
+
+  /** @return the transaction manager that started this transaction */
+  inline auto GetTransactionManager() const -> TransactionManager * { return txn_manager_; }
+
+  /** @return the rows written by this transaction, each one once, in the order they were first written */
+  inline auto GetWriteSet() -> std::vector<TableWriteRecord> & { return write_set_; }
+
+  /** @return the rows read by an optimistic transaction, validated at commit */
+  inline auto GetReadSet() -> std::vector<ReadRecord> & { return read_set_; }
+
+  /** @return the index entries changed by this transaction */
+  inline auto GetIndexWriteSet() -> std::vector<IndexWriteRecord> & { return index_write_set_; }
+
+  inline void AppendIndexWriteRecord(IndexWriteRecord record) { index_write_set_.emplace_back(std::move(record)); }
+
+  /** @return the table locks held by this transaction */
+  inline auto GetTableLockSet() const -> const std::unordered_map<table_oid_t, LockMode> & { return table_locks_; }
+
+  /** @return the row locks held by this transaction, by table */
+  inline auto GetRowLockSet() const -> const std::unordered_map<table_oid_t, std::unordered_map<RID, LockMode>> & {
+    return row_locks_;
+  }
+
+  /** @return the LSN of the last log record of a change this transaction made, INVALID_LSN before the first one */
+  inline auto GetPrevLSN() const -> lsn_t { return prev_lsn_; }
+
+  /** The records of a transaction are chained by their prevLSN, recovery undoes them from the newest one back. */
+  inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+
+  /** Note that a change of this transaction is about to be logged, before its record is appended. */
+  inline void SetLogged() { logged_ = true; }
+
+  /** @return true once a change of this transaction was about to be logged, it is read by other threads */
+  inline auto HasLogged() const -> bool { return logged_; }
+
+ private:
+  friend class LockManager;
+  friend class TransactionManager;
+
+  txn_id_t txn_id_;
+  timestamp_t read_ts_;
+  timestamp_t commit_ts_{0};
+  /** Set by the deadlock detector while the transaction waits for a lock. */
+  std::atomic<TransactionState> state_{TransactionState::RUNNING};
+  ConcurrencyControl concurrency_control_;
+  TransactionManager *txn_manager_;
+  std::vector<TableWriteRecord> write_set_;
+  std::vector<ReadRecord> read_set_;
+  std::vector<IndexWriteRecord> index_write_set_;
+  /** Only the thread running the transaction touches the lock sets. */
+  std::unordered_map<table_oid_t, LockMode> table_locks_;
+  std::unordered_map<table_oid_t, std::unordered_map<RID, LockMode>> row_locks_;
+  /** Only the thread running the transaction touches prev_lsn_. */
+  lsn_t prev_lsn_{INVALID_LSN};
+  std::atomic<bool> logged_{false};
+};
+
+}  // namespace hmssql
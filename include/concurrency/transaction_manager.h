@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// transaction_manager.h
+//
+// Identification: src/include/concurrency/transaction_manager.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+
+#include "../include/concurrency/lock_manager.h"
+#include "../include/concurrency/transaction.h"
+#include "../include/recovery/log_manager.h"
+
+namespace hmssql {
+
+/** An older image of a row, kept while a running snapshot may still read it. */
+struct UndoVersion {
+  /** Commit timestamp of the image. */
+  timestamp_t ts_;
+  /** The row did not exist as of ts_. */
+  bool is_deleted_;
+  Tuple tuple_;
+};
+
+/**
+ * The versions of one row. The table page always holds the newest one, written at ts_, and undo_ the older images
+ * newest first. Rows without a chain were last written before every running snapshot, so the page is all there is.
+ */
+struct VersionChain {
+  TableHeap *table_;
+  timestamp_t ts_;
+  /** The newest version is a delete, the slot is marked deleted on the page. */
+  bool is_deleted_{false};
+  std::deque<UndoVersion> undo_;
+};
+
+/**
+ * TransactionManager runs transactions under snapshot isolation. A transaction reads the rows as of the last commit
+ * before it began: writers update the table pages in place and push the image they replace onto the version chain
+ * of the row, and readers that must not see the change walk back to the image of their snapshot. Reads never wait
+ * for writers and writers never wait for readers. Two transactions writing the same row conflict, the second one
+ * becomes tainted and has to roll back (first updater wins).
+ *
+ * The version chains live in memory only. Once no running snapshot needs the older images of a row they are dropped
+ * and deletes are applied to the page. They are split into VERSION_MAP_SHARDS shards by page id, each with a latch of
+ * its own, and a read of a row whose shard holds no chain takes no latch at all.
+ *
+ * With a LockManager, writers lock the rows they write and keep the locks until they finish, so a second writer of a
+ * row waits for the first one instead of conflicting with its uncommitted version. It still conflicts if the first
+ * one commits after the snapshot of the second.
+ *
+ * Optimistic transactions lock no rows. Besides their writes they keep the version of every row they read, and
+ * commit only if each one is still the newest committed version (backward validation). Validation and publishing the
+ * commit are atomic with respect to other optimistic transactions, which makes them serializable among each other
+ * as far as the rows they read go; rows inserted into a range they scanned are not detected.
+ */
+class TransactionManager {
+ public:
+  explicit TransactionManager(LogManager *log_manager = nullptr, LockManager *lock_manager = nullptr)
+      : log_manager_(log_manager), lock_manager_(lock_manager) {}
+
+  ~TransactionManager() = default;
+
+  DISALLOW_COPY_AND_MOVE(TransactionManager);
+
+  /** @return a new transaction reading the snapshot of the last commit */
+  auto Begin(ConcurrencyControl concurrency_control = ConcurrencyControl::LOCKING) -> Transaction *;
+
+  /**
+   * Commit a transaction, its writes become visible to transactions that begin afterwards. The transaction is freed.
+   * @param synchronous_commit wait for the commit record to reach the disk before publishing the writes
+   * @return false if an optimistic transaction failed validation, it was rolled back then
+   */
+  auto Commit(Transaction *txn, bool synchronous_commit = true) -> bool;
+
+  /** Roll back every write of a transaction and free it. */
+  void Abort(Transaction *txn);
+
+  /**
+   * Wait until every transaction that logged a change before the call has finished. An online backup waits for them,
+   * so that the WAL it archives holds all the records of the transactions a restore may have to undo.
+   */
+  void WaitForLoggedTransactions();
+
+  /**
+   * Read a row as of the snapshot of txn, an optimistic txn remembers the version it read. The caller holds a latch
+   * on the page of the row.
+   * @param page_deleted the row is deleted on the page
+   * @param[in,out] tuple the row as stored on the page, replaced by the image txn reads
+   * @return true if the row exists in the snapshot of txn
+   */
+  auto ReadVersion(Transaction *txn, const RID &rid, bool page_deleted, Tuple *tuple) -> bool;
+
+  /**
+   * Whether a row of a page may have a version chain, without taking a latch. The caller holds a latch on the page.
+   * If not, every snapshot reads the rows of the page as stored there.
+   */
+  inline auto HasVersions(page_id_t page_id) -> bool {
+    return version_shards_[static_cast<uint32_t>(page_id) % VERSION_MAP_SHARDS].size_ != 0;
+  }
+
+  /** Register a row txn inserted. The caller holds the write latch on the page of the row. */
+  void InsertVersion(Transaction *txn, TableHeap *table, const RID &rid);
+
+  /**
+   * Register that txn is about to update or delete a row, keeping the current image for older snapshots. The caller
+   * holds the write latch on the page of the row and only changes it if this succeeds.
+   * @param old_tuple the row as stored on the page
+   * @param slot_deleted the row is marked deleted on the page, it can only be checked for a conflict then
+   * @return false if another transaction wrote the row after txn began, txn is tainted then, or if the row is deleted
+   */
+  auto WriteVersion(Transaction *txn, TableHeap *table, const RID &rid, const Tuple &old_tuple, bool is_delete,
+                    bool slot_deleted) -> bool;
+
+  /**
+   * Undo the write of txn to a row in the version chain. The caller holds the write latch on the page of the row and
+   * restores the page to the returned image.
+   * @param[out] undo the image the row had before txn wrote it
+   * @param[out] page_deleted txn deleted the row
+   * @return false if txn has no write on the row
+   */
+  auto RollbackVersion(Transaction *txn, const RID &rid, UndoVersion *undo, bool *page_deleted) -> bool;
+
+  /** @return the lock manager of the transactions, nullptr if they don't lock */
+  inline auto GetLockManager() const -> LockManager * { return lock_manager_; }
+
+  /** @return the timestamp of the last commit */
+  inline auto GetLastCommitTs() const -> timestamp_t { return last_commit_ts_; }
+
+ private:
+  /**
+   * Drop the row images that no running snapshot can read anymore and apply deletes everybody sees. Only the rows
+   * written by the commits the watermark passed since the last collection are looked at.
+   */
+  void GarbageCollect();
+
+  /**
+   * Check that the rows an optimistic transaction read were not overwritten since. The caller holds version_latch_.
+   * @return true if every row read is still at the version txn saw
+   */
+  auto Validate(Transaction *txn) -> bool;
+
+  /** Release the locks of a finished transaction. */
+  void ReleaseLocks(Transaction *txn);
+
+  /** The version chains of the pages whose ids are equal modulo VERSION_MAP_SHARDS. */
+  struct VersionShard {
+    /** Taken after page latches and version_latch_, never before */
+    std::mutex latch_;
+    std::unordered_map<RID, VersionChain> chains_;
+    /**
+     * The number of chains, read without the latch. A chain is only added under the write latch of its page, so a
+     * reader holding a latch on the page and seeing 0 knows the row has none.
+     */
+    std::atomic<size_t> size_{0};
+  };
+
+  /** @return the shard holding the version chain of the row */
+  inline auto ShardOf(const RID &rid) -> VersionShard & {
+    return version_shards_[static_cast<uint32_t>(rid.GetPageId()) % VERSION_MAP_SHARDS];
+  }
+
+  LogManager *log_manager_;
+  LockManager *lock_manager_;
+
+  /**
+   * Protects the running transactions and orders commits: the chains of a commit get its timestamp before the snapshots
+   * taken afterwards can include it. Taken after page latches, never before.
+   */
+  std::mutex version_latch_;
+  std::array<VersionShard, VERSION_MAP_SHARDS> version_shards_;
+  /** The rows each commit wrote, in commit order, until the watermark passes the commit. Under version_latch_. */
+  std::deque<std::pair<timestamp_t, RID>> committed_writes_;
+  std::unordered_map<txn_id_t, std::unique_ptr<Transaction>> running_txns_;
+  /** Notified with version_latch_ released whenever transactions leave running_txns_. */
+  std::condition_variable finished_cv_;
+  txn_id_t next_txn_id_{0};
+  std::atomic<timestamp_t> last_commit_ts_{0};
+};
+
+}  // namespace hmssql
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// exchange_queue.h
+//
+// Identification: src/include/execution/exchange_queue.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>  // NOLINT
+
+#include "../include/common/config.h"
+#include "../include/execution/tuple_batch.h"
+
+namespace hmssql {
+
+/**
+ * ExchangeQueue passes batches from producer threads to one consumer. It holds at most capacity batches, producers
+ * wait for the consumer when it is full so a fast scan does not buffer the whole table. The first exception a
+ * producer reports is rethrown to the consumer.
+ */
+class ExchangeQueue {
+ public:
+  /**
+   * @param producers the number of producers, each calls ProducerDone() or Fail() once at the end
+   * @param capacity the number of batches buffered at most
+   */
+  explicit ExchangeQueue(size_t producers, size_t capacity = EXCHANGE_QUEUE_CAPACITY);
+
+  /**
+   * Hand a batch to the consumer, waiting while the queue is full.
+   * @return false if the queue was closed, the producer should stop
+   */
+  auto Push(TupleBatch &&batch) -> bool;
+
+  /** A producer has no more batches. */
+  void ProducerDone();
+
+  /** A producer failed, the consumer gets the exception from Pop(). */
+  void Fail(std::exception_ptr error);
+
+  /**
+   * Take the next batch, waiting for one while producers are running.
+   * @param[out] batch the batch
+   * @return false once every producer is done and the queue is drained
+   */
+  auto Pop(TupleBatch *batch) -> bool;
+
+  /** The consumer stops reading, producers waiting in Push() return false. */
+  void Close();
+
+ private:
+  const size_t capacity_;
+  std::mutex latch_;
+  /** Signalled when a batch is pushed or a producer ends */
+  std::condition_variable not_empty_;
+  /** Signalled when a batch is popped or the queue is closed */
+  std::condition_variable not_full_;
+  std::deque<TupleBatch> batches_;
+  size_t running_producers_;
+  bool closed_{false};
+  std::exception_ptr error_;
+};
+
+}  // namespace hmssql
@@ -18,6 +18,8 @@
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executor_factory.h"
 #include "../include/execution/plans/abstract_plan.h"
+#include "../include/execution/thread_pool.h"
+#include "../include/execution/tuple_batch.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
@@ -37,6 +39,9 @@ class ExecutionEngine {
 
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
 
+  /** @return the pool the workers of parallel plans run on, shared by the queries of this engine */
+  auto GetThreadPool() -> ThreadPool * { return &thread_pool_; }
+
   /**
    * Execute a query plan.
    * @param plan The query plan to execute
@@ -73,24 +78,26 @@ class ExecutionEngine {
 
  private:
   /**
-   * Poll the executor until exhausted, or exception escapes.
+   * Poll the executor a batch at a time until exhausted, or exception escapes.
    * @param executor The root executor
    * @param plan The plan to execute
    * @param result_set The tuple result set
    */
   static void PollExecutor(AbstractExecutor *executor, const AbstractPlanNodeRef &plan,
                            std::vector<Tuple> *result_set) {
-    RID rid{};
-    Tuple tuple{};
-    while (executor->Next(&tuple, &rid)) {
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
       if (result_set != nullptr) {
-        result_set->push_back(tuple);
+        for (uint32_t i = 0; i < batch.Size(); i++) {
+          result_set->push_back(batch.GetTuple(batch.RowAt(i)));
+        }
       }
     }
   }
 
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] Catalog *catalog_;
+  ThreadPool thread_pool_;
 };
 
 }  // namespace hmssql
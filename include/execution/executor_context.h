@@ -11,44 +11,141 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "../include/catalog/catalog.h"
+#include "../include/concurrency/lock_manager.h"
+#include "../include/concurrency/transaction.h"
+#include "../include/execution/parallel_state.h"
+#include "../include/execution/thread_pool.h"
+#include "../include/storage/disk/tmp_file.h"
 #include "../include/storage/page/tmp_tuple_page.h"
+#include "../include/type/arena_pool.h"
 
 namespace hmssql {
 /**
  * ExecutorContext stores all the context necessary to run an executor.
+ *
+ * The context a query is started with owns the arenas of the query, its own and one for each worker context made from
+ * it, so what executors allocate there is released in bulk once the query is done.
  */
 class ExecutorContext {
  public:
   /**
    * Creates an ExecutorContext for the transaction that is executing the query.
+   * @param transaction The transaction executing the query, nullptr to read and write the latest versions directly
    * @param catalog The catalog that the executor uses
    * @param bpm The buffer pool manager that the executor uses
+   * @param lock_manager The lock manager writers lock tables and rows with, nullptr to write without locks
+   * @param thread_pool The pool parallel pipelines run their workers on, nullptr to run every plan serially
    */
-  ExecutorContext(Catalog *catalog, BufferPoolManager *bpm): catalog_{catalog}, bpm_{bpm} {}
+  ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm,
+                  LockManager *lock_manager = nullptr, ThreadPool *thread_pool = nullptr)
+      : transaction_{transaction},
+        catalog_{catalog},
+        bpm_{bpm},
+        lock_manager_{lock_manager},
+        thread_pool_{thread_pool},
+        arena_{AddArena()} {}
+
+  /**
+   * Creates the context of one worker of a parallel pipeline, for the same query as parent.
+   * @param parent The context of the query
+   * @param parallel_state The state the workers of the pipeline share, nullptr for a pipeline with one worker
+   * @param worker_idx The index of the worker among those of the pipeline
+   */
+  ExecutorContext(ExecutorContext *parent, ParallelState *parallel_state, size_t worker_idx)
+      : transaction_{parent->transaction_},
+        catalog_{parent->catalog_},
+        bpm_{parent->bpm_},
+        lock_manager_{parent->lock_manager_},
+        thread_pool_{parent->thread_pool_},
+        work_mem_{parent->work_mem_},
+        parallel_state_{parallel_state},
+        worker_idx_{worker_idx},
+        query_ctx_{parent->query_ctx_},
+        arena_{query_ctx_->AddArena()} {}
 
   ~ExecutorContext() = default;
 
   DISALLOW_COPY_AND_MOVE(ExecutorContext);
 
+  /** @return the running transaction */
+  auto GetTransaction() const -> Transaction * { return transaction_; }
+
   /** @return the catalog */
   auto GetCatalog() -> Catalog * { return catalog_; }
 
   /** @return the buffer pool manager */
   auto GetBufferPoolManager() -> BufferPoolManager * { return bpm_; }
 
+  /** @return the lock manager, nullptr if the transaction does not lock */
+  auto GetLockManager() -> LockManager * { return transaction_ != nullptr ? lock_manager_ : nullptr; }
+
+  /** @return the thread pool, nullptr if the query runs serially */
+  auto GetThreadPool() -> ThreadPool * { return thread_pool_; }
+
+  /** @return the bytes of state an operator like a hash join may hold in memory before it spills to disk */
+  auto GetWorkMem() const -> size_t { return work_mem_; }
+
+  void SetWorkMem(size_t work_mem) { work_mem_ = work_mem; }
+
+  /** @return the state shared by the workers of the pipeline, nullptr outside of a parallel pipeline */
+  auto GetParallelState() -> ParallelState * { return parallel_state_; }
+
+  /** @return the index of the worker among those of its pipeline */
+  auto GetWorkerIndex() const -> size_t { return worker_idx_; }
+
+  /**
+   * @return the arena for memory an executor holds until the query is done, like the VARCHARs of its hash table. It
+   * is this worker's own, what is allocated there stays valid until the context of the query is destroyed.
+   */
+  auto GetArena() -> ArenaPool * { return arena_; }
+
+  /**
+   * @return the temporary file operators of the query spill to, shared by its workers. It is removed with the context
+   * of the query, so spills never end up in the database file.
+   */
+  auto GetTmpFile() -> TmpFile * { return &query_ctx_->tmp_file_; }
+
   /** @return the log manager - don't worry about it for now */
   auto GetLogManager() -> LogManager * { return nullptr; }
 
  private:
+  /** @return a new arena kept until this context is destroyed */
+  auto AddArena() -> ArenaPool * {
+    std::scoped_lock lock(arenas_latch_);
+    arenas_.push_back(std::make_unique<ArenaPool>());
+    return arenas_.back().get();
+  }
+
+  /** The transaction context associated with this executor context */
+  Transaction *transaction_;
   /** The datbase catalog associated with this executor context */
   Catalog *catalog_;
   /** The buffer pool manager associated with this executor context */
   BufferPoolManager *bpm_;
+  /** The lock manager associated with this executor context */
+  LockManager *lock_manager_;
+  /** The thread pool parallel pipelines run on */
+  ThreadPool *thread_pool_;
+  /** The memory budget of each operator that spills */
+  size_t work_mem_{DEFAULT_WORK_MEM};
+  /** The state of the parallel pipeline this context is a worker of */
+  ParallelState *parallel_state_{nullptr};
+  size_t worker_idx_{0};
+  /** The context the query was started with, this one outside of a parallel pipeline */
+  ExecutorContext *query_ctx_{this};
+  /** The arenas of the query and of its workers, in the context of the query only */
+  std::mutex arenas_latch_;
+  std::vector<std::unique_ptr<ArenaPool>> arenas_;
+  ArenaPool *arena_;
+  /** The file spilled pages go to, in the context of the query only */
+  TmpFile tmp_file_;
 };
 
 }  // namespace hmssql
@@ -12,6 +12,7 @@
 #pragma once
 
 #include "../include/execution/executor_context.h"
+#include "../include/execution/tuple_batch.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
@@ -45,6 +46,23 @@ class AbstractExecutor {
    */
   virtual auto Next(Tuple *tuple, RID *rid) -> bool = 0;
 
+  /**
+   * Yield the next batch of up to TUPLE_BATCH_SIZE tuples, so the per-tuple cost of the virtual calls and of
+   * interpreting expressions is paid once per batch. A consumer calls either Next() or NextBatch() on an executor,
+   * not both. The default collects tuples from Next(), executors that can work on columns override it.
+   * @param[out] batch The next batch, laid out by the output schema
+   * @return `true` if the batch has at least one selected tuple, `false` if there are no more tuples
+   */
+  virtual auto NextBatch(TupleBatch *batch) -> bool {
+    batch->Reset(&GetOutputSchema());
+    Tuple tuple{};
+    RID rid{};
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->GetRowCount() > 0;
+  }
+
   /** @return The schema of the tuples that this executor produces */
   virtual auto GetOutputSchema() const -> const Schema & = 0;
 
@@ -36,10 +36,11 @@ class SimpleAggregationHashTable {
    * Construct a new SimpleAggregationHashTable instance.
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param arena the arena the VARCHARs of the keys and aggregates the table keeps are copied into
    */
   SimpleAggregationHashTable(const std::vector<AbstractExpressionRef> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
+                             const std::vector<AggregationType> &agg_types, ArenaPool *arena)
+      : agg_exprs_{agg_exprs}, agg_types_{agg_types}, arena_{arena} {}
 
   /** @return The initial aggregrate value for this aggregation executor */
   auto GenerateInitialAggregateValue() -> AggregateValue {
@@ -85,23 +86,22 @@ class SimpleAggregationHashTable {
           break;
         case AggregationType::SumAggregate:
           if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
+            result->aggregates_[i] = ValueFactory::Clone(input.aggregates_[i], arena_);
           } else if (!input.aggregates_[i].IsNull()) {
             result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
           }
           break;
         case AggregationType::MinAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
+          // Only a new minimum or maximum is copied, the input points into the batch
+          if (result->aggregates_[i].IsNull() ||
+              input.aggregates_[i].CompareLessThan(result->aggregates_[i]) == CmpBool::CmpTrue) {
+            result->aggregates_[i] = ValueFactory::Clone(input.aggregates_[i], arena_);
           }
           break;
         case AggregationType::MaxAggregate:
-          if (result->aggregates_[i].IsNull()) {
-            result->aggregates_[i] = input.aggregates_[i];
-          } else if (!input.aggregates_[i].IsNull()) {
-            result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
+          if (result->aggregates_[i].IsNull() ||
+              input.aggregates_[i].CompareGreaterThan(result->aggregates_[i]) == CmpBool::CmpTrue) {
+            result->aggregates_[i] = ValueFactory::Clone(input.aggregates_[i], arena_);
           }
           break;
       }
@@ -114,10 +114,17 @@ class SimpleAggregationHashTable {
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht_.count(agg_key) == 0) {
-      ht_.insert({agg_key, GenerateInitialAggregateValue()});
+    auto it = ht_.find(agg_key);
+    if (it == ht_.end()) {
+      // Only the key of a new group is copied
+      AggregateKey key;
+      key.group_bys_.reserve(agg_key.group_bys_.size());
+      for (const auto &value : agg_key.group_bys_) {
+        key.group_bys_.push_back(ValueFactory::Clone(value, arena_));
+      }
+      it = ht_.emplace(std::move(key), GenerateInitialAggregateValue()).first;
     }
-    CombineAggregateValues(&ht_[agg_key], agg_val);
+    CombineAggregateValues(&it->second, agg_val);
   }
 
   void InsertIntialCombine() { ht_.insert({{std::vector<Value>()}, GenerateInitialAggregateValue()}); }
@@ -171,6 +178,8 @@ class SimpleAggregationHashTable {
   const std::vector<AbstractExpressionRef> &agg_exprs_;
   /** The types of aggregations that we have */
   const std::vector<AggregationType> &agg_types_;
+  /** Where the VARCHARs the table keeps live */
+  ArenaPool *arena_;
 };
 
 /**
@@ -199,6 +208,9 @@ class AggregationExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /** Yield the next batch of groups from the aggregation. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the aggregation */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
@@ -206,22 +218,26 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
-  /** @return The tuple as an AggregateKey */
-  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
-    std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+  /** Put the evaluated group by and aggregate columns of a row into key_ and input_, VARCHARs pointing into them */
+  void GatherRow(const std::vector<ColumnVector> &group_bys, const std::vector<ColumnVector> &aggregates,
+                 uint32_t row) {
+    key_.group_bys_.clear();
+    for (const auto &column : group_bys) {
+      key_.group_bys_.push_back(column.GetValueView(row));
+    }
+    input_.aggregates_.clear();
+    for (const auto &column : aggregates) {
+      input_.aggregates_.push_back(column.GetValueView(row));
     }
-    return {keys};
   }
 
-  /** @return The tuple as an AggregateValue */
-  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
+  /** @return The output values of the group the iterator is at */
+  auto MakeOutputValues() -> std::vector<Value> {
+    std::vector<Value> values;
+    values.reserve(GetOutputSchema().GetColumnCount());
+    values.insert(values.end(), aht_iterator_.Key().group_bys_.begin(), aht_iterator_.Key().group_bys_.end());
+    values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
+    return values;
   }
 
  private:
@@ -233,5 +249,8 @@ class AggregationExecutor : public AbstractExecutor {
   SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator */
   SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The group by and aggregate values of the row being inserted, reused from row to row */
+  AggregateKey key_;
+  AggregateValue input_;
 };
 }  // namespace hmssql
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// gather_executor.h
+//
+// Identification: src/include/execution/executors/gather_executor.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "../include/execution/exchange_queue.h"
+#include "../include/execution/executor_context.h"
+#include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/parallel_state.h"
+#include "../include/execution/plans/gather_plan.h"
+
+namespace hmssql {
+
+/**
+ * GatherExecutor runs a copy of its child plan on each of its workers, threads of the query's thread pool, and
+ * merges their batches through an ExchangeQueue.
+ */
+class GatherExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new GatherExecutor instance.
+   * @param exec_ctx The executor context, it must have a thread pool
+   * @param plan The gather plan to be executed
+   */
+  GatherExecutor(ExecutorContext *exec_ctx, const GatherPlanNode *plan);
+
+  /** Stop the workers */
+  ~GatherExecutor() override;
+
+  /** Initialize the gather: start the workers */
+  void Init() override;
+
+  /**
+   * Yield the next tuple of any of the workers.
+   * @param[out] tuple The next tuple produced by the gather
+   * @param[out] rid The next tuple RID produced by the gather
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** Yield the next batch of any of the workers. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return The output schema for the gather */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+ private:
+  /** The task of a worker: run its copy of the child into the exchange */
+  void RunWorker(AbstractExecutor *child);
+
+  /** Close the exchange, wait for the workers and drop their executors */
+  void StopWorkers();
+
+  /** The gather plan node to be executed */
+  const GatherPlanNode *plan_;
+
+  /** Shared by the executors of the workers, and the contexts they run in */
+  std::unique_ptr<ParallelState> parallel_state_;
+  std::vector<std::unique_ptr<ExecutorContext>> worker_ctxs_;
+  std::vector<std::unique_ptr<AbstractExecutor>> worker_executors_;
+  std::vector<std::future<void>> workers_;
+  std::unique_ptr<ExchangeQueue> exchange_;
+
+  /** The batch Next() hands out tuples from, and the position in it */
+  TupleBatch current_batch_;
+  uint32_t current_idx_{0};
+};
+}  // namespace hmssql
@@ -11,21 +11,128 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "../include/common/util/hash_util.h"
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/executors/seq_scan_executor.h"
 #include "../include/execution/plans/hash_join_plan.h"
+#include "../include/execution/runtime_filter.h"
+#include "../include/execution/tuple_batch.h"
+#include "../include/storage/table/tmp_tuple_heap.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * JoinHashTable holds the build side of a hash join. The build rows are stored back to back in one array of values,
+ * their VARCHAR bytes in an ArenaPool of the table, and the rows of a key are chained by row index. A key is a fixed number of values, one per join key expression,
+ * hashed together. The distinct keys are kept in an open-addressing table of slots, each with the full hash, the
+ * index of the key and the first and last of its rows. Next to the slots is a directory of one-byte tags taken from
+ * the top bits of the hash, so a probe walks the dense tags and only reads a slot and compares keys when the tags
+ * agree.
+ */
+class JoinHashTable {
+ public:
+  /** Returned by Find and NextRow when there are no more rows */
+  static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+  /** Empty the table and take keys of key_width values and build rows of row_width values from here on. */
+  void Reset(uint32_t key_width, uint32_t row_width);
+
+  /** @return true if a value of key is null, such keys never join */
+  auto HasNull(const Value *key) const -> bool;
+
+  /** @return the hash of a key, with the bits of HashUtil::HashValue spread so both ends of it can be used */
+  auto HashKey(const Value *key) const -> hash_t;
+
+  /** Add a row of batch under key, whose hash is hash. The key has no null. */
+  void Insert(const Value *key, hash_t hash, const TupleBatch &batch, uint32_t row);
+
+  /** Add a row of values under key, whose hash is hash. The key has no null. */
+  void Insert(const Value *key, hash_t hash, const Value *row_values);
+
+  /** @return the first build row whose key equals key, whose hash is hash, NO_ROW if there is none */
+  auto Find(const Value *key, hash_t hash) const -> uint32_t;
+
+  /** @return the build row after row with the same key, NO_ROW after the last one */
+  auto NextRow(uint32_t row) const -> uint32_t { return next_rows_[row]; }
+
+  /** @return the values of a build row */
+  auto GetRow(uint32_t row) const -> const Value * { return &values_[static_cast<size_t>(row) * row_width_]; }
+
+  /** @return the number of build rows */
+  auto RowCount() const -> size_t { return next_rows_.size(); }
+
+  /** @return the number of distinct keys */
+  auto KeyCount() const -> size_t { return key_width_ == 0 ? 0 : keys_.size() / key_width_; }
+
+  /** @return the bytes the table holds, roughly */
+  auto MemoryUsage() const -> size_t;
+
+  /** Call f(key, hash, first_row) for every distinct key. */
+  template <typename F>
+  void ForEachKey(F &&f) const {
+    for (size_t pos = 0; pos < slots_.size(); pos++) {
+      if (tags_[pos] != 0) {
+        f(&keys_[static_cast<size_t>(slots_[pos].key_) * key_width_], slots_[pos].hash_, slots_[pos].first_row_);
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    hash_t hash_;
+    uint32_t key_;
+    uint32_t first_row_;
+    uint32_t last_row_;
+  };
+
+  /** @return the tag of a hash, never 0 which marks an empty slot */
+  static auto TagOf(hash_t hash) -> uint8_t { return static_cast<uint8_t>(0x80 | (hash >> 57)); }
+
+  /** @return true if the stored key key_idx equals key */
+  auto KeyEquals(uint32_t key_idx, const Value *key) const -> bool;
+
+  /** Append a value to values, a VARCHAR with its bytes copied into the arena of the table. */
+  void AppendValue(std::vector<Value> *values, const Value &value);
+
+  /** Chain the build row just appended under key. */
+  void Link(const Value *key, hash_t hash);
+
+  /** Double the slots and place the keys again. */
+  void Grow();
+
+  uint32_t key_width_{0};
+  uint32_t row_width_{0};
+  /** The build rows, row_width_ values each */
+  std::vector<Value> values_;
+  /** The next build row with the same key, by row */
+  std::vector<uint32_t> next_rows_;
+  /** The distinct keys, key_width_ values each, in the order they were first inserted */
+  std::vector<Value> keys_;
+  /** The tag directory, one per slot, 0 for empty slots */
+  std::vector<uint8_t> tags_;
+  std::vector<Slot> slots_;
+  /** The bytes of the varchars in values_ and keys_, released when the table is reset */
+  ArenaPool varlen_arena_;
+};
+
+/**
+ * HashJoinExecutor executes a hash JOIN on two tables, building a JoinHashTable of the right side.
+ *
+ * The join is a hybrid hash join. While the build side fits in work_mem it stays in memory. Once it outgrows it, the
+ * build rows are split by hash into HASH_JOIN_SPILL_PARTITIONS partitions. The first partition stays in the table, the
+ * others spill to temporary pages, and probe rows of spilled partitions are spilled alongside. After the left side
+ * was probed, the spilled partitions are joined one by one the same way, split further when they do not fit either.
+ *
+ * When an inner join probes with a sequential scan on plain columns and the build stayed in memory, the keys of the
+ * table are put into a RuntimeFilter the scan checks, so most left rows without a match never leave their page.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -39,7 +146,7 @@ class HashJoinExecutor : public AbstractExecutor {
   HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
 
-  /** Initialize the join */
+  /** Initialize the join, building the hash table of the right side. The left side is probed as tuples are pulled. */
   void Init() override;
 
   /**
@@ -50,20 +157,104 @@ class HashJoinExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /** Yield the next batch of joined tuples. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** A partition of both sides of the join spilled to temporary pages */
+  struct SpillPartition {
+    std::unique_ptr<TmpTupleHeap> build_;
+    std::unique_ptr<TmpTupleHeap> probe_;
+    /** The level of the build of the partition, the number of times its rows were split */
+    uint32_t level_{0};
+  };
+
+  /** memory_partition_ when every partition spilled */
+  static constexpr uint32_t NO_PARTITION = UINT32_MAX;
+
+  /** Builds at this level keep their rows in memory whatever their size, a key can have more rows than fit */
+  static constexpr uint32_t MAX_SPILL_LEVEL = 8;
+
+  /**
+   * Put the values of the next joined row into values_, probing with the left side as far as needed.
+   * @return `false` when the left side is exhausted
+   */
+  auto NextJoinedRow() -> bool;
+
+  /** Build the hash table from the batches next_batch returns, spilling partitions when it outgrows work_mem. */
+  void Build(const std::function<bool(TupleBatch *)> &next_batch, uint32_t level);
+
+  /**
+   * Split the build rows into partitions and spill those of all but the partition kept in memory, or spill that one
+   * too if the rows were split already.
+   * @return false if the build cannot spill
+   */
+  auto Spill() -> bool;
+
+  /** @return the partition of a key hash for the build being done */
+  auto PartitionOf(hash_t hash) const -> uint32_t;
+
+  /** Read the next batch of the probe side, of the left child or of the partition being joined. */
+  auto NextProbeBatch() -> bool;
+
+  /**
+   * Build the table of the next spilled partition and probe it with its spilled left rows from here on.
+   * @return false if no partition is left
+   */
+  auto NextPartition() -> bool;
+
+  /** Read the next tuples of heap into batch, which gets laid out by schema. */
+  static auto ReadBatch(TmpTupleHeap *heap, const Schema *schema, TupleBatch *batch) -> bool;
+
+  /** Evaluate the join key expressions on batch, one column of keys each. */
+  static void EvaluateKeys(const std::vector<AbstractExpressionRef> &key_expressions, const TupleBatch &batch,
+                           std::vector<ColumnVector> *keys);
+
+  /** Gather the key of a row from the columns of keys into key_. */
+  void GatherKey(const std::vector<ColumnVector> &keys, uint32_t row);
+
+  /** Hand the probe scan a filter of the keys in the table, if it takes one and no build row spilled. */
+  void PushRuntimeFilter();
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
 
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
 
-  std::unordered_map<hash_t, std::vector<Tuple>> hash_join_table_;
+  /** The left child if it is a scan the build keys can filter, the columns of the table the left keys are */
+  SeqScanExecutor *probe_scan_{nullptr};
+  std::vector<uint32_t> probe_key_columns_;
+  /** The filter handed to probe_scan_ */
+  std::unique_ptr<RuntimeFilter> runtime_filter_;
+
+  /** The tuples of the right side, by join key */
+  JoinHashTable hash_join_table_;
+
+  /** The partitions of the current build, by partition, empty if the build fit in work_mem */
+  std::vector<SpillPartition> spill_partitions_;
+  /** The partition of the current build whose rows are in the table */
+  uint32_t memory_partition_{0};
+  uint32_t build_level_{0};
+  /** The spilled partitions left to join */
+  std::vector<SpillPartition> pending_partitions_;
+  /** The spilled partition being joined, its probe_ is read instead of the left child when set */
+  SpillPartition current_partition_;
 
-  std::vector<Tuple> output_tuples_;
-  std::vector<Tuple>::const_iterator output_tuples_iter_;
+  /** The batch of the left side being probed, its join keys and the next of its selected rows to probe */
+  TupleBatch left_batch_;
+  std::vector<ColumnVector> left_keys_;
+  uint32_t left_idx_{0};
+  bool left_done_{false};
+  /** The next build row to join with the current left row */
+  uint32_t build_row_{JoinHashTable::NO_ROW};
+  /** The key of the row being inserted or probed, its VARCHARs pointing into the key columns */
+  std::vector<Value> key_;
+  /** The joined row, the columns of the current left row first, its VARCHARs pointing into the batch and the table */
+  std::vector<Value> values_;
 };
 
 }  // namespace hmssql
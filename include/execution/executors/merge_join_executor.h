@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../include/execution/executor_context.h"
+#include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/plans/merge_join_plan.h"
+#include "../include/execution/tuple_batch.h"
+#include "../include/storage/table/tuple.h"
+
+namespace hmssql {
+
+/**
+ * MergeJoinExecutor executes a merge JOIN on two inputs sorted ascending by their join keys.
+ *
+ * The right rows that share a key form a run. The run of the key of the current left row is held in memory, so left
+ * rows with the same key all join it without the right side being read again. Right rows with keys no left row has
+ * are skipped without being copied. Rows with a null key join nothing.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new MergeJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The MergeJoin plan to be executed
+   * @param left_child The child executor that produces the sorted tuples of the left side
+   * @param right_child The child executor that produces the sorted tuples of the right side
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Initialize the join. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join.
+   * @param[out] rid The next tuple RID, not used by merge join.
+   * @return `true` if a tuple was produced, `false` if there are no more tuples.
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** Yield the next batch of joined tuples. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return The output schema for the join */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
+
+ private:
+  /** One side of the join, read a batch at a time with the join keys evaluated on whole batches */
+  struct SortedInput {
+    AbstractExecutor *executor_{nullptr};
+    const std::vector<AbstractExpressionRef> *key_expressions_{nullptr};
+    TupleBatch batch_{};
+    std::vector<ColumnVector> keys_{};
+    /** The current one of the selected rows of batch_ */
+    uint32_t idx_{0};
+    bool done_{false};
+
+    /** Make sure there is a current row, reading the next batch when needed. @return false at the end of the input */
+    auto HasRow() -> bool;
+
+    /** Gather the key of the current row into key. */
+    void GatherKey(std::vector<Value> *key) const;
+
+    /** @return the row of batch_ that is current */
+    auto Row() const -> uint32_t { return batch_.RowAt(idx_); }
+  };
+
+  /** @return <0, 0 or >0 as key a is less than, equal to or greater than key b. Neither has a null. */
+  static auto CompareKeys(const std::vector<Value> &a, const std::vector<Value> &b) -> int;
+
+  static auto HasNull(const std::vector<Value> &key) -> bool;
+
+  /**
+   * Make run_ the run of key if the right side has it, skipping the right rows with smaller keys.
+   * @return true if key has a run
+   */
+  auto SeekRun(const std::vector<Value> &key) -> bool;
+
+  /**
+   * Put the values of the next joined row into values_.
+   * @return `false` when the join is done
+   */
+  auto NextJoinedRow() -> bool;
+
+  /** The MergeJoin plan node to be executed. */
+  const MergeJoinPlanNode *plan_;
+
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  SortedInput left_;
+  SortedInput right_;
+
+  /** The right rows of the run, right_width values each, and its key if there is a run */
+  std::vector<Value> run_;
+  std::vector<Value> run_key_;
+  bool has_run_{false};
+  /** The next row of the run to join with the current left row, the size of the run when it is done */
+  size_t run_row_{0};
+  size_t run_rows_{0};
+
+  /** The keys of the current rows */
+  std::vector<Value> left_key_;
+  std::vector<Value> right_key_;
+  /** The joined row, the columns of the current left row first */
+  std::vector<Value> values_;
+};
+
+}  // namespace hmssql
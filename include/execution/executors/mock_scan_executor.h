@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <string>
 #include <vector>
@@ -26,7 +27,8 @@ extern const char *mock_table_list[];
 auto GetMockTableSchemaOf(const std::string &table) -> Schema;
 
 /**
- * The MockScanExecutor executor executes a sequential table scan for tests.
+ * The MockScanExecutor executor executes a sequential table scan for tests. In the workers of a parallel pipeline
+ * the workers claim ranges of rows from a cursor they share, shuffled tables are then read in order.
  */
 class MockScanExecutor : public AbstractExecutor {
  public:
@@ -67,8 +69,12 @@ class MockScanExecutor : public AbstractExecutor {
   /** The plan node for the scan */
   const MockScanPlanNode *plan_;
 
-  /** The cursor for the current mock scan */
+  /** The cursor for the current mock scan, and the end of the range of rows it is in */
   std::size_t cursor_{0};
+  std::size_t end_{0};
+
+  /** The next row no worker claimed, shared by the workers of a parallel pipeline, nullptr outside of one */
+  std::atomic<std::size_t> *shared_cursor_{nullptr};
 
   /** The table function */
   std::function<Tuple(std::size_t)> func_;
@@ -46,6 +46,9 @@ class ProjectionExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /** Yield the next batch from the projection, each expression is evaluated on a whole batch of the child. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the projection plan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
@@ -55,5 +58,12 @@ class ProjectionExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The batch of the child the output batch is computed from */
+  TupleBatch child_batch_;
+
+  /** The tuple of the child and the values computed from it, kept so that Next reuses their buffers */
+  Tuple child_tuple_;
+  std::vector<Value> values_;
 };
 }  // namespace hmssql
@@ -0,0 +1,214 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// radix_hash_join_executor.h
+//
+// Identification: src/include/execution/executors/radix_hash_join_executor.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "../include/execution/executor_context.h"
+#include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/executors/hash_join_executor.h"
+#include "../include/execution/plans/hash_join_plan.h"
+#include "../include/execution/tuple_batch.h"
+
+namespace hmssql {
+
+/**
+ * RadixPartition holds the rows of one side of a radix join that fall into one partition, in full batches but the
+ * last, and the key hash of every row in the order the rows were appended.
+ */
+class RadixPartition {
+ public:
+  /** Append a row of source, whose key hash is hash. */
+  void Append(const TupleBatch &source, uint32_t row, hash_t hash);
+
+  auto GetBatches() const -> const std::vector<TupleBatch> & { return batches_; }
+
+  /** @return the key hash of row of batch batch_idx */
+  auto GetHash(size_t batch_idx, uint32_t row) const -> hash_t { return hashes_[batch_idx * TUPLE_BATCH_SIZE + row]; }
+
+  auto RowCount() const -> size_t { return hashes_.size(); }
+
+  /** Release the rows. */
+  void Clear();
+
+ private:
+  std::vector<TupleBatch> batches_;
+  std::vector<hash_t> hashes_;
+};
+
+/**
+ * RadixJoinState is what the workers of a radix join share: the partitions each of them split its share of both
+ * sides into, and which partitions were taken for joining. Each worker writes only to its own partitions, and a
+ * partition is joined by the one worker that takes it, once every worker finished partitioning.
+ */
+class RadixJoinState {
+ public:
+  /** The number of partitions of the first pass */
+  static constexpr uint32_t PARTITIONS = 1 << RADIX_JOIN_BITS;
+
+  explicit RadixJoinState(size_t workers);
+
+  DISALLOW_COPY_AND_MOVE(RadixJoinState);
+
+  /** @return the partitions of the right side of worker */
+  auto GetBuildPartitions(size_t worker) -> std::vector<RadixPartition> & { return build_[worker]; }
+
+  /** @return the partitions of the left side of worker */
+  auto GetProbePartitions(size_t worker) -> std::vector<RadixPartition> & { return probe_[worker]; }
+
+  auto GetWorkers() const -> size_t { return build_.size(); }
+
+  /**
+   * Note that a worker finished partitioning and wait for the others.
+   * @return false if a worker failed, there is nothing to join then
+   */
+  auto ArriveAndWait() -> bool;
+
+  /** Note that a worker failed to partition, so the others stop waiting. */
+  void Abandon();
+
+  /** @return a partition no worker took yet, PARTITIONS if none is left */
+  auto TakePartition() -> uint32_t;
+
+ private:
+  /** The partitions, by worker and partition */
+  std::vector<std::vector<RadixPartition>> build_;
+  std::vector<std::vector<RadixPartition>> probe_;
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  size_t arrived_{0};
+  bool abandoned_{false};
+  std::atomic<uint32_t> next_partition_{0};
+};
+
+/**
+ * RadixHashJoinExecutor is one worker of a radix-partitioned hash join. A single hash table of a large build side
+ * misses the cache on nearly every probe, so both sides are split into partitions small enough for their table to
+ * stay in the L2 cache. Every worker reads its share of both children and splits it by the key hash into
+ * RadixJoinState::PARTITIONS partitions. Once all of them are done, the workers take turns at the partitions: a
+ * partition whose build side would outgrow RADIX_JOIN_PARTITION_BYTES is split once more by the next bits of the
+ * hash, then the table of each build part is built and probed with the rows of the same part of the left side.
+ *
+ * The partitions take the bits above the low 32 of the hash, the low bits pick the slots of the JoinHashTable. Both
+ * sides are held in memory, a radix join does not spill.
+ */
+class RadixHashJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new RadixHashJoinExecutor instance.
+   * @param exec_ctx The executor context of a worker of a parallel pipeline
+   * @param plan The radix-partitioned HashJoin plan to be executed
+   * @param left_child The worker's copy of the left side, producing its share of the left tuples
+   * @param right_child The worker's copy of the right side, producing its share of the right tuples
+   */
+  RadixHashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                        std::unique_ptr<AbstractExecutor> &&left_child,
+                        std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Partition the worker's share of both sides and wait for the other workers to do the same. */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join.
+   * @param[out] rid The next tuple RID, not used by hash join.
+   * @return `true` if a tuple was produced, `false` if there are no more tuples.
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** Yield the next batch of joined tuples. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return The output schema for the join */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
+
+ private:
+  /** The parts of both sides that are built and probed together */
+  struct PartitionPair {
+    std::vector<RadixPartition *> build_;
+    std::vector<RadixPartition *> probe_;
+  };
+
+  /**
+   * Split the tuples of child by the hash of key_expressions into partitions. Rows with a null key are dropped, or
+   * put into the first partition if keep_nulls, they join no row.
+   */
+  void Partition(AbstractExecutor *child, const std::vector<AbstractExpressionRef> &key_expressions, bool keep_nulls,
+                 std::vector<RadixPartition> *partitions);
+
+  /**
+   * Take the next partition of the join and make pairs_ of it, after a second pass if its build side is too large.
+   * @return false if no partition is left
+   */
+  auto TakePartition() -> bool;
+
+  /** Build the table of the next pair of pairs_ and probe it from here on. @return false if no pair is left */
+  auto NextPair() -> bool;
+
+  /** Point probe_batch_ at the next batch of the probe side, of this pair or the next ones. */
+  auto NextProbeBatch() -> bool;
+
+  /**
+   * Put the values of the next joined row into values_.
+   * @return `false` when every partition was joined
+   */
+  auto NextJoinedRow() -> bool;
+
+  /** Evaluate key_expressions on batch into keys_, and gather the key of row into key_ from them. */
+  void EvaluateKeys(const std::vector<AbstractExpressionRef> &key_expressions, const TupleBatch &batch);
+  void GatherKey(uint32_t row);
+
+  /** The HashJoin plan node to be executed. */
+  const HashJoinPlanNode *plan_;
+
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+
+  RadixJoinState *state_{nullptr};
+  /** Whether there is anything left to join, false once every partition was joined or if a worker failed */
+  bool joinable_{false};
+
+  /** The table of the pair being probed */
+  JoinHashTable hash_join_table_;
+
+  /** The parts of the second pass of the partition taken, empty if it was not split */
+  std::vector<RadixPartition> split_build_;
+  std::vector<RadixPartition> split_probe_;
+  /** The pairs of the partition taken, and the next of them to build, the one before is being probed */
+  std::vector<PartitionPair> pairs_;
+  size_t pair_idx_{0};
+
+  /** The probe part and batch being probed, and the next row of it */
+  size_t probe_part_idx_{0};
+  size_t probe_batch_idx_{0};
+  const TupleBatch *probe_batch_{nullptr};
+  uint32_t left_idx_{0};
+  /** The next build row to join with the current left row */
+  uint32_t build_row_{JoinHashTable::NO_ROW};
+
+  /** The join keys of a batch, and the key of the row being inserted or probed, pointing into them */
+  std::vector<ColumnVector> keys_;
+  std::vector<Value> key_;
+  /** The joined row, the columns of the current left row first, its VARCHARs pointing into the batch and the table */
+  std::vector<Value> values_;
+
+  /** The batch Next() hands out tuples from, and the position in it */
+  TupleBatch current_batch_;
+  uint32_t current_idx_{0};
+};
+
+}  // namespace hmssql
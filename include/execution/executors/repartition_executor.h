@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// repartition_executor.h
+//
+// Identification: src/include/execution/executors/repartition_executor.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "../include/execution/exchange_queue.h"
+#include "../include/execution/executor_context.h"
+#include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/parallel_state.h"
+#include "../include/execution/plans/repartition_plan.h"
+
+namespace hmssql {
+
+/**
+ * RepartitionState is the part of a repartition the workers of the pipeline above share: the producers running the
+ * child plan and one ExchangeQueue per partition they fill. It is created by the first worker that initializes its
+ * RepartitionExecutor, and stops the producers when it is destroyed.
+ */
+class RepartitionState {
+ public:
+  /**
+   * Start the producers.
+   * @param exec_ctx The context of the worker that creates the state
+   * @param plan The repartition plan
+   */
+  RepartitionState(ExecutorContext *exec_ctx, const RepartitionPlanNode *plan);
+
+  /** Close the partitions and wait for the producers */
+  ~RepartitionState();
+
+  DISALLOW_COPY_AND_MOVE(RepartitionState);
+
+  /** @return the queue of partition */
+  auto GetPartition(size_t partition) -> ExchangeQueue & { return *partitions_[partition]; }
+
+ private:
+  /** The task of a producer: run its copy of the child and hash its tuples into the partitions */
+  void RunProducer(AbstractExecutor *child);
+
+  /** Hand a full batch of a partition to its queue. @return false if the worker of the partition went away */
+  auto PushPartition(size_t partition, std::vector<TupleBatch> *outputs) -> bool;
+
+  const RepartitionPlanNode *plan_;
+  std::vector<std::unique_ptr<ExchangeQueue>> partitions_;
+
+  /** Shared by the executors of the producers, and the contexts they run in */
+  std::unique_ptr<ParallelState> parallel_state_;
+  std::vector<std::unique_ptr<ExecutorContext>> producer_ctxs_;
+  std::vector<std::unique_ptr<AbstractExecutor>> producer_executors_;
+  std::vector<std::future<void>> producers_;
+};
+
+/**
+ * RepartitionExecutor hands the worker it runs in the tuples of its partition, the worker's index.
+ */
+class RepartitionExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new RepartitionExecutor instance.
+   * @param exec_ctx The executor context of a worker of a parallel pipeline
+   * @param plan The repartition plan to be executed
+   */
+  RepartitionExecutor(ExecutorContext *exec_ctx, const RepartitionPlanNode *plan);
+
+  /** Stop reading the partition */
+  ~RepartitionExecutor() override;
+
+  /** Initialize the repartition, the first worker to do so starts the producers */
+  void Init() override;
+
+  /**
+   * Yield the next tuple of the partition.
+   * @param[out] tuple The next tuple of the partition
+   * @param[out] rid The next tuple RID of the partition
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** Yield the next batch of the partition. */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
+  /** @return The output schema for the repartition */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
+
+ private:
+  /** The repartition plan node to be executed */
+  const RepartitionPlanNode *plan_;
+  RepartitionState *state_{nullptr};
+
+  /** The batch Next() hands out tuples from, and the position in it */
+  TupleBatch current_batch_;
+  uint32_t current_idx_{0};
+};
+}  // namespace hmssql
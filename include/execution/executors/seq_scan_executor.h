@@ -16,12 +16,18 @@
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executors/abstract_executor.h"
 #include "../include/execution/plans/seq_scan_plan.h"
+#include "../include/execution/runtime_filter.h"
+#include "../include/storage/table/morsel_dispenser.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. In a worker of a parallel pipeline it is a partial
+ * scan: the workers claim morsels of pages from a MorselDispenser they share, and each scans the pages it claimed.
+ *
+ * A hash join probing with the scan may hand it a RuntimeFilter of its build keys. The scan then reads whole pages
+ * and drops the tuples the filter rules out while they are still on the page.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -43,13 +49,50 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
+  /**
+   * Yield the next batch of the sequential scan. The filter predicate is evaluated on the whole batch, batches none
+   * of whose tuples pass are skipped.
+   */
+  auto NextBatch(TupleBatch *batch) -> bool override;
+
   /** @return The output schema for the sequential scan */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
+  /**
+   * Drop the tuples filter rules out from here on. To be set after Init and before the first tuple is pulled, Init
+   * clears it.
+   * @param filter the filter, on the columns of the table schema, owned by the caller
+   */
+  void SetRuntimeFilter(RuntimeFilter *filter);
+
  private:
+  /** @return true if the scan shares the table with the other workers of a parallel pipeline */
+  auto IsPartial() const -> bool { return dispenser_ != nullptr; }
+
+  /** @return true if the scan reads the table a page at a time rather than through the table iterator */
+  auto ReadsPages() const -> bool { return IsPartial() || runtime_filter_ != nullptr; }
+
+  /**
+   * @return the next tuple of the pages this worker claimed, or of the next page of the table for a serial scan,
+   * nullptr when the table is done
+   */
+  auto NextPageTuple() -> const Tuple *;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableIterator table_iter_ = {nullptr, RID()};
   const TableInfo *table_info_;
+
+  /** The dispenser the workers of a partial scan share */
+  MorselDispenser *dispenser_{nullptr};
+  /** The filter of the join probing with the scan, if any, and the next page of a serial scan reading pages */
+  RuntimeFilter *runtime_filter_{nullptr};
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** The pages of the morsel being scanned, and the next of them */
+  std::vector<page_id_t> page_ids_;
+  size_t page_idx_{0};
+  /** The tuples of the page being scanned, and the next of them */
+  std::vector<Tuple> tuples_;
+  size_t tuple_idx_{0};
 };
 }  // namespace hmssql
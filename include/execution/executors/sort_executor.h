@@ -16,14 +16,28 @@
 
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executors/abstract_executor.h"
+#include "../include/execution/loser_tree.h"
 #include "../include/execution/plans/seq_scan_plan.h"
 #include "../include/execution/plans/sort_plan.h"
+#include "../include/execution/sort_key.h"
+#include "../include/storage/table/tmp_tuple_heap.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
 
 /**
  * The SortExecutor executor executes a sort.
+ *
+ * Tuples are compared by the normalized keys of SortKeyEncoder, computed once per tuple. The input is sorted in
+ * memory while it fits in work_mem. Past that it is cut into runs of up to work_mem each, sorted and written to
+ * the temporary file of the query, and Next merges the runs with a loser tree. Every run being merged holds a page in
+ * memory, so if there are more than SORT_MERGE_FAN_IN runs, groups of them are merged into longer runs first.
+ *
+ * A parallel sort, whose plan has workers, runs a copy of its child pipeline on each of them as a gather does, and
+ * every worker sorts its share of the input. Splitters sampled from the sorted shares cut each share into one range
+ * per worker, every row of range i coming before every row of range i + 1, and each worker merges its range of all
+ * shares. Next hands out the merged ranges one after the other. A worker holds its part of work_mem, once one spilled
+ * the rows of all of them are merged from runs.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -31,6 +45,7 @@ class SortExecutor : public AbstractExecutor {
    * Construct a new SortExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The sort plan to be executed
+   * @param child_executor The child executor, nullptr for a parallel sort, which creates one for each of its workers
    */
   SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
 
@@ -49,11 +64,72 @@ class SortExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** The input one worker read, the serial sort has one */
+  struct SortedShare {
+    std::vector<Tuple> tuples_;
+    /** The key of every tuple, KeySize() bytes each, and the size of its exact part */
+    std::vector<char> keys_;
+    std::vector<size_t> exact_;
+    /** The positions in tuples_ in sorted order */
+    std::vector<uint32_t> order_;
+    /** The runs spilled */
+    std::vector<std::unique_ptr<TmpTupleHeap>> runs_;
+  };
+
+  /** Read the tuples of child into share and sort them, spilling runs whenever they take more than work_mem bytes. */
+  void SortShare(AbstractExecutor *child, size_t work_mem, SortedShare *share);
+
+  /** Sort the tuples of share and write them to a new run. */
+  void SpillRun(SortedShare *share);
+
+  /** @return <0, 0 or >0 as row_a of share_a sorts before, with or after row_b of share_b */
+  auto CompareRows(const SortedShare &share_a, uint32_t row_a, const SortedShare &share_b, uint32_t row_b) const
+      -> int;
+
+  /** Cut the shares into ranges at splitters sampled from them, and merge every range on a worker into merged_. */
+  void MergeShares();
+
+  /** Merge range of every share into merged_[range]. */
+  void MergeRange(size_t range);
+
+  /** Merge the runs of every share, in more than one pass if there are too many. */
+  void MergeRuns();
+
+  /** Set up the loser tree to merge the runs from first_run_ on, up to count of them. */
+  void StartMerge(size_t count);
+
+  /** Read the next tuple of run into heads_ and its key into head_keys_. */
+  void ReadHead(size_t run);
+
+  /** @return true if the head of run a comes first, an exhausted run never does */
+  auto Beats(size_t a, size_t b) const -> bool;
+
+  /** Read the next tuple of the runs being merged. @return false once they are all read */
+  auto NextMerged(Tuple *tuple) -> bool;
+
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_;
-  std::vector<Tuple> child_tuples_;
+  SortKeyEncoder sort_keys_;
+
+  std::vector<SortedShare> shares_;
+  /** cuts_[share][range] is where range starts in the order of share, cuts_[share][ranges] its end */
+  std::vector<std::vector<size_t>> cuts_;
+  /** The tuples in sorted order when nothing was spilled, a list per range, and the next one to hand out */
+  std::vector<std::vector<const Tuple *>> merged_;
+  size_t merged_range_{0};
+  size_t merged_row_{0};
 
-  std::vector<Tuple>::const_iterator child_iter_;
+  /** The sorted runs written so far, nullptr once merged, and the first one not merged yet */
+  std::vector<std::unique_ptr<TmpTupleHeap>> runs_;
+  size_t first_run_{0};
+  /** The runs being merged, the current tuple of each and whether it has one */
+  std::vector<TmpTupleHeap *> merge_runs_;
+  std::vector<Tuple> heads_;
+  std::vector<bool> live_;
+  /** The key of every head, KeySize() bytes each, and the size of its exact part */
+  std::vector<char> head_keys_;
+  std::vector<size_t> head_exact_;
+  LoserTree tree_;
 };
 }  // namespace hmssql
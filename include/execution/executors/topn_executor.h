@@ -12,19 +12,27 @@
 #pragma once
 
 #include <memory>
-#include <stack>
 #include <vector>
 
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executors/abstract_executor.h"
 #include "../include/execution/plans/seq_scan_plan.h"
 #include "../include/execution/plans/topn_plan.h"
+#include "../include/execution/sort_key.h"
 #include "../include/storage/table/tuple.h"
 
 namespace hmssql {
 
 /**
  * The TopNExecutor executor executes a topn.
+ *
+ * Only the best n rows seen so far are kept, with their normalized keys of SortKeyEncoder, in slots that a heap of
+ * their positions orders with the worst one on top. A row is encoded once and compared with that worst candidate
+ * before anything is copied: most rows of a large input lose there, and the others take the slot of the candidate
+ * they push out.
+ *
+ * A parallel topn, whose plan has workers, runs a copy of its child pipeline on each of them as a gather does. Every
+ * worker keeps the top n of its share, and their candidates are merged into the top n of the input by their keys.
  */
 class TopNExecutor : public AbstractExecutor {
  public:
@@ -32,6 +40,7 @@ class TopNExecutor : public AbstractExecutor {
    * Construct a new TopNExecutor instance.
    * @param exec_ctx The executor context
    * @param plan The topn plan to be executed
+   * @param child_executor The child executor, nullptr for a parallel topn, which creates one for each of its workers
    */
   TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child_executor);
 
@@ -50,10 +59,33 @@ class TopNExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** The best rows seen so far, up to n of them */
+  struct Candidates {
+    std::vector<Tuple> tuples_;
+    /** The key of every slot, KeySize() bytes each, and the size of its exact part */
+    std::vector<char> keys_;
+    std::vector<size_t> exact_;
+    /** The slots as a heap, the worst candidate on top */
+    std::vector<uint32_t> heap_;
+  };
+
+  /** Offer every tuple of child to candidates. */
+  void Collect(AbstractExecutor *child, Candidates *candidates);
+
+  /** Keep tuple in candidates if it beats the worst of them, or if there are less than n. */
+  void Offer(const Tuple &tuple, const char *key, size_t exact, Candidates *candidates);
+
+  /** @return <0, 0 or >0 as slot a of candidates sorts before, with or after slot b */
+  auto CompareSlots(const Candidates &candidates, uint32_t a, uint32_t b) const -> int;
+
   /** The topn plan node to be executed */
   const TopNPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_;
+  SortKeyEncoder sort_keys_;
 
-  std::stack<Tuple> child_tuples_;
+  Candidates candidates_;
+  /** The slots in sorted order, and the next one to hand out */
+  std::vector<uint32_t> order_;
+  size_t next_{0};
 };
 }  // namespace hmssql
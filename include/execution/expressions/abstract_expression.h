@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "../include/catalog/schema.h"
+#include "../include/execution/tuple_batch.h"
 #include "fmt/format.h"
 #include "../include/storage/table/tuple.h"
 
@@ -64,6 +65,23 @@ class AbstractExpression {
   virtual auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                             const Schema &right_schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression on the selected rows of a batch. The result has as many rows as the batch, the rows that
+   * are not selected are left unspecified. The default evaluates row by row on a tuple built from the batch,
+   * expressions that can work on the columns directly override it.
+   * @param batch The batch, laid out by the schema Evaluate would get
+   * @param[out] result The values, reset to the type of the expression first
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const {
+    result->Reset(GetReturnType());
+    result->Resize(batch.GetRowCount());
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      auto tuple = batch.GetTuple(row);
+      result->Set(row, Evaluate(&tuple, *batch.GetSchema()));
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   auto GetChildAt(uint32_t child_idx) const -> const AbstractExpressionRef & { return children_[child_idx]; }
 
@@ -64,6 +64,30 @@ class ArithmeticExpression : public AbstractExpression {
     return ValueFactory::GetIntegerValue(*res);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->Reset(TypeId::INTEGER);
+    result->Resize(batch.GetRowCount());
+    bool integers = lhs.GetType() == TypeId::INTEGER && lhs.IsIntegral() && rhs.GetType() == TypeId::INTEGER &&
+                    rhs.IsIntegral();
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      if (!integers) {
+        auto res = PerformComputation(lhs.GetValue(row), rhs.GetValue(row));
+        result->Set(row, res == std::nullopt ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                             : ValueFactory::GetIntegerValue(*res));
+      } else if (lhs.IsNull(row) || rhs.IsNull(row)) {
+        result->SetNull(row);
+      } else {
+        result->SetInteger(row, PerformComputation(static_cast<int32_t>(lhs.GetInteger(row)),
+                                                   static_cast<int32_t>(rhs.GetInteger(row))));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), compute_type_, *GetChildAt(1));
@@ -78,11 +102,15 @@ class ArithmeticExpression : public AbstractExpression {
     if (lhs.IsNull() || rhs.IsNull()) {
       return std::nullopt;
     }
+    return PerformComputation(lhs.GetAs<int32_t>(), rhs.GetAs<int32_t>());
+  }
+
+  auto PerformComputation(int32_t lhs, int32_t rhs) const -> int32_t {
     switch (compute_type_) {
       case ArithmeticType::Plus:
-        return lhs.GetAs<int32_t>() + rhs.GetAs<int32_t>();
+        return lhs + rhs;
       case ArithmeticType::Minus:
-        return lhs.GetAs<int32_t>() - rhs.GetAs<int32_t>();
+        return lhs - rhs;
       default:
         UNREACHABLE("Unsupported arithmetic type.");
     }
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "../include/catalog/schema.h"
+#include "../include/common/macros.h"
 #include "../include/execution/expressions/abstract_expression.h"
 #include "fmt/format.h"
 #include "../include/storage/table/tuple.h"
@@ -48,6 +49,30 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** Numeric columns are compared in place, other types through Value as Evaluate does. */
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->Reset(TypeId::BOOLEAN);
+    result->Resize(batch.GetRowCount());
+    if (lhs.IsIntegral() && rhs.IsIntegral() &&
+        (lhs.GetType() == rhs.GetType() || (lhs.IsNumeric() && rhs.IsNumeric()))) {
+      CompareBatch(batch, lhs, rhs, result,
+                   [](const ColumnVector &column, uint32_t row) { return column.GetInteger(row); });
+    } else if (lhs.IsNumeric() && rhs.IsNumeric()) {
+      CompareBatch(batch, lhs, rhs, result,
+                   [](const ColumnVector &column, uint32_t row) { return column.GetNumber(row); });
+    } else {
+      for (uint32_t i = 0; i < batch.Size(); i++) {
+        auto row = batch.RowAt(i);
+        result->Set(row,
+                    ValueFactory::GetBooleanValue(PerformComparison(lhs.GetValueView(row), rhs.GetValueView(row))));
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), comp_type_, *GetChildAt(1));
@@ -76,6 +101,39 @@ class ComparisonExpression : public AbstractExpression {
         BUSTUB_ASSERT(false, "Unsupported comparison type.");
     }
   }
+
+  template <typename T>
+  auto PerformComparison(T lhs, T rhs) const -> bool {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return lhs == rhs;
+      case ComparisonType::NotEqual:
+        return lhs != rhs;
+      case ComparisonType::LessThan:
+        return lhs < rhs;
+      case ComparisonType::LessThanOrEqual:
+        return lhs <= rhs;
+      case ComparisonType::GreaterThan:
+        return lhs > rhs;
+      case ComparisonType::GreaterThanOrEqual:
+        return lhs >= rhs;
+      default:
+        UNREACHABLE("Unsupported comparison type.");
+    }
+  }
+
+  template <typename Get>
+  void CompareBatch(const TupleBatch &batch, const ColumnVector &lhs, const ColumnVector &rhs, ColumnVector *result,
+                    Get get) const {
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      if (lhs.IsNull(row) || rhs.IsNull(row)) {
+        result->SetNull(row);
+      } else {
+        result->SetInteger(row, PerformComparison(get(lhs, row), get(rhs, row)) ? 1 : 0);
+      }
+    }
+  }
 };
 }  // namespace hmssql
 
@@ -33,6 +33,14 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    result->Reset(val_.GetTypeId());
+    result->Resize(batch.GetRowCount());
+    for (uint32_t row = 0; row < batch.GetRowCount(); row++) {
+      result->Set(row, val_);
+    }
+  }
+
   /** @return the string representation of the plan node and its children */
   auto ToString() const -> std::string override { return val_.ToString(); }
 
@@ -11,14 +11,20 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
+#include <utility>
+
+#include "../include/common/util/like_matcher.h"
 #include "../include/execution/expressions/abstract_expression.h"
+#include "../include/execution/expressions/constant_value_expression.h"
 #include "../include/type/value.h"
 
 namespace hmssql {
 
 /**
- * LikeExpression represents a SQL LIKE expression.
+ * LikeExpression represents a SQL LIKE expression. A constant pattern, the usual case, is compiled into a LikeMatcher
+ * once when the expression is built, and every row is only matched against it.
  */
 class LikeExpression : public AbstractExpression {
  public:
@@ -28,33 +34,55 @@ class LikeExpression : public AbstractExpression {
    * @param right The right-hand side of the LIKE expression
    */
   LikeExpression(AbstractExpressionRef left, AbstractExpressionRef right)
-      : AbstractExpression({std::move(left), std::move(right)}, TypeId::BOOLEAN) {}
+      : AbstractExpression({std::move(left), std::move(right)}, TypeId::BOOLEAN) {
+    const auto *constant = dynamic_cast<const ConstantValueExpression *>(children_[1].get());
+    if (constant != nullptr && !constant->val_.IsNull()) {
+      auto pattern = constant->val_.GetTypeId() == TypeId::VARCHAR ? constant->val_ : AsVarchar(constant->val_);
+      matcher_ = std::make_shared<const LikeMatcher>(std::string(pattern.GetData(), pattern.GetLength() - 1));
+    }
+  }
 
   auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override {
     auto left_val = children_[0]->Evaluate(tuple, schema);
-    auto right_val = children_[1]->Evaluate(tuple, schema);
-    if (left_val.GetTypeId() != TypeId::VARCHAR) {
-      left_val = Value(TypeId::VARCHAR, left_val.ToString());
-    }
-    if (right_val.GetTypeId() != TypeId::VARCHAR) {
-      right_val = Value(TypeId::VARCHAR, right_val.ToString());
+    if (matcher_ != nullptr) {
+      return Value(TypeId::BOOLEAN, MatchCompiled(left_val));
     }
-    auto cmp_result = left_val.Like(right_val);
-    return Value(TypeId::BOOLEAN, cmp_result == CmpBool::CmpTrue);
+    auto right_val = children_[1]->Evaluate(tuple, schema);
+    return Value(TypeId::BOOLEAN, Match(left_val, right_val));
   }
 
   auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
                     const Schema &right_schema) const -> Value override {
     auto left_val = children_[0]->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    if (matcher_ != nullptr) {
+      return Value(TypeId::BOOLEAN, MatchCompiled(left_val));
+    }
     auto right_val = children_[1]->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
-    if (left_val.GetTypeId() != TypeId::VARCHAR) {
-      left_val = Value(TypeId::VARCHAR, left_val.ToString());
+    return Value(TypeId::BOOLEAN, Match(left_val, right_val));
+  }
+
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    children_[0]->EvaluateBatch(batch, &lhs);
+    if (matcher_ == nullptr) {
+      children_[1]->EvaluateBatch(batch, &rhs);
     }
-    if (right_val.GetTypeId() != TypeId::VARCHAR) {
-      right_val = Value(TypeId::VARCHAR, right_val.ToString());
+    result->Reset(TypeId::BOOLEAN);
+    result->Resize(batch.GetRowCount());
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      bool match;
+      if (matcher_ != nullptr && lhs.IsValues()) {
+        // Varchars are matched where the column keeps them
+        match = MatchCompiled(lhs.GetStoredValue(row));
+      } else if (matcher_ != nullptr) {
+        match = MatchCompiled(lhs.GetValue(row));
+      } else {
+        match = Match(lhs.GetValueView(row), rhs.GetValueView(row));
+      }
+      result->SetInteger(row, match ? 1 : 0);
     }
-    auto cmp_result = left_val.Like(right_val);
-    return Value(TypeId::BOOLEAN, cmp_result == CmpBool::CmpTrue);
   }
 
   auto CloneWithChildren(std::vector<AbstractExpressionRef> children) const
@@ -66,6 +94,31 @@ class LikeExpression : public AbstractExpression {
   auto ToString() const -> std::string override {
     return fmt::format("LIKE({}, {})", children_[0]->ToString(), children_[1]->ToString());
   }
+
+ private:
+  /** @return value as a VARCHAR */
+  static auto AsVarchar(const Value &value) -> Value { return Value(TypeId::VARCHAR, value.ToString()); }
+
+  /** @return true if left matches the compiled pattern, false for null */
+  auto MatchCompiled(const Value &left) const -> bool {
+    if (left.IsNull()) {
+      return false;
+    }
+    if (left.GetTypeId() != TypeId::VARCHAR) {
+      return MatchCompiled(AsVarchar(left));
+    }
+    return matcher_->Match(left.GetData(), left.GetLength() - 1);
+  }
+
+  /** @return true if left matches the pattern right, false if either is null */
+  static auto Match(const Value &left, const Value &right) -> bool {
+    auto left_val = left.GetTypeId() == TypeId::VARCHAR ? left : AsVarchar(left);
+    auto right_val = right.GetTypeId() == TypeId::VARCHAR ? right : AsVarchar(right);
+    return left_val.Like(right_val) == CmpBool::CmpTrue;
+  }
+
+  /** The pattern compiled when it is a constant, nullptr otherwise */
+  std::shared_ptr<const LikeMatcher> matcher_;
 };
 
 }  // namespace hmssql
\ No newline at end of file
@@ -56,6 +56,29 @@ class LogicExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComputation(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, ColumnVector *result) const override {
+    ColumnVector lhs;
+    ColumnVector rhs;
+    GetChildAt(0)->EvaluateBatch(batch, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, &rhs);
+    result->Reset(TypeId::BOOLEAN);
+    result->Resize(batch.GetRowCount());
+    bool booleans = lhs.IsIntegral() && rhs.IsIntegral();
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      if (!booleans) {
+        result->Set(row, ValueFactory::GetBooleanValue(PerformComputation(lhs.GetValue(row), rhs.GetValue(row))));
+        continue;
+      }
+      auto res = PerformComputation(GetBoolAsCmpBool(lhs, row), GetBoolAsCmpBool(rhs, row));
+      if (res == CmpBool::CmpNull) {
+        result->SetNull(row);
+      } else {
+        result->SetInteger(row, res == CmpBool::CmpTrue ? 1 : 0);
+      }
+    }
+  }
+
   /** @return the string representation of the expression node and its children */
   auto ToString() const -> std::string override {
     return fmt::format("({}{}{})", *GetChildAt(0), logic_type_, *GetChildAt(1));
@@ -76,9 +99,18 @@ class LogicExpression : public AbstractExpression {
     return CmpBool::CmpFalse;
   }
 
+  auto GetBoolAsCmpBool(const ColumnVector &column, uint32_t row) const -> CmpBool {
+    if (column.IsNull(row)) {
+      return CmpBool::CmpNull;
+    }
+    return column.GetInteger(row) != 0 ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
   auto PerformComputation(const Value &lhs, const Value &rhs) const -> CmpBool {
-    auto l = GetBoolAsCmpBool(lhs);
-    auto r = GetBoolAsCmpBool(rhs);
+    return PerformComputation(GetBoolAsCmpBool(lhs), GetBoolAsCmpBool(rhs));
+  }
+
+  auto PerformComputation(CmpBool l, CmpBool r) const -> CmpBool {
     switch (logic_type_) {
       case LogicType::And:
         if (l == CmpBool::CmpFalse || r == CmpBool::CmpFalse) {
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// loser_tree.h
+//
+// Identification: src/include/execution/loser_tree.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace hmssql {
+
+/**
+ * LoserTree merges k sorted inputs: a leaf per input and, at every inner node, the input that lost the match played
+ * there. The winner of the whole tree has the element that comes first. Once it moved on to its next element only the
+ * matches on the path from its leaf are played again, one comparison per level.
+ *
+ * The inputs are numbered from 0 to k - 1, beats(a, b) tells if the current element of input a comes before that of
+ * input b. An exhausted input has to lose to every other one.
+ */
+class LoserTree {
+ public:
+  /** Play every match of count inputs, count > 0. */
+  template <typename Beats>
+  void Init(size_t count, Beats beats) {
+    tree_.assign(count, 0);
+    tree_[0] = Play(1, beats);
+  }
+
+  /** @return the input whose element comes first */
+  auto Winner() const -> size_t { return tree_[0]; }
+
+  /** Play the matches of the winner again, after it moved on to its next element. */
+  template <typename Beats>
+  void Replay(Beats beats) {
+    auto winner = tree_[0];
+    for (auto node = (winner + tree_.size()) / 2; node > 0; node /= 2) {
+      if (beats(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  /** Play the matches below node. @return the winner of node */
+  template <typename Beats>
+  auto Play(size_t node, Beats &beats) -> size_t {
+    auto count = tree_.size();
+    if (node >= count) {
+      return node - count;
+    }
+    auto left = Play(2 * node, beats);
+    auto right = Play(2 * node + 1, beats);
+    bool left_wins = beats(left, right);
+    tree_[node] = left_wins ? right : left;
+    return left_wins ? left : right;
+  }
+
+  /** tree_[0] is the winner, tree_[1..k) the loser of each inner node, the leaf of input i is k + i */
+  std::vector<size_t> tree_;
+};
+
+}  // namespace hmssql
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// parallel_state.h
+//
+// Identification: src/include/execution/parallel_state.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "../include/common/macros.h"
+
+namespace hmssql {
+
+class AbstractPlanNode;
+
+/**
+ * ParallelState holds what the workers of one parallel pipeline share, such as the morsel dispenser of a scan that
+ * the workers split between them. Each worker runs its own executors for the plan nodes of the pipeline, the state
+ * of a plan node is created by the first of them to ask for it. The states are destroyed with the ParallelState,
+ * after the workers are done.
+ */
+class ParallelState {
+ public:
+  ParallelState() = default;
+
+  DISALLOW_COPY_AND_MOVE(ParallelState);
+
+  /**
+   * @param plan the plan node the state belongs to
+   * @param make called to create the state if no worker did yet, returns a std::unique_ptr<T>
+   * @return the state of plan
+   */
+  template <typename T, typename Make>
+  auto GetOrCreate(const AbstractPlanNode *plan, Make make) -> T * {
+    std::scoped_lock<std::mutex> lock(latch_);
+    auto &state = states_[plan];
+    if (state == nullptr) {
+      state = std::shared_ptr<T>(make());
+    }
+    return static_cast<T *>(state.get());
+  }
+
+ private:
+  std::mutex latch_;
+  std::unordered_map<const AbstractPlanNode *, std::shared_ptr<void>> states_;
+};
+
+}  // namespace hmssql
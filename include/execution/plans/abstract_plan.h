@@ -41,6 +41,7 @@ enum class PlanType {
   NestedLoopJoin,
   NestedIndexJoin,
   HashJoin,
+  MergeJoin,
   Filter,
   Values,
   Projection,
@@ -49,6 +50,8 @@ enum class PlanType {
   MockScan,
   CreateView,
   CreateTempTable,
+  Gather,
+  Repartition,
 };
 
 class AbstractPlanNode;
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// gather_plan.h
+//
+// Identification: src/include/execution/plans/gather_plan.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "../include/execution/plans/abstract_plan.h"
+#include "fmt/format.h"
+
+namespace hmssql {
+
+/**
+ * Gather runs its child plan as a parallel pipeline: each of workers threads executes its own copy of the child,
+ * and Gather passes on the tuples of all of them. Scans in the pipeline split the table between the workers, so
+ * together they produce the child's tuples once, in no particular order.
+ */
+class GatherPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new GatherPlanNode instance.
+   * @param output The output schema, the one of child
+   * @param child The pipeline run by every worker
+   * @param workers The number of workers
+   */
+  GatherPlanNode(SchemaRef output, AbstractPlanNodeRef child, size_t workers)
+      : AbstractPlanNode(std::move(output), {std::move(child)}), workers_{workers} {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::Gather; }
+
+  /** @return The number of workers */
+  auto GetWorkers() const -> size_t { return workers_; }
+
+  /** @return The child plan node */
+  auto GetChildPlan() const -> AbstractPlanNodeRef {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Gather should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(GatherPlanNode);
+
+  /** The number of workers */
+  size_t workers_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override { return fmt::format("Gather {{ workers={} }}", workers_); }
+};
+
+}  // namespace hmssql
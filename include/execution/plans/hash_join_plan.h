@@ -22,7 +22,12 @@
 namespace hmssql {
 
 /**
- * Hash join performs a JOIN operation with a hash table.
+ * Hash join performs a JOIN operation with a hash table. Tuples join when every left key equals the right key at
+ * the same position.
+ *
+ * A radix-partitioned hash join runs in the workers of a parallel pipeline. Its children are pipelines of their own,
+ * every worker partitions its share of both sides by the hash of the keys, and the workers then build and probe the
+ * partitions one pair at a time.
  */
 class HashJoinPlanNode : public AbstractPlanNode {
  public:
@@ -30,25 +35,33 @@ class HashJoinPlanNode : public AbstractPlanNode {
    * Construct a new HashJoinPlanNode instance.
    * @param output_schema The output schema for the JOIN
    * @param children The child plans from which tuples are obtained
-   * @param left_key_expression The expression for the left JOIN key
-   * @param right_key_expression The expression for the right JOIN key
+   * @param left_key_expressions The expressions for the left JOIN keys
+   * @param right_key_expressions The expressions for the right JOIN keys, as many as left ones
+   * @param radix_workers The number of workers of a radix-partitioned join, 0 for a join of its own
    */
   HashJoinPlanNode(SchemaRef output_schema, AbstractPlanNodeRef left, AbstractPlanNodeRef right,
-                   AbstractExpressionRef left_key_expression, AbstractExpressionRef right_key_expression,
-                   JoinType join_type)
+                   std::vector<AbstractExpressionRef> left_key_expressions,
+                   std::vector<AbstractExpressionRef> right_key_expressions, JoinType join_type,
+                   size_t radix_workers = 0)
       : AbstractPlanNode(std::move(output_schema), {std::move(left), std::move(right)}),
-        left_key_expression_{std::move(left_key_expression)},
-        right_key_expression_{std::move(right_key_expression)},
-        join_type_(join_type) {}
+        left_key_expressions_{std::move(left_key_expressions)},
+        right_key_expressions_{std::move(right_key_expressions)},
+        join_type_(join_type),
+        radix_workers_(radix_workers) {
+    BUSTUB_ASSERT(!left_key_expressions_.empty() && left_key_expressions_.size() == right_key_expressions_.size(),
+                  "Hash joins need the same number of left and right keys.");
+  }
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::HashJoin; }
 
-  /** @return The expression to compute the left join key */
-  auto LeftJoinKeyExpression() const -> const AbstractExpression & { return *left_key_expression_; }
+  /** @return The expressions to compute the left join keys */
+  auto LeftJoinKeyExpressions() const -> const std::vector<AbstractExpressionRef> & { return left_key_expressions_; }
 
-  /** @return The expression to compute the right join key */
-  auto RightJoinKeyExpression() const -> const AbstractExpression & { return *right_key_expression_; }
+  /** @return The expressions to compute the right join keys */
+  auto RightJoinKeyExpressions() const -> const std::vector<AbstractExpressionRef> & {
+    return right_key_expressions_;
+  }
 
   /** @return The left plan node of the hash join */
   auto GetLeftPlan() const -> AbstractPlanNodeRef {
@@ -65,21 +78,24 @@ class HashJoinPlanNode : public AbstractPlanNode {
   /** @return The join type used in the hash join */
   auto GetJoinType() const -> JoinType { return join_type_; };
 
+  /** @return The number of workers of a radix-partitioned join, 0 if the join is not radix-partitioned */
+  auto GetRadixWorkers() const -> size_t { return radix_workers_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(HashJoinPlanNode);
 
-  /** The expression to compute the left JOIN key */
-  AbstractExpressionRef left_key_expression_;
-  /** The expression to compute the right JOIN key */
-  AbstractExpressionRef right_key_expression_;
+  /** The expressions to compute the left JOIN keys */
+  std::vector<AbstractExpressionRef> left_key_expressions_;
+  /** The expressions to compute the right JOIN keys */
+  std::vector<AbstractExpressionRef> right_key_expressions_;
 
   /** The join type */
   JoinType join_type_;
 
+  /** The number of workers of a radix-partitioned join, 0 if the join is not radix-partitioned */
+  size_t radix_workers_;
+
  protected:
-  auto PlanNodeToString() const -> std::string override {
-    return fmt::format("HashJoin {{ type={}, left_key={}, right_key={} }}", join_type_, left_key_expression_,
-                       right_key_expression_);
-  }
+  auto PlanNodeToString() const -> std::string override;
 };
 
 }  // namespace hmssql
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// repartition_plan.h
+//
+// Identification: src/include/execution/plans/repartition_plan.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/execution/expressions/abstract_expression.h"
+#include "../include/execution/plans/abstract_plan.h"
+
+namespace hmssql {
+
+/**
+ * Repartition splits the tuples of its child by the hash of the partition keys, for the workers of a parallel
+ * pipeline: worker i of the pipeline above gets every tuple of partition i. Tuples with equal keys end up with the
+ * same worker, which lets the workers aggregate or join their partitions on their own. The child runs on producers
+ * threads of its own, each of them executing a copy of the child plan like the workers of a Gather.
+ */
+class RepartitionPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new RepartitionPlanNode instance.
+   * @param output The output schema, the one of child
+   * @param child The plan the producers run
+   * @param partition_keys The expressions the tuples are partitioned by, evaluated on the child's tuples
+   * @param partitions The number of partitions, one per worker of the pipeline above
+   * @param producers The number of producers, 1 if the child is not a pipeline the producers can split
+   */
+  RepartitionPlanNode(SchemaRef output, AbstractPlanNodeRef child, std::vector<AbstractExpressionRef> partition_keys,
+                      size_t partitions, size_t producers)
+      : AbstractPlanNode(std::move(output), {std::move(child)}),
+        partition_keys_{std::move(partition_keys)},
+        partitions_{partitions},
+        producers_{producers} {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::Repartition; }
+
+  /** @return The expressions the tuples are partitioned by */
+  auto GetPartitionKeys() const -> const std::vector<AbstractExpressionRef> & { return partition_keys_; }
+
+  /** @return The number of partitions */
+  auto GetPartitions() const -> size_t { return partitions_; }
+
+  /** @return The number of producers */
+  auto GetProducers() const -> size_t { return producers_; }
+
+  /** @return The child plan node */
+  auto GetChildPlan() const -> AbstractPlanNodeRef {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Repartition should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(RepartitionPlanNode);
+
+  /** The expressions the tuples are partitioned by */
+  std::vector<AbstractExpressionRef> partition_keys_;
+  /** The number of partitions */
+  size_t partitions_;
+  /** The number of producers */
+  size_t producers_;
+
+ protected:
+  auto PlanNodeToString() const -> std::string override;
+};
+
+}  // namespace hmssql
@@ -26,6 +26,8 @@ namespace hmssql {
 /**
  * The SortPlanNode represents a sort operation. It will sort the input with
  * the given predicate.
+ *
+ * A parallel sort has workers. Its child is then a parallel pipeline, a copy of which runs on every worker.
  */
 class SortPlanNode : public AbstractPlanNode {
  public:
@@ -34,10 +36,11 @@ class SortPlanNode : public AbstractPlanNode {
    * @param output The output schema of this sort plan node
    * @param child The child plan node
    * @param order_bys The sort expressions and their order by types.
+   * @param workers The number of workers of a parallel sort, 0 for a serial one
    */
   SortPlanNode(SchemaRef output, AbstractPlanNodeRef child,
-               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys)
-      : AbstractPlanNode(std::move(output), {std::move(child)}), order_bys_(std::move(order_bys)) {}
+               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys, size_t workers = 0)
+      : AbstractPlanNode(std::move(output), {std::move(child)}), order_bys_(std::move(order_bys)), workers_(workers) {}
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::Sort; }
@@ -51,10 +54,16 @@ class SortPlanNode : public AbstractPlanNode {
   /** @return Get sort by expressions */
   auto GetOrderBy() const -> const std::vector<std::pair<OrderByType, AbstractExpressionRef>> & { return order_bys_; }
 
+  /** @return The number of workers of a parallel sort, 0 if the sort is serial */
+  auto GetWorkers() const -> size_t { return workers_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(SortPlanNode);
 
   std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
 
+  /** The number of workers of a parallel sort, 0 if the sort is serial */
+  size_t workers_;
+
  protected:
   auto PlanNodeToString() const -> std::string override;
 };
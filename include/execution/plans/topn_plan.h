@@ -26,6 +26,8 @@ namespace hmssql {
 /**
  * The TopNPlanNode represents a top-n operation. It will gather the n extreme rows based on
  * limit and order expressions.
+ *
+ * A parallel topn has workers. Its child is then a parallel pipeline, a copy of which runs on every worker.
  */
 class TopNPlanNode : public AbstractPlanNode {
  public:
@@ -35,10 +37,15 @@ class TopNPlanNode : public AbstractPlanNode {
    * @param child The child plan node
    * @param order_bys The sort expressions and their order by types.
    * @param n Retain n elements.
+   * @param workers The number of workers of a parallel topn, 0 for a serial one
    */
   TopNPlanNode(SchemaRef output, AbstractPlanNodeRef child,
-               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys, std::size_t n)
-      : AbstractPlanNode(std::move(output), {std::move(child)}), order_bys_(std::move(order_bys)), n_{n} {}
+               std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys, std::size_t n,
+               size_t workers = 0)
+      : AbstractPlanNode(std::move(output), {std::move(child)}),
+        order_bys_(std::move(order_bys)),
+        n_{n},
+        workers_(workers) {}
 
   /** @return The type of the plan node */
   auto GetType() const -> PlanType override { return PlanType::TopN; }
@@ -49,6 +56,9 @@ class TopNPlanNode : public AbstractPlanNode {
   /** @return Get order by expressions */
   auto GetOrderBy() const -> const std::vector<std::pair<OrderByType, AbstractExpressionRef>> & { return order_bys_; }
 
+  /** @return The number of workers of a parallel topn, 0 if the topn is serial */
+  auto GetWorkers() const -> size_t { return workers_; }
+
   /** @return The child plan node */
   auto GetChildPlan() const -> AbstractPlanNodeRef {
     BUSTUB_ASSERT(GetChildren().size() == 1, "TopN should have exactly one child plan.");
@@ -60,6 +70,9 @@ class TopNPlanNode : public AbstractPlanNode {
   std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys_;
   std::size_t n_;
 
+  /** The number of workers of a parallel topn, 0 if the topn is serial */
+  size_t workers_;
+
  protected:
   auto PlanNodeToString() const -> std::string override;
 };
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// runtime_filter.h
+//
+// Identification: src/include/execution/runtime_filter.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../include/catalog/schema.h"
+#include "../include/common/config.h"
+#include "../include/common/util/hash_util.h"
+#include "../include/storage/table/tuple.h"
+
+namespace hmssql {
+
+/**
+ * BlockedBloomFilter is a bloom filter whose bits of a key all lie in one block of eight 32-bit words, so a lookup
+ * reads a single cache line. The high half of the key hash picks the block, the low half one bit of every word of it,
+ * multiplied by a different odd constant per word.
+ */
+class BlockedBloomFilter {
+ public:
+  /** Size the filter for keys distinct keys, at about RUNTIME_FILTER_BITS_PER_KEY bits each. */
+  explicit BlockedBloomFilter(size_t keys);
+
+  /** Add a key by its hash. */
+  void Insert(hash_t hash);
+
+  /** @return false if no key of this hash was inserted, true if one may have been */
+  auto MayContain(hash_t hash) const -> bool;
+
+ private:
+  using Block = std::array<uint32_t, 8>;
+
+  /** @return the bits of hash within its block */
+  static auto MaskOf(hash_t hash) -> Block;
+
+  /** @return the block of hash */
+  auto BlockOf(hash_t hash) const -> size_t { return (hash >> 32) & (blocks_.size() - 1); }
+
+  std::vector<Block> blocks_;
+};
+
+/**
+ * RuntimeFilter is what a hash join pushes into the scan of its probe side once the build side is read: a
+ * BlockedBloomFilter of the build keys, hashed as the JoinHashTable hashes them, and the columns of the scanned
+ * tuples the probe keys are. A tuple whose key is null or not in the filter joins no build row, so the scan drops it
+ * before copying it out of its page.
+ *
+ * A filter that passes nearly every row costs more than it saves, so after RUNTIME_FILTER_SAMPLE_ROWS rows one that
+ * dropped fewer than an eighth of them switches itself off.
+ */
+class RuntimeFilter {
+ public:
+  /**
+   * @param key_columns the columns of the scanned tuples that make up the probe key, in the order of the build key
+   * @param bloom the filter of the build keys
+   */
+  RuntimeFilter(std::vector<uint32_t> key_columns, BlockedBloomFilter bloom);
+
+  /** @return false if tuple, laid out by schema, joins no build row for sure */
+  auto MayMatch(const Tuple &tuple, const Schema *schema) -> bool;
+
+ private:
+  std::vector<uint32_t> key_columns_;
+  BlockedBloomFilter bloom_;
+  /** The key of the tuple being checked */
+  std::vector<Value> key_;
+  /** The rows checked and passed so far, while the filter is sampled */
+  size_t checked_{0};
+  size_t passed_{0};
+  bool enabled_{true};
+};
+
+}  // namespace hmssql
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../include/binder/bound_order_by.h"
+#include "../include/catalog/schema.h"
+#include "../include/execution/expressions/abstract_expression.h"
+#include "../include/storage/table/tuple.h"
+
+namespace hmssql {
+
+/**
+ * SortKeyEncoder turns the ORDER BY values of a tuple into a normalized key of fixed size, so that memcmp of two keys
+ * orders the tuples like the ORDER BY does and sorting evaluates every expression once per tuple, not per comparison.
+ *
+ * Every expression takes a null byte and its value: numbers big-endian in the size of their type, with the sign
+ * flipped, varchars as their first SORT_KEY_VARCHAR_PREFIX bytes. DESC inverts the bytes of its expression. Nulls
+ * come first in ascending order and last in descending order.
+ *
+ * A varchar cut to its prefix leaves the rest of the key unusable: keys that agree up to the end of such a prefix do
+ * not tell the order of their tuples, the values themselves do.
+ */
+class SortKeyEncoder {
+ public:
+  using OrderBy = std::pair<OrderByType, AbstractExpressionRef>;
+
+  /**
+   * @param order_bys what to sort by
+   * @param schema the layout of the tuples sorted, it has to outlive the encoder
+   */
+  SortKeyEncoder(const std::vector<OrderBy> &order_bys, const Schema *schema);
+
+  /** @return the size of a key in bytes */
+  auto KeySize() const -> size_t { return key_size_; }
+
+  /**
+   * Write the key of tuple, KeySize() bytes.
+   * @return the size of the exact part of the key, KeySize() unless a varchar was cut to its prefix
+   */
+  auto Encode(const Tuple &tuple, char *key) const -> size_t;
+
+  /**
+   * Compare two tuples by their keys, and by their values where the keys cannot tell.
+   * @return <0, 0 or >0 as tuple_a sorts before, with or after tuple_b
+   */
+  auto Compare(const Tuple &tuple_a, const char *key_a, size_t exact_a, const Tuple &tuple_b, const char *key_b,
+               size_t exact_b) const -> int;
+
+  /** @return <0, 0 or >0 as tuple_a sorts before, with or after tuple_b, comparing the ORDER BY values themselves */
+  auto Compare(const Tuple &tuple_a, const Tuple &tuple_b) const -> int;
+
+  /** @return the first 8 bytes of key as an integer that orders like them */
+  auto Prefix(const char *key) const -> uint64_t;
+
+  /**
+   * Sort tuples by their keys.
+   * @param[out] keys the key of every tuple, KeySize() bytes each, in the order of tuples
+   * @param[out] exact the size of the exact part of every key
+   * @return the positions in tuples of the tuples in sorted order
+   */
+  auto Sort(const std::vector<Tuple> &tuples, std::vector<char> *keys, std::vector<size_t> *exact) const
+      -> std::vector<uint32_t>;
+
+ private:
+  struct KeyColumn {
+    OrderByType order_type_;
+    AbstractExpressionRef expr_;
+    /** The type the value is encoded as, the return type of the expression */
+    TypeId type_;
+    /** The offset of the null byte in the key, the value follows it */
+    size_t offset_;
+  };
+
+  std::vector<KeyColumn> columns_;
+  const Schema *schema_;
+  size_t key_size_{0};
+};
+
+}  // namespace hmssql
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// thread_pool.h
+//
+// Identification: src/include/execution/thread_pool.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "../include/common/macros.h"
+
+namespace hmssql {
+
+/**
+ * ThreadPool runs the workers of parallel query pipelines. Threads are kept around after their task and reused by
+ * the next one, so a query does not pay for starting threads. A task that finds no idle thread gets a new one: the
+ * tasks of an exchange wait for each other, and queueing one behind another could deadlock the query.
+ */
+class ThreadPool {
+ public:
+  ThreadPool() = default;
+
+  /** Waits for the running tasks and stops every thread. */
+  ~ThreadPool();
+
+  DISALLOW_COPY_AND_MOVE(ThreadPool);
+
+  /**
+   * Run a task on a pool thread.
+   * @param task the task, it should not throw
+   * @return a future that is ready when the task returned
+   */
+  auto Submit(std::function<void()> task) -> std::future<void>;
+
+  /**
+   * Run task(i) for every i below count on pool threads and wait for all of them.
+   * @throws the exception one of the tasks threw, once they are all done
+   */
+  void RunAll(size_t count, const std::function<void(size_t)> &task);
+
+  /** @return the number of threads in the pool */
+  auto Size() -> size_t;
+
+ private:
+  /** The loop of a pool thread: run queued tasks until the pool shuts down */
+  void WorkerLoop();
+
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<std::packaged_task<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  /** Threads waiting for a task */
+  size_t idle_{0};
+  bool shutdown_{false};
+};
+
+}  // namespace hmssql
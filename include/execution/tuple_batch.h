@@ -0,0 +1,211 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../include/catalog/schema.h"
+#include "../include/common/config.h"
+#include "../include/common/rid.h"
+#include "../include/storage/table/tuple.h"
+#include "../include/type/arena_pool.h"
+#include "../include/type/value.h"
+
+namespace hmssql {
+
+class AbstractExpression;
+
+/**
+ * ColumnVector holds the values of one column for the rows of a batch. BOOLEAN, the integer types and TIMESTAMP are
+ * kept in an int64_t array, DECIMAL in a double array, so expressions can loop over them without building a Value
+ * per row. VARCHAR is kept as Values whose bytes the column copies into an arena of its own, released in bulk when
+ * the column is reset. Nulls are tracked in a bitmap, the array slot of a null row is unspecified.
+ */
+class ColumnVector {
+ public:
+  ColumnVector() = default;
+
+  explicit ColumnVector(TypeId type) { Reset(type); }
+
+  /** A copy has its VARCHARs in its own arena */
+  ColumnVector(const ColumnVector &other) { *this = other; }
+  auto operator=(const ColumnVector &other) -> ColumnVector &;
+  ColumnVector(ColumnVector &&other) noexcept = default;
+  auto operator=(ColumnVector &&other) noexcept -> ColumnVector & = default;
+  ~ColumnVector() = default;
+
+  /** Drop every row and hold values of type from here on. The arrays and the arena keep their capacity. */
+  void Reset(TypeId type);
+
+  /** Grow the column to size rows, the new rows are not null. */
+  void Resize(uint32_t size);
+
+  auto GetType() const -> TypeId { return type_; }
+
+  auto Size() const -> uint32_t { return size_; }
+
+  /** @return true if the rows are kept as int64_t */
+  auto IsIntegral() const -> bool { return storage_ == Storage::INTEGRAL; }
+
+  /** @return true if the rows are kept as double */
+  auto IsDecimal() const -> bool { return storage_ == Storage::DECIMAL; }
+
+  /** @return true if the rows are kept as int64_t or double and compare as numbers, not BOOLEAN or TIMESTAMP */
+  auto IsNumeric() const -> bool {
+    return storage_ != Storage::VALUE && type_ != TypeId::BOOLEAN && type_ != TypeId::TIMESTAMP;
+  }
+
+  auto IsNull(uint32_t row) const -> bool { return ((nulls_[row / 64] >> (row % 64)) & 1) != 0; }
+
+  /** Only for integral columns and rows that are not null. */
+  auto GetInteger(uint32_t row) const -> int64_t { return integers_[row]; }
+
+  /** Only for decimal columns and rows that are not null. */
+  auto GetDecimal(uint32_t row) const -> double { return decimals_[row]; }
+
+  /** @return the value of a row as a number, for integral or decimal columns */
+  auto GetNumber(uint32_t row) const -> double {
+    return storage_ == Storage::DECIMAL ? decimals_[row] : static_cast<double>(integers_[row]);
+  }
+
+  /** @return the value of a row, a VARCHAR with bytes of its own */
+  auto GetValue(uint32_t row) const -> Value;
+
+  /** @return the value of a row, a VARCHAR pointing into the column, so only good until it is reset */
+  auto GetValueView(uint32_t row) const -> Value { return storage_ == Storage::VALUE ? values_[row] : GetValue(row); }
+
+  /** @return true if the rows are kept as Values, as for VARCHAR columns */
+  auto IsValues() const -> bool { return storage_ == Storage::VALUE; }
+
+  /** Only for columns kept as Values. @return the value of a row, without copying it */
+  auto GetStoredValue(uint32_t row) const -> const Value & { return values_[row]; }
+
+  void SetNull(uint32_t row) { nulls_[row / 64] |= uint64_t{1} << (row % 64); }
+
+  void SetInteger(uint32_t row, int64_t value) {
+    integers_[row] = value;
+    nulls_[row / 64] &= ~(uint64_t{1} << (row % 64));
+  }
+
+  void SetDecimal(uint32_t row, double value) {
+    decimals_[row] = value;
+    nulls_[row / 64] &= ~(uint64_t{1} << (row % 64));
+  }
+
+  /**
+   * Set a row from a Value. A value whose type is not the column's turns the column into one of Values, so
+   * GetValue hands back what was set.
+   */
+  void Set(uint32_t row, const Value &value);
+
+  /** Set a row of a VARCHAR column to the len bytes at data. */
+  void SetVarchar(uint32_t row, const char *data, uint32_t len);
+
+  void Append(const Value &value) {
+    Resize(size_ + 1);
+    Set(size_ - 1, value);
+  }
+
+  /** Append a row of another column, without going through a Value when both keep their rows alike. */
+  void AppendFrom(const ColumnVector &source, uint32_t row);
+
+ private:
+  enum class Storage { INTEGRAL, DECIMAL, VALUE };
+
+  static auto StorageOf(TypeId type) -> Storage;
+
+  /** @return the value of an integral non-null Value as int64_t */
+  static auto IntegerOf(const Value &value) -> int64_t;
+
+  /** Move every row into values_, after a row of another type than the column's was set. */
+  void ConvertToValues();
+
+  TypeId type_{TypeId::INVALID};
+  Storage storage_{Storage::VALUE};
+  uint32_t size_{0};
+  std::vector<int64_t> integers_;
+  std::vector<double> decimals_;
+  std::vector<Value> values_;
+  /** The bytes of the VARCHARs in values_ */
+  ArenaPool varlen_arena_;
+  /** One bit per row, set for nulls. */
+  std::vector<uint64_t> nulls_;
+};
+
+/**
+ * TupleBatch is a columnar chunk of up to TUPLE_BATCH_SIZE rows passed between executors by NextBatch. Executors
+ * that filter rows leave the columns alone and narrow the selection vector instead, which lists the rows still in
+ * the batch. Executors iterate the selected rows with Size() and RowAt().
+ */
+class TupleBatch {
+ public:
+  TupleBatch() = default;
+
+  /** Empty the batch and lay out one column per column of schema. */
+  void Reset(const Schema *schema);
+
+  auto GetSchema() const -> const Schema * { return schema_; }
+
+  auto GetColumn(uint32_t col_idx) -> ColumnVector & { return columns_[col_idx]; }
+  auto GetColumn(uint32_t col_idx) const -> const ColumnVector & { return columns_[col_idx]; }
+
+  /** @return the number of rows in the columns, selected or not */
+  auto GetRowCount() const -> uint32_t { return row_count_; }
+
+  auto IsFull() const -> bool { return row_count_ >= TUPLE_BATCH_SIZE; }
+
+  /** @return the number of selected rows */
+  auto Size() const -> uint32_t { return has_selection_ ? static_cast<uint32_t>(selection_.size()) : row_count_; }
+
+  /** @return the row index of the i-th selected row */
+  auto RowAt(uint32_t i) const -> uint32_t { return has_selection_ ? selection_[i] : i; }
+
+  auto GetRid(uint32_t row) const -> RID { return rids_[row]; }
+
+  /** Append a tuple laid out by the batch schema. Inlined numeric columns are read off the tuple data directly. */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  /** Append a row of values, one per column. */
+  void AppendValues(const std::vector<Value> &values, const RID &rid = RID{});
+
+  /** Append a row of another batch with the same layout, column by column. */
+  void AppendRow(const TupleBatch &source, uint32_t row);
+
+  auto GetValue(uint32_t col_idx, uint32_t row) const -> Value { return columns_[col_idx].GetValue(row); }
+
+  /** @return the value of a row, a VARCHAR pointing into the batch, so only good until it is reset */
+  auto GetValueView(uint32_t col_idx, uint32_t row) const -> Value { return columns_[col_idx].GetValueView(row); }
+
+  /** @return the row as a tuple of the batch schema, for code that still works row at a time */
+  auto GetTuple(uint32_t row) const -> Tuple;
+
+  /**
+   * Take the row count, RIDs and selection of input. For batches whose columns were evaluated on input, the
+   * columns of both are indexed by the same rows.
+   */
+  void InheritRows(const TupleBatch &input);
+
+  /** Drop the selected rows the predicate is not true for, nulls included. */
+  void ApplyFilter(const AbstractExpression &predicate);
+
+ private:
+  const Schema *schema_{nullptr};
+  std::vector<ColumnVector> columns_;
+  std::vector<RID> rids_;
+  uint32_t row_count_{0};
+  /** Without a selection every row is selected. */
+  bool has_selection_{false};
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace hmssql
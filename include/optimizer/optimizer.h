@@ -20,8 +20,15 @@ namespace hmssql {
  */
 class Optimizer {
  public:
-  explicit Optimizer(const Catalog &catalog, bool force_starter_rule)
-      : catalog_(catalog), force_starter_rule_(force_starter_rule) {}
+  /**
+   * @param max_parallel_workers the number of threads a scan may use, 0 or 1 for serial plans
+   */
+  explicit Optimizer(const Catalog &catalog, bool force_starter_rule, size_t max_parallel_workers = 0,
+                     size_t work_mem = DEFAULT_WORK_MEM)
+      : catalog_(catalog),
+        force_starter_rule_(force_starter_rule),
+        max_parallel_workers_(max_parallel_workers),
+        work_mem_(work_mem) {}
 
   auto Optimize(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
@@ -44,11 +51,24 @@ class Optimizer {
 
   /**
    * @brief optimize nested loop join into hash join.
-   * In the starter code, we will check NLJs with exactly one equal condition. You can further support optimizing joins
-   * with multiple eq conditions.
+   * NLJs whose predicate is one equal condition between a column of each table, or a conjunction of such conditions,
+   * become hash joins on all of the columns.
    */
   auto OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief optimize hash join into merge join.
+   * Inner and left hash joins whose inputs both come out sorted ascending by their join keys become merge joins,
+   * which need neither a hash table nor to hash the keys.
+   */
+  auto OptimizeHashJoinAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @return true if plan produces its tuples sorted ascending by keys, going by the sorts, index scans and merge
+   * joins in it. Every key must be a column of the output of plan.
+   */
+  auto IsSortedBy(const AbstractPlanNodeRef &plan, const std::vector<AbstractExpressionRef> &keys) -> bool;
+
   /**
    * @brief optimize nested loop join into index join.
    */
@@ -107,6 +127,43 @@ class Optimizer {
 
   auto OptimizeMergeFilterIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief run the plan in parallel pipelines of max_parallel_workers_ workers. Scans of tables that are not known to
+   * be small are split between the workers, filters and projections run on the workers' parts, aggregations with
+   * group bys and hash joins get their input repartitioned by key, hash joins of two large inputs radix-partition
+   * them in the workers instead, if both fit in work_mem together. A Gather collects a pipeline's output where an operator needs all of it. Writers and
+   * the inner side of nested loop joins stay serial.
+   */
+  auto OptimizeParallelPlan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief the recursion of OptimizeParallelPlan.
+   * @param[out] partial set if the returned plan is a pipeline each worker runs a copy of, producing its share of
+   * the output. It needs a Gather or Repartition above.
+   */
+  auto ParallelizePlan(const AbstractPlanNodeRef &plan, bool *partial) -> AbstractPlanNodeRef;
+
+  /**
+   * @return true if plan is known to produce at least RADIX_JOIN_MIN_ROWS tuples, going by the estimated cardinality
+   * of the table it scans. Filters count as keeping every tuple.
+   */
+  auto IsEstimatedLarge(const AbstractPlanNodeRef &plan) -> bool;
+
+  /**
+   * @return the number of tuples plan produces at most, going by the estimated cardinality of the table it scans,
+   * std::nullopt if it is not known. Filters count as keeping every tuple.
+   */
+  auto EstimatedRows(const AbstractPlanNodeRef &plan) -> std::optional<size_t>;
+
+  /**
+   * @return the bytes the tuples of plan take at most when an operator holds them in memory, every VARCHAR at its
+   * full length, std::nullopt if the number of tuples is not known
+   */
+  auto EstimatedMemoryUsage(const AbstractPlanNodeRef &plan) -> std::optional<size_t>;
+
+  /** @return plan under a Gather if it is partial */
+  auto GatherIfPartial(const AbstractPlanNodeRef &plan, bool partial) -> AbstractPlanNodeRef;
+
   /**
    * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. HMSSQL
    * doesn't support statistics for now, so it's the only way for you to get the table size :(
@@ -122,6 +179,11 @@ class Optimizer {
   const Catalog &catalog_;
 
   const bool force_starter_rule_;
+
+  const size_t max_parallel_workers_;
+
+  /** The memory budget of each operator of the plan, see ExecutorContext::GetWorkMem */
+  const size_t work_mem_;
 };
 
 }  // namespace hmssql
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// backup_manager.h
+//
+// Identification: src/include/recovery/backup_manager.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "../buffer/buffer_pool_manager.h"
+#include "../recovery/log_manager.h"
+
+namespace hmssql {
+
+class TransactionManager;
+
+/** Describes a backup, stored next to it as backup_manifest. */
+struct BackupManifest {
+  /** The archived WAL covers the log offsets [start_offset_, end_offset_). */
+  uint64_t start_offset_{0};
+  uint64_t end_offset_{0};
+  /** After replaying the archived WAL the database is consistent as of this LSN. */
+  lsn_t end_lsn_{INVALID_LSN};
+  /** Number of pages copied from the database file. */
+  int page_count_{0};
+};
+
+/**
+ * BackupManager takes online physical backups. The database file is streamed straight from the disk manager, so the
+ * copy neither pins frames nor touches the buffer pool replacer, while a second thread archives the WAL written in
+ * the meantime. The page copy is fuzzy; replaying the archived WAL over it (see Restore) brings every page to the
+ * LSN at which the backup ended, and then rolls back the transactions that had not finished by then. Writers are never
+ * blocked, apart from the dirty page flush when the backup starts. The backup itself waits for the transactions that
+ * logged changes before it started, the archived WAL must hold every record of a transaction to roll it back.
+ */
+class BackupManager {
+ public:
+  static constexpr const char *MANIFEST_FILE = "backup_manifest";
+  static constexpr const char *PAGES_FILE = "base.db";
+  static constexpr const char *WAL_FILE = "wal.archive";
+
+  BackupManager(DiskManager *disk_manager, LogManager *log_manager, BufferPoolManager *buffer_pool_manager,
+                TransactionManager *txn_manager)
+      : disk_manager_(disk_manager),
+        log_manager_(log_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        txn_manager_(txn_manager) {}
+
+  /**
+   * Back the database up into backup_dir, which must be empty or not exist yet. Don't call it from a thread running a
+   * transaction that wrote, it waits for that transaction to finish.
+   * @return the manifest of the backup
+   */
+  auto Backup(const std::string &backup_dir) -> BackupManifest;
+
+  /**
+   * Rebuild db_file from a backup: copy the pages back, redo the archived WAL and undo the transactions that were
+   * still running when the backup ended. The database must not be open.
+   * @return the manifest of the backup, end_lsn_ is the LSN the database was restored to
+   */
+  static auto Restore(const std::string &backup_dir, const std::string &db_file) -> BackupManifest;
+
+ private:
+  /** Pages read from the database file per call. */
+  static constexpr int BACKUP_CHUNK_PAGES = 64;
+  /** Bytes of WAL copied per read. */
+  static constexpr int ARCHIVE_CHUNK_SIZE = 1024 * 1024;
+  /** How long the archiver waits for new WAL once it caught up with the tail. */
+  static constexpr std::chrono::milliseconds ARCHIVE_POLL_INTERVAL{10};
+
+  /** Copy the log from archived_offset_ on into out until stop_offset_ is reached. */
+  void ArchiveLog(std::ofstream *out);
+
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  TransactionManager *txn_manager_;
+
+  /** Only one backup runs at a time. */
+  std::mutex backup_latch_;
+  std::atomic<uint64_t> archived_offset_{0};
+  std::atomic<uint64_t> stop_offset_{UINT64_MAX};
+  std::atomic<bool> archive_failed_{false};
+};
+
+}  // namespace hmssql
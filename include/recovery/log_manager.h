@@ -13,58 +13,104 @@
 #include <algorithm>
 #include <condition_variable>
 #include <mutex>
+#include <thread>  // NOLINT
 #include <vector>
 #include "log_record.h"
+#include "../common/util/compression_util.h"
 #include "../storage/disk/disk_manager.h"
 
 namespace hmssql {
 
+/**
+ * LogManager serializes log records into an in-memory log buffer and writes them to the log segments.
+ * Two buffers of LOG_BUFFER_SIZE are used: appenders fill log_buffer_ while the previous contents of the
+ * buffer are written out from flush_buffer_, so appends never wait on disk I/O unless the buffer is full.
+ *
+ * Every flush writes one log block:
+ * ---------------------------------------------------------
+ * | raw size (4) | stored size (4) | records or LZ4 block |
+ * ---------------------------------------------------------
+ * When log_compression is enabled and the block shrinks, the records are stored LZ4-compressed and
+ * stored size is smaller than raw size; otherwise both sizes are equal and the records follow as is.
+ */
 class LogManager {
 public:
+    static constexpr int LOG_BLOCK_HEADER_SIZE = 8;
+
     explicit LogManager(DiskManager *disk_manager)
     : disk_manager_(disk_manager),
       persistent_lsn_(INVALID_LSN),
       next_lsn_(0),
       flush_thread_running_(false),
-      flush_thread_(nullptr) {}
+      flush_thread_(nullptr) {
+      log_buffer_ = new char[LOG_BUFFER_SIZE];
+      flush_buffer_ = new char[LOG_BUFFER_SIZE];
+      compress_buffer_ = new char[LOG_BLOCK_HEADER_SIZE + CompressionUtil::MaxCompressedSize(LOG_BUFFER_SIZE)];
+    }
 
     ~LogManager() {
       StopFlushThread();
+      delete[] log_buffer_;
+      delete[] flush_buffer_;
+      delete[] compress_buffer_;
+      log_buffer_ = nullptr;
+      flush_buffer_ = nullptr;
+      compress_buffer_ = nullptr;
     }
-    // Start background flush thread
+    // Start background flush thread, it writes the log buffer out every log_timeout
     void RunFlushThread();
-    
+
     // Stop and join the flush thread
     void StopFlushThread();
-    
+
     // Flush all logs in buffer to disk
     void FlushAllLogs();
-    
-    // Append a new log record
+
+    // Make sure every log record up to and including lsn is on disk.
+    // Returns immediately if it already is, so callers can use it on every page write.
+    void Flush(lsn_t lsn);
+
+    // Flush the log buffer and return the log offset right after the last block written; tail_lsn is set to the
+    // LSN of the last record before that offset
+    auto FlushLogTail(lsn_t *tail_lsn) -> uint64_t;
+
+    // Append a new log record, serializing it into the log buffer
     auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
-    
+
     // Getters
     auto GetNextLSN() -> lsn_t { return next_lsn_; }
     auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
+    auto GetDiskManager() -> DiskManager * { return disk_manager_; }
 
 private:
+    // Swap the buffers and write out everything appended so far.
+    void FlushLogBuffer();
+
+    // Fill in the block header of flush_buffer_ and write the block, compressed if that is enabled and pays off
+    void WriteLogBlock(int flush_size);
+
     // Dependencies
     DiskManager *disk_manager_;
-    
-    // Thread safety components
+
+    // Thread safety components, latch_ protects the log buffer, flush_latch_
+    // serializes writers so only one flush buffer is in flight at a time
     std::mutex latch_;
+    std::mutex flush_latch_;
     std::condition_variable cv_;
-    
+
     // LSN management
     std::atomic<lsn_t> persistent_lsn_;
     std::atomic<lsn_t> next_lsn_;
-    
+
     // Thread management
     bool flush_thread_running_;
     std::thread *flush_thread_;
 
     // Log storage
-    std::vector<LogRecord> log_buffer_;
+    char *log_buffer_;
+    char *flush_buffer_;
+    char *compress_buffer_;
+    int log_buffer_offset_{LOG_BLOCK_HEADER_SIZE};
 };
 
-} // namespace hmssql
\ No newline at end of file
+} // namespace hmssql
@@ -32,7 +32,9 @@ enum class LogRecordType {
   /** Creating a new page in the table heap. */
   NEWPAGE,
   CREATE_DATABASE,
-  CHECKPOINT
+  CHECKPOINT,
+  /** UPDATE that only carries the columns that changed. */
+  UPDATE_DELTA
 };
 
 /**
@@ -54,6 +56,11 @@ enum class LogRecordType {
  *-----------------------------------------------------------------------------------
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
  *-----------------------------------------------------------------------------------
+ * For delta update type log record, the column types make the record self-describing, so redo can rebuild the
+ * new tuple from the old one on the page without access to the catalog, and undo the old one from the new one
+ *--------------------------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | column_count (2) | column types (1 each) | changed bitmap | changed new values | old values |
+ *--------------------------------------------------------------------------------------------------------------------
  * For new page type log record
  *--------------------------
  * | HEADER | prev_page_id |
@@ -134,6 +141,10 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
   }
 
+  // constructor for UPDATE_DELTA type, only the columns that differ between old_tuple and new_tuple are logged
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID &update_rid, const Tuple &old_tuple, const Tuple &new_tuple,
+            const Schema &schema);
+
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
       : size_(HEADER_SIZE),
@@ -162,6 +173,22 @@ class LogRecord {
 
   inline auto GetUpdateRID() -> RID & { return update_rid_; }
 
+  inline auto GetUpdateDelta() -> std::string & { return update_delta_; }
+
+  /**
+   * Rebuild the new image of a delta-encoded update.
+   * @param old_tuple the tuple the delta was computed against
+   * @return old_tuple with the logged columns replaced
+   */
+  auto ApplyUpdateDelta(const Tuple &old_tuple) const -> Tuple;
+
+  /**
+   * Rebuild the old image of a delta-encoded update.
+   * @param new_tuple the tuple the delta produced
+   * @return new_tuple with the logged columns set back
+   */
+  auto UndoUpdateDelta(const Tuple &new_tuple) const -> Tuple;
+
   inline auto GetNewPageRecord() -> page_id_t { return prev_page_id_; }
 
   inline auto GetSize() -> int32_t { return size_; }
@@ -188,6 +215,9 @@ class LogRecord {
   }
 
  private:
+  /** @return tuple with the changed columns of the delta replaced by their new or their old values */
+  auto ReplaceDeltaColumns(const Tuple &tuple, bool old_values) const -> Tuple;
+
   // Keep members in initialization order
   int32_t size_{0};
   lsn_t lsn_{INVALID_LSN};
@@ -204,6 +234,7 @@ class LogRecord {
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  std::string update_delta_;
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
 
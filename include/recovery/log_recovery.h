@@ -28,15 +28,28 @@ class LogRecovery {
   LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
       : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
+    block_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogRecovery() {
     delete[] log_buffer_;
+    delete[] block_buffer_;
     log_buffer_ = nullptr;
+    block_buffer_ = nullptr;
   }
 
-  void Redo();
-  void Undo();
+  /**
+   * Replay every log block from the head of the log to its tail. The head must be the start of a log block, which
+   * holds for a log that was never truncated and for a log rebuilt from a backup archive.
+   * @return the number of records applied to pages
+   */
+  auto Redo() -> int;
+  /**
+   * Roll back the changes of the transactions that have no COMMIT or ABORT record in the replayed log, from the newest
+   * record of each back along its prevLSN chain. Run it after Redo. The undo is not logged, flush the pages after it.
+   * @return the number of transactions rolled back
+   */
+  auto Undo() -> int;
   auto DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool;
 
   auto GetLSN() const -> lsn_t { 
@@ -54,16 +67,35 @@ class LogRecovery {
 }
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Apply one record to its table page if the page has not seen it yet. @return true if the page was changed */
+  auto RedoLogRecord(LogRecord *log_record) -> bool;
+  /** Reverse one record of an unfinished transaction on its table page. @return true if the page was changed */
+  auto UndoLogRecord(LogRecord *log_record) -> bool;
+  /** Read the log block at offset into log_buffer_ and move offset_ past it. @return false if it is incomplete */
+  auto ReadLogBlock(uint64_t offset, uint32_t *raw_size) -> bool;
+  /** Find a record replayed by Redo. @return false if it is not in the log */
+  auto FindLogRecord(lsn_t lsn, LogRecord *log_record) -> bool;
+  /** @return the row a record changes, nullptr for records that change no row */
+  static auto TupleRidOf(LogRecord *log_record) -> const RID *;
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
   std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** The transaction of the last record of each row, INVALID_TXN_ID for a rollback. Undo leaves rows rolled back. */
+  std::unordered_map<RID, txn_id_t> last_writer_;
+  /** Offset of the block in log_buffer_ while undo reads records, -1 for none. */
+  int buffered_block_{-1};
+  uint32_t buffered_size_{0};
 
-  int offset_ __attribute__((__unused__));  // NOLINT
+  uint64_t offset_;
+  /** Records of the current log block, decompressed if needed. */
   char *log_buffer_;
+  /** The current log block as it is stored in the log. */
+  char *block_buffer_;
 };
 
 }  // namespace hmssql
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
@@ -21,6 +22,33 @@
 
 namespace hmssql {
 
+/**
+ * Header stored at the front of every WAL segment file. Segments are preallocated to a fixed size, so the header
+ * records how much of the payload is valid instead of relying on the file length.
+ */
+struct LogSegmentHeader {
+  static constexpr uint32_t MAGIC = 0x484d5357;  // "HMSW"
+  /** first_block_offset_ of a segment no log block starts in, one block runs through all of it */
+  static constexpr uint64_t NO_BLOCK = UINT64_MAX;
+
+  uint32_t magic_;
+  uint32_t segment_size_;
+  uint64_t segment_no_;
+  /** logical log offset of the first payload byte */
+  uint64_t start_offset_;
+  /** number of valid payload bytes */
+  uint64_t used_;
+  /**
+   * logical log offset of the first log block that starts in this segment. Segments are cut at fixed sizes, not at
+   * block boundaries, so reading the log from a segment on has to start here.
+   */
+  uint64_t first_block_offset_;
+};
+
+/** Size reserved for the segment header, the payload starts right after it. */
+constexpr int LOG_SEGMENT_HEADER_SIZE = 64;
+static_assert(sizeof(LogSegmentHeader) <= LOG_SEGMENT_HEADER_SIZE, "log segment header too large");
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -60,20 +88,64 @@ class DiskManager {
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Read consecutive pages straight from the database file, without going through the buffer pool. Used to stream
+   * the file out for a backup; each call holds the file latch for a single read, so page writes are never torn.
+   * @param first_page_id id of the first page to read
+   * @param count maximum number of pages to read
+   * @param[out] page_data output buffer of count * BUSTUB_PAGE_SIZE bytes
+   * @return the number of whole pages read, 0 at the end of the file
+   */
+  auto ReadPages(page_id_t first_page_id, int count, char *page_data) -> int;
+
+  /** @return the number of pages in the database file */
+  auto GetNumPages() -> int;
+
+  /**
+   * Flush the entire log buffer into disk. The log is a single logical byte stream split over fixed-size segment
+   * files (<db>.log.<segment no>); a write that crosses a segment boundary continues in the next segment.
    * @param log_data raw log data
    * @param size size of log entry
+   * @param block_start log_data starts a log block, false for a raw copy of a log stream
    */
-  void WriteLog(const char *log_data, int size);
+  void WriteLog(const char *log_data, int size, bool block_start = true);
 
   /**
-   * Read a log entry from the log file.
+   * Read a log entry from the log segments.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
+   * @param offset logical offset of the log entry in the log stream
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  auto ReadLog(char *log_data, int size, uint64_t offset) -> bool;
+
+  /** @return the logical offset one past the last byte written to the log */
+  auto GetLogTail() -> uint64_t;
+
+  /** @return the logical offset of the oldest log block still kept on disk, reading the log starts there */
+  auto GetLogHead() -> uint64_t;
+
+  /**
+   * Release the log segments that end at or before the given offset. Released segments are renamed to the next free
+   * segment numbers and reused, up to the configured number of recycled segments; the rest are removed.
+   * @param redo_offset logical offset recovery would start from, usually the redo point of the last checkpoint
+   */
+  void TruncateLog(uint64_t redo_offset);
+
+  /**
+   * Keep every log segment from the given offset on, even if a checkpoint truncates past it. A backup holds the log
+   * while it archives it and moves the hold forward as it goes.
+   * @param offset logical offset of the oldest log byte that must be kept
+   */
+  void HoldLog(uint64_t offset);
+
+  /** Drop the hold set by HoldLog. */
+  void ReleaseLog();
+
+  /** Remove every log segment and start over with an empty log at offset 0. */
+  void ResetLog();
+
+  /** @return the file name of the given log segment */
+  auto GetLogSegmentName(uint64_t segment_no) const -> std::string;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -96,11 +168,48 @@ class DiskManager {
 private:
   void SyncFile(std::fstream& file);
 
+  /** Scan the existing log segments and position the write cursor at the end of the log. */
+  void OpenLogSegments();
+  /** Create a segment file of full size, so later appends never have to extend it. */
+  void CreateLogSegment(uint64_t segment_no);
+  /** Seal the current segment and continue writing into the next one. */
+  void SwitchLogSegment();
+  void WriteLogSegmentHeader(std::fstream &file, uint64_t segment_no, uint64_t used,
+                             uint64_t first_block_offset = LogSegmentHeader::NO_BLOCK);
+  auto ReadLogSegmentHeader(const std::string &file_name, LogSegmentHeader *header) -> bool;
+  /** @return the first log block starting in a live segment, NO_BLOCK if none does */
+  auto GetFirstLogBlock(uint64_t segment_no) -> uint64_t;
+  /** Open / close the descriptor FlushLog uses to force the current segment to stable storage. */
+  void OpenLogSyncHandle();
+  void CloseLogSyncHandle();
+  auto LogSegmentPayloadSize() const -> uint64_t { return log_segment_size_ - LOG_SEGMENT_HEADER_SIZE; }
+
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
-  // stream to write log file
+  // stream to write the current log segment
   std::fstream log_io_;
+  // stream to read older log segments, kept open across sequential reads
+  std::fstream log_read_io_;
+  uint64_t log_read_segment_{0};
+  // base name of the log, segments are <log_name_>.<segment no>
   std::string log_name_;
+  uint64_t log_segment_size_{0};
+  uint64_t max_recycled_segments_{0};
+  // segments [first_log_segment_, current_log_segment_] hold live log records,
+  // (current_log_segment_, last_log_segment_] are recycled and ready for reuse
+  uint64_t first_log_segment_{0};
+  uint64_t current_log_segment_{0};
+  uint64_t last_log_segment_{0};
+  uint64_t current_segment_used_{0};
+  // the first log block starting in the current segment
+  uint64_t current_first_block_{LogSegmentHeader::NO_BLOCK};
+  // the first log block of the first live segment, see GetLogHead
+  uint64_t log_head_{0};
+  uint64_t log_tail_{0};
+  // TruncateLog never releases segments at or after this offset
+  uint64_t log_hold_offset_{UINT64_MAX};
+  std::mutex log_io_latch_;
+  int log_sync_fd_{-1};
   std::fstream db_io_;
   std::string file_name_;
   
@@ -109,7 +218,6 @@ private:
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   std::mutex db_io_latch_;
-  static char *buffer_used;
 };
 
 }  // namespace hmssql
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tmp_file.h
+//
+// Identification: src/include/storage/disk/tmp_file.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "../include/common/config.h"
+#include "../include/common/macros.h"
+
+namespace hmssql {
+
+/**
+ * TmpFile holds the pages the operators of one query spill. They go to an anonymous temporary file (std::tmpfile)
+ * instead of the database file, so they are neither logged nor checkpointed. A page that was deallocated is reused by
+ * the next one allocated, and the file is removed once the TmpFile is destroyed at the end of the query, or with the
+ * process. The file is only created when the first page is written.
+ *
+ * The workers of a query share its TmpFile, it is thread safe.
+ */
+class TmpFile {
+ public:
+  TmpFile() = default;
+  ~TmpFile();
+
+  DISALLOW_COPY_AND_MOVE(TmpFile);
+
+  /** @return a page to write, one deallocated before if there is one */
+  auto AllocatePage() -> page_id_t;
+
+  /** The page is free for the next AllocatePage. */
+  void DeallocatePage(page_id_t page_id);
+
+  /** Write BUSTUB_PAGE_SIZE bytes of data to the page. */
+  void WritePage(page_id_t page_id, const char *data);
+
+  /** Read the page into BUSTUB_PAGE_SIZE bytes of data. */
+  void ReadPage(page_id_t page_id, char *data);
+
+  /** @return the number of pages the file has, the most that were allocated at once */
+  auto GetNumPages() -> size_t;
+
+ private:
+  std::mutex latch_;
+  std::FILE *file_{nullptr};
+  page_id_t next_page_id_{0};
+  std::vector<page_id_t> free_pages_;
+};
+
+}  // namespace hmssql
@@ -22,6 +22,8 @@ static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
 
 namespace hmssql {
 
+class Transaction;
+
 /**
  * Slotted page format:
  *  ---------------------------------------------------------
@@ -38,6 +40,9 @@ namespace hmssql {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ *  When logging is enabled every modification appends a log record first and
+ *  stamps its LSN into the page header, the buffer pool uses it to enforce WAL
+ *  before the page is written back.
  */
 class TablePage : public Page {
  public:
@@ -74,53 +79,83 @@ class TablePage : public Page {
    * @param tuple tuple to insert
    * @param[out] rid rid of the inserted tuple
    * @param log_manager log manager for logging
+   * @param reserved bytes of free space the insert must leave free
+   * @param txn the transaction the insert is logged for, nullptr if none
    * @return true if the insert is successful (i.e. there is enough space)
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manager) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manager, uint32_t reserved = 0,
+                   Transaction *txn = nullptr) -> bool;
 
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
+   * @param log_manager log manager for logging
+   * @param txn the transaction the delete is logged for, nullptr if none
    * @return true if marking the tuple as deleted is successful (i.e the tuple exists)
    */
-  auto MarkDelete(const RID &rid) -> bool;
+  auto MarkDelete(const RID &rid, LogManager *log_manager, Transaction *txn = nullptr) -> bool;
 
   /**
    * Update a tuple.
    * @param new_tuple new value of the tuple
    * @param[out] old_tuple old value of the tuple
    * @param rid rid of the tuple
+   * @param log_manager log manager for logging
+   * @param schema schema of the tuple; when given, only the changed columns are logged
+   * @param reserved bytes of free space the update must leave free
+   * @param txn the transaction the update is logged for, nullptr if none
    * @return true if updating the tuple succeeded
    */
-  auto UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid) -> bool;
+  auto UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, LogManager *log_manager,
+                   const Schema *schema = nullptr, uint32_t reserved = 0, Transaction *txn = nullptr) -> bool;
 
   /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid);
+  void ApplyDelete(const RID &rid, LogManager *log_manager);
+
+  /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
+  void RollbackDelete(const RID &rid, LogManager *log_manager);
 
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
    * @param[out] tuple the tuple that was read
+   * @param[out] is_deleted if given, a tuple marked deleted is read as well and this says whether it is
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, bool *is_deleted = nullptr) -> bool;
+
+  /**
+   * Point a tuple at the bytes of a tuple of this page instead of copying them.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple, valid only while the page stays latched and pinned, copy it with GetTuple to keep it
+   * @return true if the tuple exists
+   */
+  auto GetTupleView(const RID &rid, Tuple *tuple) -> bool;
 
   /**
    * @param[out] first_rid the RID of the first tuple in this page
+   * @param include_deleted also return tuples marked deleted, older snapshots may still read them
    * @return true if the first tuple exists, false otherwise
    */
-  auto GetFirstTupleRid(RID *first_rid) -> bool;
+  auto GetFirstTupleRid(RID *first_rid, bool include_deleted = false) -> bool;
 
   /**
    * @param cur_rid the RID of the current tuple
    * @param[out] next_rid the RID of the tuple following the current tuple
+   * @param include_deleted also return tuples marked deleted, older snapshots may still read them
    * @return true if the next tuple exists, false otherwise
    */
-  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
+  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted = false) -> bool;
 
  private:
   static_assert(sizeof(page_id_t) == 4);
 
+  /**
+   * Append the log record of a change to this page and make it the page LSN. The record of a change txn made is
+   * linked to the previous record of txn.
+   */
+  void AppendLogRecord(LogManager *log_manager, Transaction *txn, LogRecord *log_record);
+
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
@@ -6,31 +6,74 @@
 
 namespace hmssql {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
  * Sizes are in bytes.
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
- * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ * We choose this format because DeserializeExpression expects to read Size followed by Data. FreeSpace is the offset
+ * of the last tuple inserted, tuples follow each other from there to the end of the page.
  */
 class TmpTuplePage : public Page {
  public:
   void Init(page_id_t page_id, uint32_t page_size) {
     memcpy(GetData(), &page_id, sizeof(page_id_t));
-    memcpy(GetData() + sizeof(page_id_t), &page_size, sizeof(uint32_t));
+    // Temporary pages are never logged
+    SetLSN(INVALID_LSN);
+    SetFreeSpacePointer(page_size);
   }
 
-  auto GetTablePageId() -> page_id_t { return INVALID_PAGE_ID; }
+  auto GetTablePageId() -> page_id_t { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  void SetTablePageId(page_id_t page_id) { memcpy(GetData(), &page_id, sizeof(page_id_t)); }
+
+  /** @return the offset of the last tuple inserted, the page size if the page is empty */
+  auto GetFreeSpacePointer() -> uint32_t { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
-  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool { return false; }
+  /**
+   * Insert a tuple at the front of the tuples.
+   * @param[out] out where the tuple went
+   * @return false if the tuple does not fit in the free space
+   */
+  auto Insert(const Tuple &tuple, TmpTuple *out) -> bool {
+    auto free_space_pointer = GetFreeSpacePointer();
+    auto size = sizeof(uint32_t) + tuple.GetLength();
+    if (free_space_pointer < SIZE_TMP_PAGE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
+
+  /**
+   * Read the tuple at offset.
+   * @return the offset of the next tuple, the page size after the first one inserted
+   */
+  auto Get(size_t offset, Tuple *tuple) -> size_t {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
+
+  /** @return the offset of the tuple after the one at offset, without reading it */
+  auto NextOffset(size_t offset) -> size_t {
+    uint32_t size;
+    memcpy(&size, GetData() + offset, sizeof(uint32_t));
+    return offset + sizeof(uint32_t) + size;
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+  static constexpr size_t SIZE_TMP_PAGE_HEADER = 12;
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace hmssql
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// morsel_dispenser.h
+//
+// Identification: src/include/storage/table/morsel_dispenser.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "../include/common/config.h"
+
+namespace hmssql {
+
+class TableHeap;
+
+/**
+ * MorselDispenser hands out the pages of a TableHeap in morsels, runs of consecutive pages of the page chain, to the
+ * workers of a parallel scan. Every page goes to exactly one worker. Workers that finish early claim more, so the
+ * work stays balanced however the tuples are spread over the pages.
+ */
+class MorselDispenser {
+ public:
+  /**
+   * @param table_heap the table to scan
+   * @param pages_per_morsel the number of pages a worker claims at a time
+   */
+  explicit MorselDispenser(TableHeap *table_heap, uint32_t pages_per_morsel = MORSEL_PAGES);
+
+  /**
+   * Claim the next morsel. Safe to call from several threads.
+   * @param[out] page_ids the pages of the morsel, in chain order
+   * @return false if every page was handed out
+   */
+  auto Claim(std::vector<page_id_t> *page_ids) -> bool;
+
+ private:
+  TableHeap *table_heap_;
+  const uint32_t pages_per_morsel_;
+  /** Guards next_page_id_, the chain is walked by one worker at a time. */
+  std::mutex latch_;
+  /** The first page not handed out yet. */
+  page_id_t next_page_id_;
+};
+
+}  // namespace hmssql
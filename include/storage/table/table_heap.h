@@ -11,6 +11,11 @@
 
 #pragma once
 
+#include <functional>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
 #include "../include/buffer/buffer_pool_manager.h"
 #include "../include/recovery/log_manager.h"
 #include "../include/storage/page/table_page.h"
@@ -19,6 +24,8 @@
 
 namespace hmssql {
 
+class Transaction;
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
@@ -50,24 +57,31 @@ class TableHeap {
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
+   * @param txn the inserting transaction, without one the tuple is visible to everybody right away
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn = nullptr) -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
-   * @return true iff the delete is successful (i.e the tuple exists)
+   * @param txn the deleting transaction
+   * @return true iff the delete is successful (i.e the tuple exists). If it fails because another transaction wrote
+   * the tuple, txn is tainted.
    */
-  auto MarkDelete(const RID &rid) -> bool;  // for delete
+  auto MarkDelete(const RID &rid, Transaction *txn = nullptr) -> bool;  // for delete
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Update a tuple in place. Rows do not move between pages, if the new tuple does not fit the old page the update
+   * fails and the caller has to fail the statement.
    * @param tuple new tuple
    * @param rid rid of the old tuple
-   * @return true is update is successful.
+   * @param schema schema of the table; when given, the update is logged as a delta of the changed columns
+   * @param txn the updating transaction
+   * @return true is update is successful. If it fails because another transaction wrote the tuple, txn is tainted.
    */
-  auto UpdateTuple(const Tuple &tuple, const RID &rid) -> bool;
+  auto UpdateTuple(const Tuple &tuple, const RID &rid, const Schema *schema = nullptr, Transaction *txn = nullptr)
+      -> bool;
 
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
@@ -81,27 +95,80 @@ class TableHeap {
    */
   void RollbackDelete(const RID &rid);
 
+  /**
+   * Called on abort to undo the insert, update or delete of a tuple by txn. It cannot run out of space, the bytes the
+   * image to restore needs stayed reserved on the page. Throws std::logic_error if they did not all the same.
+   * @param rid rid of the written tuple
+   */
+  void RollbackWrite(const RID &rid, Transaction *txn);
+
+  /**
+   * Called on commit, the old image of the tuple is not going back to the page, its space is free for others.
+   * @param rid rid of the written tuple
+   */
+  void ReleaseReservation(const RID &rid);
+
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
+   * @param txn the reading transaction, the tuple is read as of its snapshot. Without one the latest version is read.
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, bool acquire_read_lock = true) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn = nullptr) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin() -> TableIterator;
+  /**
+   * @param txn the reading transaction, the iterator returns the tuples of its snapshot
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn = nullptr) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
 
+  /**
+   * Read the tuples of one page, for scans that split the table by pages instead of iterating it.
+   * @param page_id the page to read
+   * @param[out] tuples the tuples of the page are appended to it
+   * @param txn the reading transaction, the tuples of its snapshot are read. Without one the latest versions are.
+   * @param keep if set, only the tuples it returns true for are copied out of the page. It is called with the
+   * version the transaction sees, which may still point into the page.
+   */
+  void ScanPage(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn = nullptr,
+                const std::function<bool(const Tuple &)> &keep = nullptr);
+
+  /** @return the id of the page after page_id in the table, INVALID_PAGE_ID for the last page */
+  auto GetNextPageId(page_id_t page_id) -> page_id_t;
+
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
  private:
+  /** Read a tuple from a page the caller latched, see GetTuple. */
+  auto ReadTuple(TablePage *page, const RID &rid, Tuple *tuple, Transaction *txn) -> bool;
+
+  /** @return the bytes reserved on the page, inserts and updates leave them free */
+  auto GetReservedBytes(page_id_t page_id) -> uint32_t;
+
+  /** Space the rollback of a tuple needs back on its page */
+  struct Reservation {
+    /** The size of the tuple before the transaction writing it */
+    uint32_t original_size_{0};
+    /** By how much that exceeds the current size */
+    uint32_t reserved_{0};
+  };
+
   BufferPoolManager *buffer_pool_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+
+  /**
+   * An update that shrinks a tuple frees bytes of its page the rollback must be able to restore the old image into.
+   * They stay reserved until the writer commits or aborts. Reservations only grow under the write latch of the page.
+   */
+  std::mutex reservation_latch_;
+  std::unordered_map<RID, Reservation> tuple_reservations_;
+  std::unordered_map<page_id_t, uint32_t> page_reservations_;
 };
 
 }  // namespace hmssql
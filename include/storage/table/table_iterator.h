@@ -19,23 +19,20 @@
 namespace hmssql {
 
 class TableHeap;
+class Transaction;
 
 /**
- * TableIterator enables the sequential scan of a TableHeap.
+ * TableIterator enables the sequential scan of a TableHeap. With a transaction it returns the tuples of its
+ * snapshot, skipping the ones inserted or deleted by transactions it does not see.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid);
-
-  TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)) {}
-
-  ~TableIterator() { delete tuple_; }
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn = nullptr);
 
   inline auto operator==(const TableIterator &itr) const -> bool {
-    return tuple_->rid_.Get() == itr.tuple_->rid_.Get();
+    return tuple_.rid_.Get() == itr.tuple_.rid_.Get();
   }
 
   inline auto operator!=(const TableIterator &itr) const -> bool { return !(*this == itr); }
@@ -48,15 +45,11 @@ class TableIterator {
 
   auto operator++(int) -> TableIterator;
 
-  auto operator=(const TableIterator &other) -> TableIterator & {
-    table_heap_ = other.table_heap_;
-    *tuple_ = *other.tuple_;
-    return *this;
-  }
-
  private:
   TableHeap *table_heap_;
-  Tuple *tuple_;
+  /** The current tuple, kept in the iterator so that End() and copies of it do not allocate */
+  Tuple tuple_;
+  Transaction *txn_;
 };
 
 }  // namespace hmssql
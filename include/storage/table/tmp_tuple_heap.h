@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tmp_tuple_heap.h
+//
+// Identification: src/include/storage/table/tmp_tuple_heap.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "../include/common/macros.h"
+#include "../include/storage/disk/tmp_file.h"
+#include "../include/storage/page/tmp_tuple_page.h"
+#include "../include/storage/table/tuple.h"
+
+namespace hmssql {
+
+/**
+ * TmpTupleHeap is a temporary file of tuples, written by operators that spill what does not fit in their memory
+ * budget. Tuples are appended to a page kept in memory and full pages are written to the TmpFile of the query as
+ * TmpTuplePages. It is read back once, in the order the tuples were appended, one page in memory at a time, and every
+ * page is deallocated as soon as it was read.
+ */
+class TmpTupleHeap {
+ public:
+  /** @param file the temporary file of the query the pages go to */
+  explicit TmpTupleHeap(TmpFile *file);
+
+  /** Deallocates the pages that were not read. */
+  ~TmpTupleHeap();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleHeap);
+
+  /** Append a tuple. Only before the heap is read. */
+  void Append(const Tuple &tuple);
+
+  /** @return the number of tuples appended */
+  auto Size() const -> size_t { return tuple_count_; }
+
+  /**
+   * Read the next tuple.
+   * @return false once every tuple was read
+   */
+  auto Next(Tuple *tuple) -> bool;
+
+ private:
+  /** Write the page in memory to a new page of the file. */
+  void FlushWritePage();
+
+  TmpFile *file_;
+  size_t tuple_count_{0};
+  /** The page tuples are appended to */
+  TmpTuplePage write_page_;
+  /** The pages in the file */
+  std::vector<page_id_t> page_ids_;
+  /** The number of pages in page_ids_ read so far */
+  size_t read_pages_{0};
+  /** The page of the file being read */
+  TmpTuplePage file_page_;
+  /** The page being read, &file_page_ or &write_page_ once the pages in the file were read */
+  TmpTuplePage *read_page_{nullptr};
+  /** The offsets of the tuples of read_page_ not read yet, the next one last */
+  std::vector<size_t> read_offsets_;
+  bool write_page_read_{false};
+};
+
+}  // namespace hmssql
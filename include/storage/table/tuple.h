@@ -11,10 +11,12 @@
 
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "../include/catalog/schema.h"
+#include "../include/common/config.h"
 #include "../include/common/rid.h"
 #include "../include/type/value.h"
 
@@ -25,6 +27,10 @@ namespace hmssql {
  * ---------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
  * ---------------------------------------------------------------------
+ *
+ * A tuple either owns its data or is a view of a tuple on a page, which stays valid only while the page is pinned.
+ * Owned data of up to TUPLE_INLINE_SIZE bytes is kept inside the Tuple, longer data in a heap buffer that the tuple
+ * keeps and reuses for the next data assigned to it, so a tuple that is read into again and again does not allocate.
  */
 class Tuple {
   friend class TablePage;
@@ -39,21 +45,22 @@ class Tuple {
   explicit Tuple(RID rid) : rid_(rid) {}
 
   // constructor for creating a new tuple based on input value
-  Tuple(std::vector<Value> values, const Schema *schema);
+  Tuple(const std::vector<Value> &values, const Schema *schema);
 
-  // copy constructor, deep copy
+  // copy constructor, deep copy of owned data, a view stays a view
   Tuple(const Tuple &other);
 
-  // assign operator, deep copy
+  // move constructor, takes over the data of other and leaves it empty
+  Tuple(Tuple &&other) noexcept;
+
+  // assign operator, deep copy of owned data, a view stays a view
   auto operator=(const Tuple &other) -> Tuple &;
 
-  ~Tuple() {
-    if (allocated_) {
-      delete[] data_;
-    }
-    allocated_ = false;
-    data_ = nullptr;
-  }
+  // move assign operator, takes over the data of other and leaves it empty
+  auto operator=(Tuple &&other) noexcept -> Tuple &;
+
+  ~Tuple() { delete[] heap_; }
+
   // serialize tuple data
   void SerializeTo(char *storage) const;
 
@@ -89,10 +96,27 @@ class Tuple {
   // Get the starting storage address of specific column
   auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char *;
 
+  /** Make the tuple own size bytes of data, inline or in its heap buffer. @return where the data goes */
+  auto Allocate(uint32_t size) -> char *;
+
+  /** Make the tuple own a copy of size bytes at data. */
+  void CopyData(const char *data, uint32_t size) { memcpy(Allocate(size), data, size); }
+
+  /** Make the tuple a view of size bytes at data, which it does not own. */
+  void SetView(char *data, uint32_t size) {
+    allocated_ = false;
+    size_ = size;
+    data_ = data;
+  }
+
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
   char *data_{nullptr};
+  /** The heap buffer owned data longer than TUPLE_INLINE_SIZE is kept in, and its size */
+  char *heap_{nullptr};
+  uint32_t capacity_{0};
+  alignas(8) char inline_[TUPLE_INLINE_SIZE];
 };
 
 }  // namespace hmssql
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// arena_pool.h
+//
+// Identification: src/include/type/arena_pool.h
+//
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "../include/common/config.h"
+#include "../include/common/macros.h"
+#include "../include/type/abstract_pool.h"
+
+namespace hmssql {
+
+/**
+ * ArenaPool hands out memory by bumping a pointer through chunks and gives it back only in bulk, when it is reset or
+ * destroyed. Free does nothing. The chunks start at MIN_CHUNK_SIZE bytes and double up to ARENA_CHUNK_SIZE, an
+ * allocation of more than a quarter of that gets a chunk of its own.
+ *
+ * An arena is not thread safe, every worker of a query allocates from its own.
+ */
+class ArenaPool final : public AbstractPool {
+ public:
+  /** The size of the first chunk */
+  static constexpr size_t MIN_CHUNK_SIZE = 1024;
+
+  ArenaPool() = default;
+  ~ArenaPool() override = default;
+
+  DISALLOW_COPY(ArenaPool);
+  ArenaPool(ArenaPool &&other) noexcept;
+  auto operator=(ArenaPool &&other) noexcept -> ArenaPool &;
+
+  /** @return size bytes aligned to 8, good until the pool is reset or destroyed, never nullptr */
+  auto Allocate(size_t size) -> void * override {
+    size = (size + 7) & ~static_cast<size_t>(7);
+    if (size > static_cast<size_t>(end_ - next_)) {
+      return AllocateChunk(size);
+    }
+    auto *data = next_;
+    next_ += size;
+    return data;
+  }
+
+  /** Memory goes back in bulk only */
+  void Free(void *ptr) override {}
+
+  /** Give back everything allocated. The current chunk, the largest one, is kept for what is allocated next. */
+  void Reset();
+
+  /** @return the bytes of the chunks the pool holds */
+  auto GetMemoryUsage() const -> size_t { return memory_usage_; }
+
+ private:
+  /** Allocate size bytes from a new chunk, one of their own if they are large. */
+  auto AllocateChunk(size_t size) -> void *;
+
+  /** The chunk being filled */
+  std::unique_ptr<char[]> current_;
+  size_t current_size_{0};
+  /** The chunks filled before the current one and those of large allocations */
+  std::vector<std::unique_ptr<char[]>> retired_;
+  char *next_{nullptr};
+  char *end_{nullptr};
+  size_t memory_usage_{0};
+};
+
+}  // namespace hmssql
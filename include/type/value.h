@@ -63,6 +63,8 @@ class Value {
 
   Value() : Value(TypeId::INVALID) {}
   Value(const Value &other);
+  // Takes over the data of other, which is left a null of its type
+  Value(Value &&other) noexcept;
   auto operator=(Value other) -> Value &;
   ~Value();
 
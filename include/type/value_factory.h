@@ -12,6 +12,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -33,8 +34,12 @@ namespace hmssql {
 
 class ValueFactory {
  public:
-  static inline auto Clone(const Value &src, __attribute__((__unused__)) AbstractPool *dataPool = nullptr) -> Value {
-    return src.Copy();
+  /** @return a copy of src, with dataPool one whose VARCHAR bytes are copied into the pool and live as long as it */
+  static inline auto Clone(const Value &src, AbstractPool *dataPool = nullptr) -> Value {
+    if (dataPool == nullptr || src.GetTypeId() != TypeId::VARCHAR || src.IsNull()) {
+      return src.Copy();
+    }
+    return GetVarcharValue(src.GetData(), src.GetLength(), false, dataPool);
   }
 
   static inline auto GetTinyIntValue(int8_t value) -> Value { return {TypeId::TINYINT, value}; }
@@ -57,19 +62,26 @@ class ValueFactory {
 
   static inline auto GetBooleanValue(int8_t value) -> Value { return {TypeId::BOOLEAN, value}; }
 
-  static inline auto GetVarcharValue(const char *value, bool manage_data,
-                                     __attribute__((__unused__)) AbstractPool *pool = nullptr) -> Value {
+  static inline auto GetVarcharValue(const char *value, bool manage_data, AbstractPool *pool = nullptr) -> Value {
     auto len = static_cast<uint32_t>(value == nullptr ? 0U : strlen(value) + 1);
-    return GetVarcharValue(value, len, manage_data);
+    return GetVarcharValue(value, len, manage_data, pool);
   }
 
-  static inline auto GetVarcharValue(const char *value, uint32_t len, bool manage_data,
-                                     __attribute__((__unused__)) AbstractPool *pool = nullptr) -> Value {
+  /** With a pool the bytes are copied into it whatever manage_data says, the Value does not free them */
+  static inline auto GetVarcharValue(const char *value, uint32_t len, bool manage_data, AbstractPool *pool = nullptr)
+      -> Value {
+    if (pool != nullptr && value != nullptr) {
+      auto *data = static_cast<char *>(pool->Allocate(len));
+      memcpy(data, value, len);
+      return {TypeId::VARCHAR, data, len, false};
+    }
     return {TypeId::VARCHAR, value, len, manage_data};
   }
 
-  static inline auto GetVarcharValue(const std::string &value, __attribute__((__unused__)) AbstractPool *pool = nullptr)
-      -> Value {
+  static inline auto GetVarcharValue(const std::string &value, AbstractPool *pool = nullptr) -> Value {
+    if (pool != nullptr) {
+      return GetVarcharValue(value.c_str(), static_cast<uint32_t>(value.length()) + 1, false, pool);
+    }
     return {TypeId::VARCHAR, value};
   }
 
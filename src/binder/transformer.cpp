@@ -68,6 +68,21 @@ auto Binder::BindStatement(duckdb_libpgquery::PGNode *stmt) -> std::unique_ptr<B
       }
       return BindVariableSet(var_stmt);
     }
+
+    case duckdb_libpgquery::T_PGTransactionStmt: {
+      auto txn_stmt = reinterpret_cast<duckdb_libpgquery::PGTransactionStmt *>(stmt);
+      switch (txn_stmt->kind) {
+        case duckdb_libpgquery::PG_TRANS_STMT_BEGIN:
+        case duckdb_libpgquery::PG_TRANS_STMT_START:
+          return std::make_unique<TransactionStatement>(TransactionStatementKind::BEGIN);
+        case duckdb_libpgquery::PG_TRANS_STMT_COMMIT:
+          return std::make_unique<TransactionStatement>(TransactionStatementKind::COMMIT);
+        case duckdb_libpgquery::PG_TRANS_STMT_ROLLBACK:
+          return std::make_unique<TransactionStatement>(TransactionStatementKind::ROLLBACK);
+        default:
+          throw NotImplementedException("savepoints and prepared transactions are not supported");
+      }
+    }
     default:
       throw NotImplementedException(NodeTagToString(stmt->type));
   }
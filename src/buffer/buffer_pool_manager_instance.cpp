@@ -11,6 +11,8 @@
 
 #include "../include/buffer/buffer_pool_manager_instance.h"
 
+#include <vector>
+
 #include "../include/common/exception.h"
 #include "../include/common/macros.h"
 
@@ -64,8 +66,7 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
     page_id_t evicted_page_id = pages_[frame_id].GetPageId();
 
     if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(evicted_page_id, pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
+      WritePageToDisk(frame_id);
     }
 
     pages_[frame_id].ResetMemory();
@@ -116,8 +117,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
     page_id_t evicted_page_id = pages_[frame_id].GetPageId();
 
     if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(evicted_page_id, pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
+      WritePageToDisk(frame_id);
     }
 
     pages_[frame_id].ResetMemory();
@@ -168,19 +168,40 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   }
 
   frame_id_t frame_id;
-
-  if (!page_table_->Find(page_id, frame_id)) {
-    return false;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (!page_table_->Find(page_id, frame_id)) {
+      return false;
+    }
+    // Keep the frame from being evicted while latch_ is released to wait for the page latch
+    pages_[frame_id].pin_count_++;
+    replacer_->SetEvictable(frame_id, false);
   }
 
-  disk_manager_->WritePage(page_id, pages_[frame_id].data_);
+  // A writer may be changing the page right now, the read latch makes sure a complete image goes to disk
+  pages_[frame_id].RLatch();
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    WritePageToDisk(frame_id);
+  }
+  pages_[frame_id].RUnlatch();
+  UnpinPgImp(page_id, false);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
-  for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
-    FlushPgImp(pages_[frame_id].GetPageId());
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
+      if (pages_[frame_id].GetPageId() != INVALID_PAGE_ID) {
+        page_ids.push_back(pages_[frame_id].GetPageId());
+      }
+    }
+  }
+  // Pages are flushed one at a time, so writers only ever wait for the page they are about to change
+  for (auto page_id : page_ids) {
+    FlushPgImp(page_id);
   }
 }
 
@@ -212,4 +233,16 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
 
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
 
+void BufferPoolManagerInstance::WritePageToDisk(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  if (enable_logging && log_manager_ != nullptr) {
+    lsn_t page_lsn = page.GetLSN();
+    if (page_lsn != INVALID_LSN && page_lsn > log_manager_->GetPersistentLSN()) {
+      log_manager_->Flush(page_lsn);
+    }
+  }
+  disk_manager_->WritePage(page.GetPageId(), page.GetData());
+  page.is_dirty_ = false;
+}
+
 }  // namespace hmssql
@@ -68,12 +68,14 @@ void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
     cache_list_.push_front(frame_id);
     cache_map_[frame_id] = cache_list_.begin();
   } else if (access_count_[frame_id] > k_) {
-    if (cache_map_.count(frame_id) != 0U) {
-      auto it = cache_map_[frame_id];
-      cache_list_.erase(it);
+    // The node moves to the front, no list node is allocated for an access
+    auto it = cache_map_.find(frame_id);
+    if (it != cache_map_.end()) {
+      cache_list_.splice(cache_list_.begin(), cache_list_, it->second);
+    } else {
+      cache_list_.push_front(frame_id);
+      cache_map_[frame_id] = cache_list_.begin();
     }
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
   } else {
     if (history_map_.count(frame_id) == 0U) {
       history_list_.push_front(frame_id);
@@ -19,8 +19,9 @@ namespace hmssql {
 
 // For backward compatibility
 std::atomic<bool> enable_logging(false);
-std::chrono::milliseconds log_timeout = std::chrono::seconds(1);  // Changed type to milliseconds
+std::chrono::milliseconds log_timeout = std::chrono::milliseconds(200);
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
+std::chrono::milliseconds session_idle_timeout = std::chrono::minutes(5);
 
 Config::Config() {
   InitializeDefaults();
@@ -31,8 +32,9 @@ void Config::InitializeDefaults() {
   
   // System settings
   config_data_[ENABLE_LOGGING] = false;
-  config_data_[LOG_TIMEOUT_MS] = 1000;  // 1 second
+  config_data_[LOG_TIMEOUT_MS] = 200;  // like PostgreSQL's wal_writer_delay
   config_data_[CYCLE_DETECTION_INTERVAL_MS] = 50;
+  config_data_[SESSION_IDLE_TIMEOUT_MS] = 5 * 60 * 1000;  // 5 minutes
   
   // Memory and storage settings
   config_data_[PAGE_SIZE] = BUSTUB_PAGE_SIZE;  // Use the global constant
@@ -40,6 +42,9 @@ void Config::InitializeDefaults() {
   config_data_[LOG_BUFFER_SIZE] = ((10 + 1) * BUSTUB_PAGE_SIZE);  // Use the global constant
   config_data_[BUCKET_SIZE] = 50;
   config_data_[LRUK_REPLACER_K] = 10;
+  config_data_[LOG_SEGMENT_SIZE] = 4 * 1024 * 1024;  // 4 MiB per WAL segment
+  config_data_[MAX_RECYCLED_LOG_SEGMENTS] = 4;
+  config_data_[LOG_COMPRESSION] = false;  // LZ4-compress log blocks before they are written
   
   // Schema settings
   config_data_[VARCHAR_DEFAULT_LENGTH] = 128;
@@ -48,6 +53,7 @@ void Config::InitializeDefaults() {
   enable_logging.store(config_data_[ENABLE_LOGGING].get<bool>());
   log_timeout = std::chrono::milliseconds(config_data_[LOG_TIMEOUT_MS].get<int64_t>());
   cycle_detection_interval = std::chrono::milliseconds(config_data_[CYCLE_DETECTION_INTERVAL_MS].get<int64_t>());
+  session_idle_timeout = std::chrono::milliseconds(config_data_[SESSION_IDLE_TIMEOUT_MS].get<int64_t>());
 }
 
 bool Config::LoadFromFile(const std::string& config_file) {
@@ -64,6 +70,7 @@ bool Config::LoadFromFile(const std::string& config_file) {
     enable_logging.store(config_data_[ENABLE_LOGGING].get<bool>());
     log_timeout = std::chrono::milliseconds(config_data_[LOG_TIMEOUT_MS].get<int64_t>());
     cycle_detection_interval = std::chrono::milliseconds(config_data_[CYCLE_DETECTION_INTERVAL_MS].get<int64_t>());
+    session_idle_timeout = std::chrono::milliseconds(config_data_.value(SESSION_IDLE_TIMEOUT_MS, int64_t{5 * 60 * 1000}));
     
     return true;
   } catch (const std::exception& e) {
@@ -149,6 +156,8 @@ void Config::SetDuration(const std::string& key, int64_t value) {
     log_timeout = std::chrono::milliseconds(value);
   } else if (key == CYCLE_DETECTION_INTERVAL_MS) {
     cycle_detection_interval = std::chrono::milliseconds(value);
+  } else if (key == SESSION_IDLE_TIMEOUT_MS) {
+    session_idle_timeout = std::chrono::milliseconds(value);
   }
 }
 
@@ -1,7 +1,10 @@
+#include <filesystem>
 #include <optional>
+#include <random>
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
 
 #include "../include/binder/binder.h"
 #include "../include/binder/bound_expression.h"
@@ -13,6 +16,8 @@
 #include "../include/common/enums/statement_type.h"
 #include "../include/common/exception.h"
 #include "../include/common/util/string_util.h"
+#include "../include/concurrency/lock_manager.h"
+#include "../include/concurrency/transaction_manager.h"
 #include "../include/execution/execution_engine.h"
 #include "../include/execution/executor_context.h"
 #include "../include/execution/executors/mock_scan_executor.h"
@@ -22,6 +27,7 @@
 #include "fmt/format.h"
 #include "../include/optimizer/optimizer.h"
 #include "../include/planner/planner.h"
+#include "../include/recovery/backup_manager.h"
 #include "../include/recovery/checkpoint_manager.h"
 #include "../include/recovery/log_manager.h"
 #include "../include/storage/disk/disk_manager.h"
@@ -44,13 +50,16 @@ auto HMSSQL::UseDatabase(const std::string &db_name) -> bool {
 }
 
 HMSSQL::HMSSQL(const std::string &db_file_name) {
-  enable_logging = false;
+  enable_logging = GetEnableLogging();
 
   // Storage related.
   disk_manager_ = new DiskManager(db_file_name);
 
-  // Log related.
+  // Log related. The flush thread bounds how long an asynchronously committed statement stays in memory.
   log_manager_ = new LogManager(disk_manager_);
+  if (enable_logging) {
+    log_manager_->RunFlushThread();
+  }
 
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
@@ -64,6 +73,13 @@ HMSSQL::HMSSQL(const std::string &db_file_name) {
   // Checkpoint related.
   checkpoint_manager_ = new CheckpointManager(log_manager_, buffer_pool_manager_);
 
+  // Transaction related. Writers lock the rows they change, deadlocks are broken in the background.
+  lock_manager_ = new LockManager();
+  lock_manager_->StartDeadlockDetection();
+  txn_manager_ = new TransactionManager(log_manager_, lock_manager_);
+  backup_manager_ = new BackupManager(disk_manager_, log_manager_, buffer_pool_manager_, txn_manager_);
+  StartSessionReaper();
+
   current_database_ = "";
   databases_["default"] = std::unique_ptr<Catalog>(
     new Catalog(buffer_pool_manager_, log_manager_)
@@ -91,6 +107,11 @@ HMSSQL::HMSSQL() {
   // No checkpoint manager
   checkpoint_manager_ = nullptr;
 
+  lock_manager_ = new LockManager();
+  lock_manager_->StartDeadlockDetection();
+  txn_manager_ = new TransactionManager(log_manager_, lock_manager_);
+  StartSessionReaper();
+
   // Catalog without transaction support
   catalog_ = new Catalog(buffer_pool_manager_, log_manager_);
 
@@ -117,6 +138,11 @@ HMSSQL::HMSSQL(const std::string& db_file, bool enable_logging) {
       LRUK_REPLACER_K,
       log_manager_
   );
+
+  lock_manager_ = new LockManager();
+  lock_manager_->StartDeadlockDetection();
+  txn_manager_ = new TransactionManager(log_manager_, lock_manager_);
+  StartSessionReaper();
 }
 
 void HMSSQL::CmdDisplayTables(ResultWriter &writer) {
@@ -209,8 +235,17 @@ void HMSSQL::CmdDisplayHelp(ResultWriter &writer) {
 \di: show all indices
 \save: save current database state
 \checkpoint: perform manual checkpoint
+\backup <dir>: take an online backup into <dir>, restore it with --restore <dir>
 \help: show this message again
 
+Every statement runs in a transaction of its own unless BEGIN opened one, which
+lasts until COMMIT or ROLLBACK. Transactions read a snapshot of the database as
+of their start. Writers lock the rows they change until they finish: a second
+writer of a row waits, and is rolled back if the first one commits. Deadlocks
+roll back the youngest transaction involved. With
+SET concurrency_control = optimistic no rows are locked; instead the rows read
+are checked at COMMIT and the transaction rolls back if one was changed.
+
 HMSSQL shell currently only supports a small set of Postgres queries. We'll set
 up a doc describing the current status later. It will silently ignore some parts
 of the query, so it's normal that you'll get a wrong result when executing
@@ -222,12 +257,233 @@ see the execution plan of your query.
   WriteOneCell(help, writer);
 }
 
-auto HMSSQL::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
-  auto result = ExecuteSqlTxn(sql, writer);
+void HMSSQL::CmdBackup(const std::string &backup_dir, ResultWriter &writer, Transaction *txn) {
+  if (backup_manager_ == nullptr) {
+    throw Exception("backup needs a database file, this instance keeps its pages in memory");
+  }
+  // The backup waits for the transactions that wrote before it started
+  if (txn != nullptr) {
+    throw Exception("\\backup can't run inside a transaction, COMMIT or ROLLBACK first");
+  }
+  auto manifest = backup_manager_->Backup(backup_dir);
+  // The catalog lives in the state file, it goes along with the pages
+  std::error_code ec;
+  if (std::filesystem::exists(state_file_, ec)) {
+    std::filesystem::copy_file(state_file_, std::filesystem::path(backup_dir) / state_file_,
+                               std::filesystem::copy_options::overwrite_existing, ec);
+  }
+  WriteOneCell(fmt::format("Backup written to {}: {} pages, {} bytes of WAL, consistent at LSN {}", backup_dir,
+                           manifest.page_count_, manifest.end_offset_ - manifest.start_offset_, manifest.end_lsn_),
+               writer);
+}
+
+void HMSSQL::RestoreBackup(const std::string &backup_dir, const std::string &db_file) {
+  BackupManager::Restore(backup_dir, db_file);
+  std::error_code ec;
+  auto saved_state = std::filesystem::path(backup_dir) / STATE_FILE;
+  if (std::filesystem::exists(saved_state, ec)) {
+    std::filesystem::copy_file(saved_state, STATE_FILE, std::filesystem::copy_options::overwrite_existing, ec);
+  }
+}
+
+auto HMSSQL::ExecuteSql(const std::string &sql, ResultWriter &writer, std::string *session) -> bool {
+  auto result = ExecuteSqlStatement(sql, writer, nullptr, session);
   return result;
 }
 
-auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -> bool {
+void HMSSQL::CmdTransaction(TransactionStatementKind kind, ResultWriter &writer, std::string *session) {
+  if (session == nullptr) {
+    throw Exception("this client has no session, BEGIN, COMMIT and ROLLBACK are not available");
+  }
+  Transaction *txn = nullptr;
+  auto concurrency_control = GetConcurrencyControl(session);
+  {
+    std::scoped_lock<std::mutex> lock(session_latch_);
+    auto it = session->empty() ? sessions_.end() : sessions_.find(*session);
+    if (kind == TransactionStatementKind::BEGIN) {
+      if (it == sessions_.end()) {
+        // Busy until the statement that opened it returns
+        auto session_id = NewSessionId();
+        it = sessions_.emplace(session_id, Session{nullptr, std::chrono::steady_clock::now(), true, {}}).first;
+        *session = std::move(session_id);
+      } else if (it->second.txn_ != nullptr) {
+        throw Exception("there is already a transaction in progress");
+      }
+      it->second.txn_ = txn_manager_->Begin(concurrency_control);
+      WriteOneCell("BEGIN", writer);
+      return;
+    }
+    if (it == sessions_.end() || it->second.txn_ == nullptr) {
+      throw Exception("there is no transaction in progress");
+    }
+    txn = std::exchange(it->second.txn_, nullptr);
+  }
+  if (kind == TransactionStatementKind::COMMIT) {
+    if (!txn_manager_->Commit(txn, IsSynchronousCommit(session))) {
+      throw Exception("a row the transaction read was changed concurrently, the transaction was rolled back");
+    }
+    WriteOneCell("COMMIT", writer);
+  } else {
+    txn_manager_->Abort(txn);
+    WriteOneCell("ROLLBACK", writer);
+  }
+}
+
+auto HMSSQL::NewSessionId() -> std::string {
+  std::random_device random;
+  std::uniform_int_distribution<uint64_t> bits;
+  return fmt::format("{:016x}{:016x}", bits(random), bits(random));
+}
+
+void HMSSQL::AcquireSession(std::string *session) {
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  auto it = sessions_.find(*session);
+  if (it == sessions_.end()) {
+    session->clear();
+    throw Exception("the session does not exist, it ended or was rolled back after being idle too long");
+  }
+  if (it->second.busy_) {
+    throw Exception("the session is running another statement");
+  }
+  it->second.busy_ = true;
+}
+
+auto HMSSQL::GetSessionVariable(const std::string *session, const std::string &key) -> std::string {
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  const auto *variables = &session_variables_;
+  if (session != nullptr && !session->empty()) {
+    auto it = sessions_.find(*session);
+    if (it == sessions_.end()) {
+      return "";
+    }
+    variables = &it->second.variables_;
+  }
+  auto it = variables->find(key);
+  return it == variables->end() ? "" : it->second;
+}
+
+void HMSSQL::SetSessionVariable(std::string *session, const std::string &key, const std::string &value) {
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  if (session == nullptr) {
+    session_variables_[key] = value;
+    return;
+  }
+  auto it = session->empty() ? sessions_.end() : sessions_.find(*session);
+  if (it == sessions_.end()) {
+    // Busy until the statement that opened it returns
+    auto session_id = NewSessionId();
+    it = sessions_.emplace(session_id, Session{nullptr, std::chrono::steady_clock::now(), true, {}}).first;
+    *session = std::move(session_id);
+  }
+  it->second.variables_[key] = value;
+}
+
+void HMSSQL::ReleaseSession(const std::string &session_id) {
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  auto it = sessions_.find(session_id);
+  if (it != sessions_.end()) {
+    it->second.busy_ = false;
+    it->second.last_used_ = std::chrono::steady_clock::now();
+  }
+}
+
+auto HMSSQL::GetSessionTransaction(const std::string *session) -> Transaction * {
+  if (session == nullptr || session->empty()) {
+    return nullptr;
+  }
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  auto it = sessions_.find(*session);
+  return it == sessions_.end() ? nullptr : it->second.txn_;
+}
+
+void HMSSQL::AbortSessionTransaction(std::string *session) {
+  if (session == nullptr || session->empty()) {
+    return;
+  }
+  Transaction *txn;
+  {
+    std::scoped_lock<std::mutex> lock(session_latch_);
+    auto it = sessions_.find(*session);
+    if (it == sessions_.end() || it->second.txn_ == nullptr) {
+      return;
+    }
+    txn = std::exchange(it->second.txn_, nullptr);
+  }
+  txn_manager_->Abort(txn);
+}
+
+void HMSSQL::StartSessionReaper() {
+  std::scoped_lock<std::mutex> lock(session_latch_);
+  if (reap_sessions_) {
+    return;
+  }
+  reap_sessions_ = true;
+  session_reaper_ = std::thread([this] {
+    std::unique_lock<std::mutex> lock(session_latch_);
+    while (reap_sessions_) {
+      // A session is rolled back at most a quarter of the timeout after it expired
+      auto interval = session_idle_timeout.count() > 0
+                          ? std::max(session_idle_timeout / 4, std::chrono::milliseconds(100))
+                          : std::chrono::milliseconds(1000);
+      session_cv_.wait_for(lock, interval);
+      if (!reap_sessions_) {
+        break;
+      }
+      lock.unlock();
+      ReapIdleSessions();
+      lock.lock();
+    }
+  });
+}
+
+void HMSSQL::StopSessionReaper() {
+  {
+    std::scoped_lock<std::mutex> lock(session_latch_);
+    reap_sessions_ = false;
+  }
+  session_cv_.notify_all();
+  if (session_reaper_.joinable()) {
+    session_reaper_.join();
+  }
+  // Transactions that are still open were never committed
+  for (const auto &[session_id, session] : sessions_) {
+    if (session.txn_ != nullptr) {
+      txn_manager_->Abort(session.txn_);
+    }
+  }
+  sessions_.clear();
+}
+
+void HMSSQL::ReapIdleSessions() {
+  auto timeout = session_idle_timeout;
+  if (timeout.count() <= 0) {
+    return;
+  }
+  std::vector<Transaction *> idle;
+  {
+    std::scoped_lock<std::mutex> lock(session_latch_);
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+      if (!it->second.busy_ && now - it->second.last_used_ > timeout) {
+        if (it->second.txn_ != nullptr) {
+          idle.push_back(it->second.txn_);
+        }
+        it = sessions_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // Orphaned by a client that went away, they would hold their locks and pin the versions they can see forever
+  for (auto *txn : idle) {
+    spdlog::warn("Transaction {} was idle for longer than {} ms and is rolled back", txn->GetTransactionId(),
+                 timeout.count());
+    txn_manager_->Abort(txn);
+  }
+}
+
+auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer, Transaction *txn,
+                                 std::string *session) -> bool {
   std::string lower_sql = StringUtil::Lower(sql);
 
   if (!sql.empty() && sql[0] == '\\') {
@@ -268,6 +524,15 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
         }
     }
 
+    if (StringUtil::StartsWith(sql, "\\backup")) {
+      auto backup_dir = StringUtil::Trim(sql.substr(std::string("\\backup").size()));
+      if (backup_dir.empty()) {
+        throw Exception("usage: \\backup <dir>");
+      }
+      CmdBackup(backup_dir, writer, txn != nullptr ? txn : GetSessionTransaction(session));
+      return true;
+    }
+
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
@@ -283,6 +548,28 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
     throw Exception("No database selected. Use 'USE database_name' to select a database.");
   }
 
+  // The statements run in the transaction of the session, it stays busy until they return. A BEGIN or SET among them
+  // opens a session busy already.
+  if (txn != nullptr) {
+    session = nullptr;
+  } else if (session != nullptr && !session->empty()) {
+    try {
+      AcquireSession(session);
+    } catch (const Exception &e) {
+      WriteOneCell(fmt::format("SQL error: {}", e.what()), writer);
+      return false;
+    }
+  }
+  struct SessionRelease {
+    HMSSQL *db_;
+    std::string *session_;
+    ~SessionRelease() {
+      if (session_ != nullptr && !session_->empty()) {
+        db_->ReleaseSession(*session_);
+      }
+    }
+  } release{this, session};
+
   bool is_successful = true;
   try {
     std::shared_lock<std::shared_mutex> l(catalog_lock_);
@@ -348,11 +635,36 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
         }
         auto key_schema = Schema::CopySchema(&index_stmt.table_->schema_, col_ids);
 
-        std::unique_lock<std::shared_mutex> l(catalog_lock_);
-        auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-            index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
-            INTEGER_SIZE, IntegerHashFunctionType{});
-        l.unlock();
+        // Writers hold IX on the table until they finish, under S the index is built from committed rows only
+        Transaction *index_txn = txn != nullptr ? txn : GetSessionTransaction(session);
+        bool autocommit = index_txn == nullptr;
+        if (autocommit) {
+          index_txn = txn_manager_->Begin();
+        }
+        if (!lock_manager_->LockTable(index_txn, LockMode::SHARED, index_stmt.table_->oid_)) {
+          if (autocommit) {
+            txn_manager_->Abort(index_txn);
+          } else if (txn == nullptr) {
+            AbortSessionTransaction(session);
+          }
+          throw Exception(fmt::format("deadlock detected while locking table {}", index_stmt.table_->table_));
+        }
+
+        IndexInfo *info;
+        try {
+          std::unique_lock<std::shared_mutex> l(catalog_lock_);
+          info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+              index_stmt.index_name_, index_stmt.table_->table_, index_stmt.table_->schema_, key_schema, col_ids,
+              INTEGER_SIZE, IntegerHashFunctionType{});
+        } catch (...) {
+          if (autocommit) {
+            txn_manager_->Abort(index_txn);
+          }
+          throw;
+        }
+        if (autocommit) {
+          txn_manager_->Commit(index_txn, IsSynchronousCommit(session));
+        }
 
         if (info == nullptr) {
           throw hmssql::Exception("Failed to create index");
@@ -363,17 +675,25 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
 
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
-        auto content = GetSessionVariable(show_stmt.variable_);
+        auto content = GetSessionVariable(session, show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
 
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
-        session_variables_[set_stmt.variable_] = set_stmt.value_;
+        SetSessionVariable(session, set_stmt.variable_, set_stmt.value_);
         continue;
       }
       
+      case StatementType::TRANSACTION_STATEMENT: {
+        if (txn != nullptr) {
+          throw Exception("the transaction is managed by the caller, BEGIN, COMMIT and ROLLBACK are not allowed");
+        }
+        CmdTransaction(dynamic_cast<const TransactionStatement &>(*statement).kind_, writer, session);
+        continue;
+      }
+
       case StatementType::EXPLAIN_STATEMENT: {
         const auto &explain_stmt = dynamic_cast<const ExplainStatement &>(*statement);
         std::string output;
@@ -402,7 +722,8 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
         }
 
         // Print optimizer result.
-        hmssql::Optimizer optimizer(*catalog_, IsForceStarterRule());
+        hmssql::Optimizer optimizer(*catalog_, IsForceStarterRule(session), GetMaxParallelWorkers(session),
+                                    GetWorkMem(session));
         auto optimized_plan = optimizer.Optimize(planner.plan_);
 
         l.unlock();
@@ -433,7 +754,8 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
         }
 
         // Optimize the query
-        hmssql::Optimizer optimizer(*catalog_, IsForceStarterRule());
+        hmssql::Optimizer optimizer(*catalog_, IsForceStarterRule(session), GetMaxParallelWorkers(session),
+                                    GetWorkMem(session));
         AbstractPlanNodeRef optimized_plan;
         try {
           optimized_plan = optimizer.Optimize(planner.plan_);
@@ -443,18 +765,43 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
 
         l.unlock();
 
-        // Execute the query
-        auto exec_ctx = MakeExecutorContext();
+        // Execute the query, outside of BEGIN ... COMMIT the statement commits on its own
+        Transaction *stmt_txn = txn != nullptr ? txn : GetSessionTransaction(session);
+        bool autocommit = stmt_txn == nullptr;
+        if (autocommit) {
+          stmt_txn = txn_manager_->Begin(GetConcurrencyControl(session));
+        }
+        // A statement that failed half way may have written some rows, none of the transaction survives it. Whatever
+        // the statement throws, be it bad_alloc or an error from a library, its transaction is rolled back first.
+        auto abort_statement = [&]() -> std::string {
+          if (autocommit) {
+            txn_manager_->Abort(stmt_txn);
+          } else if (txn == nullptr) {
+            AbortSessionTransaction(session);
+            return ", the transaction was rolled back";
+          }
+          return "";
+        };
+        std::unique_ptr<ExecutorContext> exec_ctx;
         std::vector<Tuple> result_set{};
         bool exec_success = false;
         try {
+          exec_ctx = MakeExecutorContext(stmt_txn, session);
           exec_success = execution_engine_->Execute(optimized_plan, &result_set, exec_ctx.get());
         } catch (const Exception &e) {
-          throw Exception(fmt::format("Execution error: {}", e.what()));
+          auto note = abort_statement();
+          throw Exception(fmt::format("Execution error: {}{}", e.what(), note));
+        } catch (...) {
+          abort_statement();
+          throw;
         }
-        
+
         is_successful &= exec_success;
 
+        if (autocommit && !txn_manager_->Commit(stmt_txn, IsSynchronousCommit(session))) {
+          throw Exception("Execution error: a row the statement read was changed by a concurrent transaction");
+        }
+
         // Return the result set
         auto schema = planner.plan_->OutputSchema();
 
@@ -494,12 +841,16 @@ auto HMSSQL::ExecuteSqlStatement(const std::string &sql, ResultWriter &writer) -
   return is_successful;
 }
 
-auto HMSSQL::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer) -> bool {
-  return ExecuteSqlStatement(sql, writer);
+auto HMSSQL::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer, Transaction *txn) -> bool {
+  return ExecuteSqlStatement(sql, writer, txn);
 }
 
-auto HMSSQL::MakeExecutorContext() -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(catalog_, buffer_pool_manager_);
+auto HMSSQL::MakeExecutorContext(Transaction *txn, const std::string *session) -> std::unique_ptr<ExecutorContext> {
+  auto *thread_pool = execution_engine_ != nullptr ? execution_engine_->GetThreadPool() : nullptr;
+  auto exec_ctx =
+      std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, lock_manager_, thread_pool);
+  exec_ctx->SetWorkMem(GetWorkMem(session));
+  return exec_ctx;
 }
 
 #ifndef ISDEBUG
@@ -510,7 +861,7 @@ auto HMSSQL::MakeExecutorContext() -> std::unique_ptr<ExecutorContext> {
  * create / drop table and insert for now. Should remove it in the future.
  */
 void HMSSQL::GenerateTestTable() {
-  auto exec_ctx = MakeExecutorContext();
+  auto exec_ctx = MakeExecutorContext(nullptr);
   TableGenerator gen{exec_ctx.get()};
 
   std::shared_lock<std::shared_mutex> l(catalog_lock_);
@@ -529,6 +880,11 @@ void HMSSQL::GenerateMockTable() {
 #endif
 
 HMSSQL::~HMSSQL() {
+  // Transactions that are still open were never committed
+  if (txn_manager_ != nullptr) {
+    StopSessionReaper();
+  }
+
   // Try to save state, but avoid exceptions during destruction
   try {
     if (checkpoint_manager_ != nullptr) {
@@ -565,6 +921,21 @@ HMSSQL::~HMSSQL() {
     delete checkpoint_manager_;
     checkpoint_manager_ = nullptr;
   }
+
+  if (backup_manager_ != nullptr) {
+    delete backup_manager_;
+    backup_manager_ = nullptr;
+  }
+
+  if (txn_manager_ != nullptr) {
+    delete txn_manager_;
+    txn_manager_ = nullptr;
+  }
+
+  if (lock_manager_ != nullptr) {
+    delete lock_manager_;
+    lock_manager_ = nullptr;
+  }
   
   if (log_manager_ != nullptr) {
     delete log_manager_;
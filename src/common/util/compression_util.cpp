@@ -0,0 +1,186 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// compression_util.cpp
+//
+// Identification: src/common/util/compression_util.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/common/util/compression_util.h"
+
+#include <cstring>
+#include <vector>
+
+namespace hmssql {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+// the last match must start at least this many bytes before the end of the block
+constexpr size_t MATCH_FIND_LIMIT = 12;
+// the last bytes of a block are always literals
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_LOG = 12;
+
+inline auto Read32(const char *p) -> uint32_t {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline auto Hash32(uint32_t v) -> uint32_t { return (v * 2654435761U) >> (32 - HASH_LOG); }
+
+/** Write the extra length bytes of a literal or match length that did not fit into its nibble. */
+inline auto WriteLength(size_t length, char *op, const char *op_end) -> char * {
+  while (length >= 255) {
+    if (op >= op_end) {
+      return nullptr;
+    }
+    *op++ = static_cast<char>(255);
+    length -= 255;
+  }
+  if (op >= op_end) {
+    return nullptr;
+  }
+  *op++ = static_cast<char>(length);
+  return op;
+}
+
+/** Emit one sequence: token, literals and, unless this is the last sequence, the match. */
+auto WriteSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, char *op,
+                   const char *op_end) -> char * {
+  if (op >= op_end) {
+    return nullptr;
+  }
+  char *token = op++;
+  uint8_t token_value = literal_length >= 15 ? 0xF0 : static_cast<uint8_t>(literal_length << 4);
+  if (literal_length >= 15 && (op = WriteLength(literal_length - 15, op, op_end)) == nullptr) {
+    return nullptr;
+  }
+  if (op + literal_length > op_end) {
+    return nullptr;
+  }
+  memcpy(op, literals, literal_length);
+  op += literal_length;
+  if (match_length == 0) {
+    *token = static_cast<char>(token_value);
+    return op;
+  }
+
+  if (op + 2 > op_end) {
+    return nullptr;
+  }
+  *op++ = static_cast<char>(offset & 0xFF);
+  *op++ = static_cast<char>(offset >> 8);
+  size_t extra = match_length - MIN_MATCH;
+  token_value |= extra >= 15 ? 0x0F : static_cast<uint8_t>(extra);
+  if (extra >= 15 && (op = WriteLength(extra - 15, op, op_end)) == nullptr) {
+    return nullptr;
+  }
+  *token = static_cast<char>(token_value);
+  return op;
+}
+
+}  // namespace
+
+auto CompressionUtil::Compress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> size_t {
+  const char *op_end = dst + dst_capacity;
+  char *op = dst;
+  size_t anchor = 0;
+
+  if (src_size > MATCH_FIND_LIMIT) {
+    std::vector<int32_t> table(1 << HASH_LOG, -1);
+    size_t match_limit = src_size - MATCH_FIND_LIMIT;
+    size_t ip = 0;
+    while (ip < match_limit) {
+      uint32_t sequence = Read32(src + ip);
+      uint32_t h = Hash32(sequence);
+      int32_t ref = table[h];
+      table[h] = static_cast<int32_t>(ip);
+      if (ref < 0 || ip - ref > MAX_OFFSET || Read32(src + ref) != sequence) {
+        ip++;
+        continue;
+      }
+      size_t match_length = MIN_MATCH;
+      while (ip + match_length < src_size - LAST_LITERALS && src[ref + match_length] == src[ip + match_length]) {
+        match_length++;
+      }
+      op = WriteSequence(src + anchor, ip - anchor, ip - ref, match_length, op, op_end);
+      if (op == nullptr) {
+        return 0;
+      }
+      ip += match_length;
+      anchor = ip;
+    }
+  }
+
+  op = WriteSequence(src + anchor, src_size - anchor, 0, 0, op, op_end);
+  if (op == nullptr) {
+    return 0;
+  }
+  return op - dst;
+}
+
+auto CompressionUtil::Decompress(const char *src, size_t src_size, char *dst, size_t dst_capacity) -> int64_t {
+  const auto *ip = reinterpret_cast<const uint8_t *>(src);
+  const auto *ip_end = ip + src_size;
+  char *op = dst;
+  char *op_end = dst + dst_capacity;
+
+  while (ip < ip_end) {
+    uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end) {
+          return -1;
+        }
+        b = *ip++;
+        literal_length += b;
+      } while (b == 255);
+    }
+    if (ip + literal_length > ip_end || op + literal_length > op_end) {
+      return -1;
+    }
+    memcpy(op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == ip_end) {
+      break;  // the last sequence has no match
+    }
+
+    if (ip + 2 > ip_end) {
+      return -1;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15) {
+      uint8_t b;
+      do {
+        if (ip >= ip_end) {
+          return -1;
+        }
+        b = *ip++;
+        match_length += b;
+      } while (b == 255);
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<size_t>(op - dst) || op + match_length > op_end) {
+      return -1;
+    }
+    // byte by byte, the match may overlap the bytes it produces
+    const char *match = op - offset;
+    for (size_t i = 0; i < match_length; i++) {
+      *op++ = match[i];
+    }
+  }
+  return op - dst;
+}
+
+}  // namespace hmssql
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// like_matcher.cpp
+//
+// Identification: src/common/util/like_matcher.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/common/util/like_matcher.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace hmssql {
+
+LikeMatcher::LikeMatcher(const std::string &pattern) {
+  size_t start = 0;
+  while (true) {
+    auto percent = pattern.find('%', start);
+    auto text = pattern.substr(start, percent == std::string::npos ? std::string::npos : percent - start);
+    // Empty segments between two % match anywhere, only the first and the last one anchor the match
+    if (!text.empty() || segments_.empty() || percent == std::string::npos) {
+      segments_.push_back(Segment{text, text.find('_') != std::string::npos});
+    }
+    if (percent == std::string::npos) {
+      break;
+    }
+    start = percent + 1;
+  }
+}
+
+auto LikeMatcher::Match(const char *data, size_t length) const -> bool {
+  const auto &first = segments_.front();
+  if (segments_.size() == 1) {
+    return length == first.text_.size() && first.MatchesAt(data);
+  }
+  const auto &last = segments_.back();
+  if (length < first.text_.size() + last.text_.size() || !first.MatchesAt(data) ||
+      !last.MatchesAt(data + length - last.text_.size())) {
+    return false;
+  }
+  // Taking every segment between at its leftmost match leaves the most room to those after it
+  size_t pos = first.text_.size();
+  size_t end = length - last.text_.size();
+  for (size_t i = 1; i + 1 < segments_.size(); i++) {
+    pos = segments_[i].Find(data, pos, end);
+    if (pos == std::string::npos) {
+      return false;
+    }
+    pos += segments_[i].text_.size();
+  }
+  return true;
+}
+
+auto LikeMatcher::Segment::MatchesAt(const char *data) const -> bool {
+  if (!has_any_) {
+    return memcmp(data, text_.data(), text_.size()) == 0;
+  }
+  for (size_t i = 0; i < text_.size(); i++) {
+    if (text_[i] != '_' && text_[i] != data[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto LikeMatcher::Segment::Find(const char *data, size_t from, size_t end) const -> size_t {
+  if (end < from + text_.size()) {
+    return std::string::npos;
+  }
+  if (!has_any_) {
+    // The search of string_view skips to the candidates with memchr on the first character
+    auto pos = std::string_view(data, end).find(text_, from);
+    return pos == std::string_view::npos ? std::string::npos : pos;
+  }
+  for (size_t pos = from; pos + text_.size() <= end; pos++) {
+    if (MatchesAt(data + pos)) {
+      return pos;
+    }
+  }
+  return std::string::npos;
+}
+
+}  // namespace hmssql
@@ -0,0 +1,426 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// lock_manager.cpp
+//
+// Identification: src/concurrency/lock_manager.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/concurrency/lock_manager.h"
+
+#include <algorithm>
+
+#include "../include/common/exception.h"
+#include "../third_party/spdlog/spdlog.h"
+#include "fmt/format.h"
+
+namespace hmssql {
+
+void LockManager::StartDeadlockDetection() {
+  std::scoped_lock<std::mutex> lock(detection_latch_);
+  if (enable_cycle_detection_) {
+    return;
+  }
+  enable_cycle_detection_ = true;
+  cycle_detection_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(detection_latch_);
+    while (enable_cycle_detection_) {
+      detection_cv_.wait_for(lock, cycle_detection_interval);
+      if (!enable_cycle_detection_) {
+        break;
+      }
+      lock.unlock();
+      DetectDeadlocks();
+      lock.lock();
+    }
+  });
+}
+
+void LockManager::StopDeadlockDetection() {
+  {
+    std::scoped_lock<std::mutex> lock(detection_latch_);
+    if (!enable_cycle_detection_) {
+      return;
+    }
+    enable_cycle_detection_ = false;
+  }
+  detection_cv_.notify_all();
+  if (cycle_detection_thread_ != nullptr && cycle_detection_thread_->joinable()) {
+    cycle_detection_thread_->join();
+  }
+  delete cycle_detection_thread_;
+  cycle_detection_thread_ = nullptr;
+}
+
+auto LockManager::Covers(LockMode held, LockMode wanted) -> bool {
+  switch (held) {
+    case LockMode::EXCLUSIVE:
+      return true;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return wanted != LockMode::EXCLUSIVE;
+    case LockMode::SHARED:
+      return wanted == LockMode::SHARED || wanted == LockMode::INTENTION_SHARED;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return wanted == LockMode::INTENTION_EXCLUSIVE || wanted == LockMode::INTENTION_SHARED;
+    case LockMode::INTENTION_SHARED:
+      return wanted == LockMode::INTENTION_SHARED;
+  }
+  return false;
+}
+
+auto LockManager::AreCompatible(LockMode a, LockMode b) -> bool {
+  if (a == LockMode::EXCLUSIVE || b == LockMode::EXCLUSIVE) {
+    return false;
+  }
+  if (a == LockMode::INTENTION_SHARED || b == LockMode::INTENTION_SHARED) {
+    return true;
+  }
+  if (a == LockMode::SHARED_INTENTION_EXCLUSIVE || b == LockMode::SHARED_INTENTION_EXCLUSIVE) {
+    return false;
+  }
+  // Left are S and IX, each is compatible with itself only
+  return a == b;
+}
+
+auto LockManager::Supremum(LockMode a, LockMode b) -> LockMode {
+  if (Covers(a, b)) {
+    return a;
+  }
+  if (Covers(b, a)) {
+    return b;
+  }
+  // S and IX
+  return LockMode::SHARED_INTENTION_EXCLUSIVE;
+}
+
+auto LockManager::LatchTableQueue(table_oid_t oid, std::unique_lock<std::mutex> *lock)
+    -> std::shared_ptr<LockRequestQueue> {
+  std::shared_ptr<LockRequestQueue> queue;
+  {
+    std::scoped_lock<std::mutex> map_lock(table_lock_map_latch_);
+    auto &entry = table_lock_map_[oid];
+    if (entry == nullptr) {
+      entry = std::make_shared<LockRequestQueue>();
+    }
+    queue = entry;
+  }
+  *lock = std::unique_lock<std::mutex>(queue->latch_);
+  return queue;
+}
+
+auto LockManager::LatchRowQueue(const RID &rid, std::unique_lock<std::mutex> *lock)
+    -> std::shared_ptr<LockRequestQueue> {
+  std::scoped_lock<std::mutex> map_lock(row_lock_map_latch_);
+  auto &entry = row_lock_map_[rid];
+  if (entry == nullptr) {
+    entry = std::make_shared<LockRequestQueue>();
+  }
+  *lock = std::unique_lock<std::mutex>(entry->latch_);
+  return entry;
+}
+
+void LockManager::EraseRowQueueIfEmpty(const RID &rid) {
+  std::scoped_lock<std::mutex> map_lock(row_lock_map_latch_);
+  auto it = row_lock_map_.find(rid);
+  if (it == row_lock_map_.end()) {
+    return;
+  }
+  // A request is queued under the map latch, so nobody can be about to use an empty queue
+  std::scoped_lock<std::mutex> lock(it->second->latch_);
+  if (it->second->request_queue_.empty()) {
+    row_lock_map_.erase(it);
+  }
+}
+
+auto LockManager::Grantable(const LockRequestQueue &queue, const LockRequest *request) -> bool {
+  for (const auto &other : queue.request_queue_) {
+    if (other.get() == request) {
+      return true;
+    }
+    if (!other->granted_ || !AreCompatible(other->lock_mode_, request->lock_mode_)) {
+      return false;
+    }
+  }
+  return false;
+}
+
+auto LockManager::Acquire(LockRequestQueue *queue, std::unique_lock<std::mutex> *lock, Transaction *txn,
+                          LockMode lock_mode, const LockMode *held) -> bool {
+  auto request = std::make_shared<LockRequest>(txn, lock_mode);
+  if (held != nullptr) {
+    // Two upgrades on the same resource wait for each other to give up the lock they hold
+    if (queue->upgrading_ != INVALID_TXN_ID) {
+      txn->state_ = TransactionState::TAINTED;
+      return false;
+    }
+    queue->request_queue_.remove_if([txn](const auto &other) { return other->txn_ == txn; });
+    auto first_waiting = std::find_if(queue->request_queue_.begin(), queue->request_queue_.end(),
+                                      [](const auto &other) { return !other->granted_; });
+    queue->request_queue_.insert(first_waiting, request);
+    queue->upgrading_ = txn->GetTransactionId();
+  } else {
+    queue->request_queue_.push_back(request);
+  }
+
+  while (txn->state_ == TransactionState::RUNNING && !Grantable(*queue, request.get())) {
+    queue->cv_.wait(*lock);
+  }
+  if (held != nullptr) {
+    queue->upgrading_ = INVALID_TXN_ID;
+  }
+  if (txn->state_ != TransactionState::RUNNING) {
+    // Chosen to break a deadlock. Nothing behind a pending upgrade is granted, so the lock held before is still
+    // compatible with the granted ones and can be put back.
+    if (held != nullptr) {
+      request->lock_mode_ = *held;
+      request->granted_ = true;
+    } else {
+      queue->request_queue_.remove(request);
+    }
+    queue->cv_.notify_all();
+    return false;
+  }
+  request->granted_ = true;
+  // Compatible requests queued behind this one may go ahead now
+  queue->cv_.notify_all();
+  return true;
+}
+
+void LockManager::Release(LockRequestQueue *queue, Transaction *txn) {
+  queue->request_queue_.remove_if([txn](const auto &other) { return other->txn_ == txn; });
+  queue->cv_.notify_all();
+}
+
+auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, table_oid_t oid) -> bool {
+  if (txn->state_ != TransactionState::RUNNING) {
+    return false;
+  }
+  auto held = txn->table_locks_.find(oid);
+  LockMode held_mode{};
+  if (held != txn->table_locks_.end()) {
+    if (Covers(held->second, lock_mode)) {
+      return true;
+    }
+    held_mode = held->second;
+    lock_mode = Supremum(held_mode, lock_mode);
+  }
+  bool upgrade = held != txn->table_locks_.end();
+
+  std::unique_lock<std::mutex> lock;
+  auto queue = LatchTableQueue(oid, &lock);
+  if (!Acquire(queue.get(), &lock, txn, lock_mode, upgrade ? &held_mode : nullptr)) {
+    return false;
+  }
+  txn->table_locks_[oid] = lock_mode;
+  return true;
+}
+
+auto LockManager::UnlockTable(Transaction *txn, table_oid_t oid) -> bool {
+  if (txn->table_locks_.find(oid) == txn->table_locks_.end()) {
+    return false;
+  }
+  auto rows = txn->row_locks_.find(oid);
+  if (rows != txn->row_locks_.end() && !rows->second.empty()) {
+    throw Exception(fmt::format("can't unlock table {} before its rows", oid));
+  }
+  std::unique_lock<std::mutex> lock;
+  auto queue = LatchTableQueue(oid, &lock);
+  Release(queue.get(), txn);
+  txn->table_locks_.erase(oid);
+  return true;
+}
+
+auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid) -> bool {
+  if (lock_mode != LockMode::SHARED && lock_mode != LockMode::EXCLUSIVE) {
+    throw Exception("rows can only be locked SHARED or EXCLUSIVE");
+  }
+  if (txn->state_ != TransactionState::RUNNING) {
+    return false;
+  }
+  auto table_lock = txn->table_locks_.find(oid);
+  bool permitted = table_lock != txn->table_locks_.end() &&
+                   (lock_mode == LockMode::SHARED || Covers(table_lock->second, LockMode::INTENTION_EXCLUSIVE));
+  if (!permitted) {
+    throw Exception(fmt::format("row {} is locked without a matching lock on table {}", rid.ToString(), oid));
+  }
+  if (Covers(table_lock->second, lock_mode)) {
+    return true;
+  }
+  auto &rows = txn->row_locks_[oid];
+  auto held = rows.find(rid);
+  LockMode held_mode{};
+  if (held != rows.end()) {
+    if (Covers(held->second, lock_mode)) {
+      return true;
+    }
+    held_mode = held->second;
+  }
+  bool upgrade = held != rows.end();
+
+  bool granted;
+  {
+    std::unique_lock<std::mutex> lock;
+    auto queue = LatchRowQueue(rid, &lock);
+    granted = Acquire(queue.get(), &lock, txn, lock_mode, upgrade ? &held_mode : nullptr);
+  }
+  if (!granted) {
+    EraseRowQueueIfEmpty(rid);
+    return false;
+  }
+  rows[rid] = lock_mode;
+  return true;
+}
+
+auto LockManager::UnlockRow(Transaction *txn, table_oid_t oid, const RID &rid) -> bool {
+  auto rows = txn->row_locks_.find(oid);
+  if (rows == txn->row_locks_.end() || rows->second.erase(rid) == 0) {
+    return false;
+  }
+  {
+    std::unique_lock<std::mutex> lock;
+    auto queue = LatchRowQueue(rid, &lock);
+    Release(queue.get(), txn);
+  }
+  EraseRowQueueIfEmpty(rid);
+  return true;
+}
+
+void LockManager::UnlockAll(Transaction *txn) {
+  for (const auto &[oid, rows] : txn->row_locks_) {
+    for (const auto &[rid, lock_mode] : rows) {
+      {
+        std::unique_lock<std::mutex> lock;
+        auto queue = LatchRowQueue(rid, &lock);
+        Release(queue.get(), txn);
+      }
+      EraseRowQueueIfEmpty(rid);
+    }
+  }
+  txn->row_locks_.clear();
+  for (const auto &[oid, lock_mode] : txn->table_locks_) {
+    std::unique_lock<std::mutex> lock;
+    auto queue = LatchTableQueue(oid, &lock);
+    Release(queue.get(), txn);
+  }
+  txn->table_locks_.clear();
+}
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) { waits_for_[t1].insert(t2); }
+
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  auto it = waits_for_.find(t1);
+  if (it == waits_for_.end()) {
+    return;
+  }
+  it->second.erase(t2);
+  if (it->second.empty()) {
+    waits_for_.erase(it);
+  }
+}
+
+auto LockManager::FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *path, std::set<txn_id_t> *visited,
+                            txn_id_t *victim) -> bool {
+  path->push_back(txn_id);
+  auto edges = waits_for_.find(txn_id);
+  if (edges != waits_for_.end()) {
+    for (auto next : edges->second) {
+      auto on_path = std::find(path->begin(), path->end(), next);
+      if (on_path != path->end()) {
+        *victim = *std::max_element(on_path, path->end());
+        return true;
+      }
+      if (visited->count(next) == 0 && FindCycle(next, path, visited, victim)) {
+        return true;
+      }
+    }
+  }
+  path->pop_back();
+  // Every path from here was explored without finding a cycle
+  visited->insert(txn_id);
+  return false;
+}
+
+auto LockManager::HasCycle(txn_id_t *txn_id) -> bool {
+  std::set<txn_id_t> visited;
+  for (const auto &[start, edges] : waits_for_) {
+    if (visited.count(start) != 0) {
+      continue;
+    }
+    std::vector<txn_id_t> path;
+    if (FindCycle(start, &path, &visited, txn_id)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto LockManager::GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>> {
+  std::vector<std::pair<txn_id_t, txn_id_t>> edges;
+  for (const auto &[t1, waits_for] : waits_for_) {
+    for (auto t2 : waits_for) {
+      edges.emplace_back(t1, t2);
+    }
+  }
+  return edges;
+}
+
+void LockManager::DetectDeadlocks() {
+  std::vector<std::shared_ptr<LockRequestQueue>> queues;
+  {
+    std::scoped_lock<std::mutex> map_lock(table_lock_map_latch_);
+    for (const auto &[oid, queue] : table_lock_map_) {
+      queues.push_back(queue);
+    }
+  }
+  {
+    std::scoped_lock<std::mutex> map_lock(row_lock_map_latch_);
+    for (const auto &[rid, queue] : row_lock_map_) {
+      queues.push_back(queue);
+    }
+  }
+
+  // A transaction waits for one request at a time
+  std::unordered_map<txn_id_t, std::pair<std::shared_ptr<LockRequestQueue>, std::shared_ptr<LockRequest>>> waiting;
+  waits_for_.clear();
+  for (const auto &queue : queues) {
+    std::scoped_lock<std::mutex> lock(queue->latch_);
+    for (auto it = queue->request_queue_.begin(); it != queue->request_queue_.end(); ++it) {
+      const auto &request = *it;
+      if (request->granted_) {
+        continue;
+      }
+      txn_id_t waiter = request->txn_->GetTransactionId();
+      waiting[waiter] = {queue, request};
+      // Requests are granted in order, so a waiting request waits for everything in front of it it can't join
+      for (auto ahead = queue->request_queue_.begin(); ahead != it; ++ahead) {
+        if (!(*ahead)->granted_ || !AreCompatible((*ahead)->lock_mode_, request->lock_mode_)) {
+          AddEdge(waiter, (*ahead)->txn_->GetTransactionId());
+        }
+      }
+    }
+  }
+
+  txn_id_t victim;
+  while (HasCycle(&victim)) {
+    waits_for_.erase(victim);
+    for (auto &[txn_id, edges] : waits_for_) {
+      edges.erase(victim);
+    }
+    auto &[queue, request] = waiting[victim];
+    std::scoped_lock<std::mutex> lock(queue->latch_);
+    // The graph is built queue by queue, the victim may have been granted since
+    bool still_waiting = !request->granted_ && std::find(queue->request_queue_.begin(), queue->request_queue_.end(),
+                                                          request) != queue->request_queue_.end();
+    if (still_waiting) {
+      request->txn_->state_ = TransactionState::TAINTED;
+      spdlog::debug("Transaction {} aborted to break a deadlock", victim);
+      queue->cv_.notify_all();
+    }
+  }
+  waits_for_.clear();
+}
+
+}  // namespace hmssql
@@ -0,0 +1,336 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// transaction_manager.cpp
+//
+// Identification: src/concurrency/transaction_manager.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/concurrency/transaction_manager.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "../include/recovery/log_record.h"
+#include "../include/storage/index/index.h"
+#include "../include/storage/table/table_heap.h"
+
+namespace hmssql {
+
+auto TransactionManager::Begin(ConcurrencyControl concurrency_control) -> Transaction * {
+  std::scoped_lock<std::mutex> lock(version_latch_);
+  txn_id_t txn_id = next_txn_id_++;
+  auto txn = std::make_unique<Transaction>(txn_id, last_commit_ts_, this, concurrency_control);
+  auto *txn_ptr = txn.get();
+  running_txns_.emplace(txn_id, std::move(txn));
+  return txn_ptr;
+}
+
+auto TransactionManager::Commit(Transaction *txn, bool synchronous_commit) -> bool {
+  BUSTUB_ASSERT(txn->state_ == TransactionState::RUNNING, "Only a running transaction can commit.");
+  // A read-only transaction saw a consistent snapshot, there is nothing to validate
+  if (txn->IsOptimistic() && !txn->write_set_.empty()) {
+    bool valid;
+    {
+      std::scoped_lock<std::mutex> lock(version_latch_);
+      valid = Validate(txn);
+      // From here on other optimistic transactions validate as if the writes were committed
+      txn->state_ = valid ? TransactionState::COMMITTING : TransactionState::TAINTED;
+    }
+    if (!valid) {
+      Abort(txn);
+      return false;
+    }
+  }
+
+  bool wrote = !txn->write_set_.empty();
+  if (wrote && enable_logging && log_manager_ != nullptr) {
+    LogRecord commit_record(txn->GetTransactionId(), INVALID_LSN, LogRecordType::COMMIT, TRANSACTION_TAG);
+    lsn_t commit_lsn = log_manager_->AppendLogRecord(&commit_record);
+    // Others only see the writes once they are durable, unless the session asked for asynchronous commit
+    if (synchronous_commit) {
+      log_manager_->Flush(commit_lsn);
+    }
+  }
+
+  std::unique_ptr<Transaction> finished;
+  {
+    std::scoped_lock<std::mutex> lock(version_latch_);
+    timestamp_t commit_ts = last_commit_ts_ + 1;
+    for (const auto &write : txn->write_set_) {
+      auto &shard = ShardOf(write.rid_);
+      {
+        std::scoped_lock<std::mutex> shard_lock(shard.latch_);
+        auto it = shard.chains_.find(write.rid_);
+        if (it != shard.chains_.end() && it->second.ts_ == txn->GetTempTs()) {
+          it->second.ts_ = commit_ts;
+        }
+      }
+      committed_writes_.emplace_back(commit_ts, write.rid_);
+      // The old image is not going back to the page, before the next writer of the row can reserve space for its own
+      write.table_->ReleaseReservation(write.rid_);
+    }
+    txn->commit_ts_ = commit_ts;
+    txn->state_ = TransactionState::COMMITTED;
+    // Snapshots taken from here on include the writes, all of them carry commit_ts already
+    last_commit_ts_ = commit_ts;
+    finished = std::move(running_txns_[txn->GetTransactionId()]);
+    running_txns_.erase(txn->GetTransactionId());
+  }
+  finished_cv_.notify_all();
+  // Strict two-phase locking, the next writer of a row sees the commit already
+  ReleaseLocks(finished.get());
+
+  if (wrote) {
+    GarbageCollect();
+  }
+  return true;
+}
+
+void TransactionManager::Abort(Transaction *txn) {
+  BUSTUB_ASSERT(txn->state_ == TransactionState::RUNNING || txn->state_ == TransactionState::TAINTED,
+                "Transaction is finished already.");
+  bool wrote = !txn->write_set_.empty();
+  // Undo in reverse order, the index entries point at the rows
+  for (auto it = txn->index_write_set_.rbegin(); it != txn->index_write_set_.rend(); ++it) {
+    if (it->is_insert_) {
+      it->index_->DeleteEntry(it->key_, it->rid_);
+    } else {
+      it->index_->InsertEntry(it->key_, it->rid_);
+    }
+  }
+  for (auto it = txn->write_set_.rbegin(); it != txn->write_set_.rend(); ++it) {
+    it->table_->RollbackWrite(it->rid_, txn);
+  }
+  if (wrote && enable_logging && log_manager_ != nullptr) {
+    LogRecord abort_record(txn->GetTransactionId(), INVALID_LSN, LogRecordType::ABORT, TRANSACTION_TAG);
+    log_manager_->AppendLogRecord(&abort_record);
+  }
+
+  std::unique_ptr<Transaction> finished;
+  {
+    std::scoped_lock<std::mutex> lock(version_latch_);
+    txn->state_ = TransactionState::ABORTED;
+    finished = std::move(running_txns_[txn->GetTransactionId()]);
+    running_txns_.erase(txn->GetTransactionId());
+  }
+  finished_cv_.notify_all();
+  ReleaseLocks(finished.get());
+
+  if (wrote) {
+    GarbageCollect();
+  }
+}
+
+void TransactionManager::WaitForLoggedTransactions() {
+  std::unique_lock<std::mutex> lock(version_latch_);
+  std::vector<txn_id_t> logged;
+  for (const auto &[txn_id, txn] : running_txns_) {
+    if (txn->HasLogged()) {
+      logged.push_back(txn_id);
+    }
+  }
+  finished_cv_.wait(lock, [this, &logged] {
+    return std::none_of(logged.begin(), logged.end(),
+                        [this](txn_id_t txn_id) { return running_txns_.count(txn_id) != 0; });
+  });
+}
+
+auto TransactionManager::ReadVersion(Transaction *txn, const RID &rid, bool page_deleted, Tuple *tuple) -> bool {
+  auto &shard = ShardOf(rid);
+  // No chain in the shard, none can be added while the caller holds the latch on the page
+  if (shard.size_ == 0) {
+    if (!page_deleted && txn->IsOptimistic()) {
+      txn->read_set_.push_back(ReadRecord{rid, 0});
+    }
+    return !page_deleted;
+  }
+  std::scoped_lock<std::mutex> lock(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  if (it == shard.chains_.end()) {
+    // Version 0 stands for a row last written before every running snapshot
+    if (!page_deleted && txn->IsOptimistic()) {
+      txn->read_set_.push_back(ReadRecord{rid, 0});
+    }
+    return !page_deleted;
+  }
+  const auto &chain = it->second;
+  if (chain.ts_ == txn->GetTempTs()) {
+    // Our own write, it was checked against the other writers when it was made
+    return !page_deleted;
+  }
+  if (chain.ts_ <= txn->GetReadTs()) {
+    if (!page_deleted && txn->IsOptimistic()) {
+      txn->read_set_.push_back(ReadRecord{rid, chain.ts_});
+    }
+    return !page_deleted;
+  }
+  for (const auto &undo : chain.undo_) {
+    if (undo.ts_ <= txn->GetReadTs()) {
+      if (undo.is_deleted_) {
+        return false;
+      }
+      // The image was copied off the page, its RID is set already
+      *tuple = undo.tuple_;
+      if (txn->IsOptimistic()) {
+        txn->read_set_.push_back(ReadRecord{rid, undo.ts_});
+      }
+      return true;
+    }
+  }
+  // The row was inserted after the snapshot
+  return false;
+}
+
+void TransactionManager::InsertVersion(Transaction *txn, TableHeap *table, const RID &rid) {
+  auto &shard = ShardOf(rid);
+  std::scoped_lock<std::mutex> lock(shard.latch_);
+  // The slot may be reused from a row whose delete everybody sees, its chain is gone by then
+  auto &chain = shard.chains_[rid];
+  shard.size_ = shard.chains_.size();
+  chain.table_ = table;
+  chain.ts_ = txn->GetTempTs();
+  chain.is_deleted_ = false;
+  chain.undo_.clear();
+  chain.undo_.push_front(UndoVersion{0, true, Tuple{}});
+  txn->write_set_.push_back(TableWriteRecord{table, rid});
+}
+
+auto TransactionManager::WriteVersion(Transaction *txn, TableHeap *table, const RID &rid, const Tuple &old_tuple,
+                                      bool is_delete, bool slot_deleted) -> bool {
+  auto &shard = ShardOf(rid);
+  std::scoped_lock<std::mutex> lock(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  // Either another transaction has an uncommitted write on the row or it committed one after we began. A delete
+  // counts too, the row our snapshot sees is gone then and writing it would lose that write.
+  if (it != shard.chains_.end() && it->second.ts_ != txn->GetTempTs() && it->second.ts_ > txn->GetReadTs()) {
+    txn->state_ = TransactionState::TAINTED;
+    return false;
+  }
+  if (slot_deleted) {
+    // Deleted before we began or by ourselves, there is no row to write
+    return false;
+  }
+  if (it == shard.chains_.end()) {
+    it = shard.chains_.emplace(rid, VersionChain{table, 0, false, {}}).first;
+    shard.size_ = shard.chains_.size();
+  }
+  auto &chain = it->second;
+  if (chain.ts_ != txn->GetTempTs()) {
+    chain.undo_.push_front(UndoVersion{chain.ts_, false, old_tuple});
+    chain.ts_ = txn->GetTempTs();
+    txn->write_set_.push_back(TableWriteRecord{table, rid});
+  }
+  chain.is_deleted_ = is_delete;
+  return true;
+}
+
+auto TransactionManager::RollbackVersion(Transaction *txn, const RID &rid, UndoVersion *undo, bool *page_deleted)
+    -> bool {
+  auto &shard = ShardOf(rid);
+  std::scoped_lock<std::mutex> lock(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  if (it == shard.chains_.end() || it->second.ts_ != txn->GetTempTs() || it->second.undo_.empty()) {
+    return false;
+  }
+  auto &chain = it->second;
+  *undo = std::move(chain.undo_.front());
+  *page_deleted = chain.is_deleted_;
+  chain.undo_.pop_front();
+  chain.ts_ = undo->ts_;
+  chain.is_deleted_ = false;
+  if (chain.undo_.empty() || undo->is_deleted_) {
+    shard.chains_.erase(it);
+    shard.size_ = shard.chains_.size();
+  }
+  return true;
+}
+
+auto TransactionManager::Validate(Transaction *txn) -> bool {
+  for (const auto &read : txn->read_set_) {
+    auto &shard = ShardOf(read.rid_);
+    std::scoped_lock<std::mutex> shard_lock(shard.latch_);
+    auto it = shard.chains_.find(read.rid_);
+    if (it == shard.chains_.end()) {
+      // Nobody wrote the row after the oldest running snapshot, ours included
+      continue;
+    }
+    const auto &chain = it->second;
+    timestamp_t newest = chain.ts_;
+    if (newest == txn->GetTempTs()) {
+      // We overwrote the row after reading it, the write was checked already
+      continue;
+    }
+    if (newest >= TXN_START_TS) {
+      auto writer = running_txns_.find(static_cast<txn_id_t>(newest - TXN_START_TS));
+      if (writer != running_txns_.end() && writer->second->state_ == TransactionState::COMMITTING) {
+        return false;
+      }
+      newest = chain.undo_.empty() ? 0 : chain.undo_.front().ts_;
+    }
+    // A chain collected and rebuilt since restarts at 0, the version we read was older than every snapshot then
+    if (newest != 0 && newest != read.version_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void TransactionManager::ReleaseLocks(Transaction *txn) {
+  if (lock_manager_ != nullptr) {
+    lock_manager_->UnlockAll(txn);
+  }
+}
+
+void TransactionManager::GarbageCollect() {
+  timestamp_t watermark;
+  std::vector<RID> collectable;
+  {
+    std::scoped_lock<std::mutex> lock(version_latch_);
+    // No running snapshot is older than the watermark, of the images committed up to it only the newest is readable
+    watermark = last_commit_ts_;
+    for (const auto &[txn_id, txn] : running_txns_) {
+      watermark = std::min(watermark, txn->GetReadTs());
+    }
+    // Every image a row drops once the watermark rises was committed at or below it, by a commit that queued the row
+    while (!committed_writes_.empty() && committed_writes_.front().first <= watermark) {
+      collectable.push_back(committed_writes_.front().second);
+      committed_writes_.pop_front();
+    }
+  }
+  // New snapshots begin at the last commit, the watermark only rises and the chains can be trimmed after the fact
+  std::vector<std::pair<TableHeap *, RID>> deletes;
+  for (const auto &rid : collectable) {
+    auto &shard = ShardOf(rid);
+    std::scoped_lock<std::mutex> shard_lock(shard.latch_);
+    auto it = shard.chains_.find(rid);
+    if (it == shard.chains_.end()) {
+      continue;
+    }
+    auto &chain = it->second;
+    if (chain.ts_ <= watermark) {
+      // Every snapshot reads the page. Dropping the chain of a deleted row hides it, so nobody can read the slot
+      // while the delete is applied below.
+      if (chain.is_deleted_) {
+        deletes.emplace_back(chain.table_, rid);
+      }
+      shard.chains_.erase(it);
+      shard.size_ = shard.chains_.size();
+      continue;
+    }
+    auto oldest_needed = std::find_if(chain.undo_.begin(), chain.undo_.end(),
+                                      [watermark](const UndoVersion &undo) { return undo.ts_ <= watermark; });
+    if (oldest_needed != chain.undo_.end()) {
+      chain.undo_.erase(oldest_needed + 1, chain.undo_.end());
+    }
+  }
+  for (const auto &[table, rid] : deletes) {
+    table->ApplyDelete(rid);
+  }
+}
+
+}  // namespace hmssql
@@ -20,15 +20,27 @@ AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const Aggreg
     : AbstractExecutor(exec_ctx),
       plan_(plan),
       child_(std::move(child)),
-      aht_(plan_->aggregates_, plan_->agg_types_),
+      aht_(plan_->aggregates_, plan_->agg_types_, exec_ctx->GetArena()),
       aht_iterator_(aht_.Begin()) {}
 
 void AggregationExecutor::Init() {
   child_->Init();
-  Tuple tuple{};
-  RID rid{};
-  while (child_->Next(&tuple, &rid)) {
-    aht_.InsertCombine(MakeAggregateKey(&tuple), MakeAggregateValue(&tuple));
+  // The group by and aggregate expressions are evaluated a batch at a time, only the hash table is probed per tuple
+  TupleBatch batch;
+  std::vector<ColumnVector> group_bys(plan_->GetGroupBys().size());
+  std::vector<ColumnVector> aggregates(plan_->GetAggregates().size());
+  while (child_->NextBatch(&batch)) {
+    for (uint32_t i = 0; i < group_bys.size(); i++) {
+      plan_->GetGroupBys()[i]->EvaluateBatch(batch, &group_bys[i]);
+    }
+    for (uint32_t i = 0; i < aggregates.size(); i++) {
+      plan_->GetAggregates()[i]->EvaluateBatch(batch, &aggregates[i]);
+    }
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      GatherRow(group_bys, aggregates, row);
+      aht_.InsertCombine(key_, input_);
+    }
   }
   if (aht_.Size() == 0 && GetOutputSchema().GetColumnCount() == 1) {
     aht_.InsertIntialCombine();
@@ -40,16 +52,21 @@ auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   if (aht_iterator_ == aht_.End()) {
     return false;
   }
-  std::vector<Value> values;
-
-  values.insert(values.end(), aht_iterator_.Key().group_bys_.begin(), aht_iterator_.Key().group_bys_.end());
-  values.insert(values.end(), aht_iterator_.Val().aggregates_.begin(), aht_iterator_.Val().aggregates_.end());
-  *tuple = Tuple{values, &GetOutputSchema()};
+  *tuple = Tuple{MakeOutputValues(), &GetOutputSchema()};
   ++aht_iterator_;
 
   return true;
 }
 
+auto AggregationExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && aht_iterator_ != aht_.End()) {
+    batch->AppendValues(MakeOutputValues());
+    ++aht_iterator_;
+  }
+  return batch->GetRowCount() > 0;
+}
+
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
 }  // namespace hmssql
@@ -11,7 +11,9 @@
 
 #include <memory>
 
+#include "../include/common/exception.h"
 #include "../include/execution/executors/delete_executor.h"
+#include "fmt/format.h"
 
 namespace hmssql {
 
@@ -22,8 +24,12 @@ DeleteExecutor::DeleteExecutor(ExecutorContext *exec_ctx, const DeletePlanNode *
 }
 
 void DeleteExecutor::Init() {
+  auto *lock_manager = exec_ctx_->GetLockManager();
+  if (lock_manager != nullptr &&
+      !lock_manager->LockTable(exec_ctx_->GetTransaction(), LockMode::INTENTION_EXCLUSIVE, table_info_->oid_)) {
+    throw ExecutionException(fmt::format("deadlock detected while locking table {}", table_info_->name_));
+  }
   child_executor_->Init();
-  // No transaction locking here anymore
   table_indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
 }
 
@@ -34,21 +40,31 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   Tuple to_delete_tuple{};
   RID emit_rid;
   int32_t delete_count = 0;
+  auto *txn = exec_ctx_->GetTransaction();
+  // Optimistic transactions find conflicting writers when they write or validate, without locking
+  auto *lock_manager = txn != nullptr && !txn->IsOptimistic() ? exec_ctx_->GetLockManager() : nullptr;
 
   while (child_executor_->Next(&to_delete_tuple, &emit_rid)) {
-    // No transaction locking here anymore
-    
-    // Simply delete the tuple directly
-    bool deleted = table_info_->table_->MarkDelete(emit_rid);
+    // Held until the transaction finishes, a concurrent writer of the row waits for it
+    if (lock_manager != nullptr && !lock_manager->LockRow(txn, LockMode::EXCLUSIVE, table_info_->oid_, emit_rid)) {
+      throw ExecutionException(fmt::format("deadlock detected while locking tuple {}", emit_rid.ToString()));
+    }
+    // The version chain of the tuple keeps it readable for older snapshots
+    bool deleted = table_info_->table_->MarkDelete(emit_rid, txn);
 
     if (deleted) {
-      // Update indexes without transaction
       std::for_each(table_indexes_.begin(), table_indexes_.end(),
-                    [&to_delete_tuple, &emit_rid, &table_info = table_info_](IndexInfo *index) {
-                      index->index_->DeleteEntry(to_delete_tuple.KeyFromTuple(table_info->schema_, index->key_schema_,
-                                                                              index->index_->GetKeyAttrs()), emit_rid);
+                    [&to_delete_tuple, &emit_rid, &table_info = table_info_, txn](IndexInfo *index) {
+                      auto key = to_delete_tuple.KeyFromTuple(table_info->schema_, index->key_schema_,
+                                                              index->index_->GetKeyAttrs());
+                      index->index_->DeleteEntry(key, emit_rid);
+                      if (txn != nullptr) {
+                        txn->AppendIndexWriteRecord(IndexWriteRecord{index->index_.get(), key, emit_rid, false});
+                      }
                     });
       delete_count++;
+    } else if (txn != nullptr && txn->GetState() == TransactionState::TAINTED) {
+      throw ExecutionException(fmt::format("tuple {} was changed by a concurrent transaction", emit_rid.ToString()));
     }
   }
   std::vector<Value> values{};
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// exchange_queue.cpp
+//
+// Identification: src/execution/exchange_queue.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/exchange_queue.h"
+
+#include <utility>
+
+namespace hmssql {
+
+ExchangeQueue::ExchangeQueue(size_t producers, size_t capacity) : capacity_(capacity), running_producers_(producers) {}
+
+auto ExchangeQueue::Push(TupleBatch &&batch) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  not_full_.wait(lock, [&] { return closed_ || batches_.size() < capacity_; });
+  if (closed_) {
+    return false;
+  }
+  batches_.push_back(std::move(batch));
+  not_empty_.notify_one();
+  return true;
+}
+
+void ExchangeQueue::ProducerDone() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  running_producers_--;
+  not_empty_.notify_all();
+}
+
+void ExchangeQueue::Fail(std::exception_ptr error) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (error_ == nullptr) {
+    error_ = std::move(error);
+  }
+  running_producers_--;
+  not_empty_.notify_all();
+}
+
+auto ExchangeQueue::Pop(TupleBatch *batch) -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  not_empty_.wait(lock, [&] { return error_ != nullptr || !batches_.empty() || running_producers_ == 0; });
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+  if (batches_.empty()) {
+    return false;
+  }
+  *batch = std::move(batches_.front());
+  batches_.pop_front();
+  not_full_.notify_one();
+  return true;
+}
+
+void ExchangeQueue::Close() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  closed_ = true;
+  batches_.clear();
+  not_full_.notify_all();
+}
+
+}  // namespace hmssql
@@ -18,14 +18,18 @@
 #include "../include/execution/executors/aggregation_executor.h"
 #include "../include/execution/executors/delete_executor.h"
 #include "../include/execution/executors/filter_executor.h"
+#include "../include/execution/executors/gather_executor.h"
 #include "../include/execution/executors/hash_join_executor.h"
 #include "../include/execution/executors/index_scan_executor.h"
 #include "../include/execution/executors/insert_executor.h"
 #include "../include/execution/executors/limit_executor.h"
+#include "../include/execution/executors/merge_join_executor.h"
 #include "../include/execution/executors/mock_scan_executor.h"
 #include "../include/execution/executors/nested_index_join_executor.h"
 #include "../include/execution/executors/nested_loop_join_executor.h"
 #include "../include/execution/executors/projection_executor.h"
+#include "../include/execution/executors/radix_hash_join_executor.h"
+#include "../include/execution/executors/repartition_executor.h"
 #include "../include/execution/executors/seq_scan_executor.h"
 #include "../include/execution/executors/sort_executor.h"
 #include "../include/execution/executors/topn_executor.h"
@@ -114,9 +118,20 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan.get());
       auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan());
       auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan());
+      if (hash_join_plan->GetRadixWorkers() > 0) {
+        return std::make_unique<RadixHashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
+      }
       return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
     }
 
+    // Create a new merge join executor
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan.get());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, merge_join_plan, std::move(left), std::move(right));
+    }
+
     // Create a new mock scan executor
     case PlanType::MockScan: {
       const auto *mock_scan_plan = dynamic_cast<const MockScanPlanNode *>(plan.get());
@@ -146,6 +161,10 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       // Create a new sort executor
     case PlanType::Sort: {
       const auto *sort_plan = dynamic_cast<const SortPlanNode *>(plan.get());
+      // A parallel sort creates the executors of its workers
+      if (sort_plan->GetWorkers() > 0) {
+        return std::make_unique<SortExecutor>(exec_ctx, sort_plan, nullptr);
+      }
       auto child = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
       return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child));
     }
@@ -153,6 +172,10 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       // Create a new topN executor
     case PlanType::TopN: {
       const auto *topn_plan = dynamic_cast<const TopNPlanNode *>(plan.get());
+      // A parallel topn creates the executors of its workers
+      if (topn_plan->GetWorkers() > 0) {
+        return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, nullptr);
+      }
       auto child = ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan());
       return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, std::move(child));
     }
@@ -169,6 +192,16 @@ auto ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx, const AbstractPl
       return std::make_unique<CreateTempTableExecutor>(exec_ctx, create_temp_table_plan);
     }
 
+    // Create a new gather executor, it creates the executors of its workers itself
+    case PlanType::Gather: {
+      const auto *gather_plan = dynamic_cast<const GatherPlanNode *>(plan.get());
+      return std::make_unique<GatherExecutor>(exec_ctx, gather_plan);
+    }
+    // Create a new repartition executor, its state creates the executors of the producers
+    case PlanType::Repartition: {
+      const auto *repartition_plan = dynamic_cast<const RepartitionPlanNode *>(plan.get());
+      return std::make_unique<RepartitionExecutor>(exec_ctx, repartition_plan);
+    }
     default:
       UNREACHABLE("Unsupported plan type.");
   }
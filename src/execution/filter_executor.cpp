@@ -33,4 +33,14 @@ auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   }
 }
 
-}  // namespace hmssql
\ No newline at end of file
+auto FilterExecutor::NextBatch(TupleBatch *batch) -> bool {
+  while (child_executor_->NextBatch(batch)) {
+    batch->ApplyFilter(*plan_->GetPredicate());
+    if (batch->Size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace hmssql
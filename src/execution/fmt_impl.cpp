@@ -7,8 +7,11 @@
 #include "../include/execution/expressions/abstract_expression.h"
 #include "../include/execution/plans/abstract_plan.h"
 #include "../include/execution/plans/aggregation_plan.h"
+#include "../include/execution/plans/hash_join_plan.h"
 #include "../include/execution/plans/limit_plan.h"
+#include "../include/execution/plans/merge_join_plan.h"
 #include "../include/execution/plans/projection_plan.h"
+#include "../include/execution/plans/repartition_plan.h"
 #include "../include/execution/plans/sort_plan.h"
 #include "../include/execution/plans/topn_plan.h"
 
@@ -35,6 +38,25 @@ auto AggregationPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Agg {{ types={}, aggregates={}, group_by={} }}", agg_types_, aggregates_, group_bys_);
 }
 
+auto HashJoinPlanNode::PlanNodeToString() const -> std::string {
+  if (radix_workers_ > 0) {
+    return fmt::format("HashJoin {{ type={}, left_keys={}, right_keys={}, radix_workers={} }}", join_type_,
+                       left_key_expressions_, right_key_expressions_, radix_workers_);
+  }
+  return fmt::format("HashJoin {{ type={}, left_keys={}, right_keys={} }}", join_type_, left_key_expressions_,
+                     right_key_expressions_);
+}
+
+auto MergeJoinPlanNode::PlanNodeToString() const -> std::string {
+  return fmt::format("MergeJoin {{ type={}, left_keys={}, right_keys={} }}", join_type_, left_key_expressions_,
+                     right_key_expressions_);
+}
+
+auto RepartitionPlanNode::PlanNodeToString() const -> std::string {
+  return fmt::format("Repartition {{ keys={}, partitions={}, producers={} }}", partition_keys_, partitions_,
+                     producers_);
+}
+
 auto ProjectionPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Projection {{ exprs={} }}", expressions_);
 }
@@ -44,12 +66,18 @@ auto UpdatePlanNode::PlanNodeToString() const -> std::string {
 }
 
 auto SortPlanNode::PlanNodeToString() const -> std::string {
+  if (workers_ > 0) {
+    return fmt::format("Sort {{ order_bys={}, workers={} }}", order_bys_, workers_);
+  }
   return fmt::format("Sort {{ order_bys={} }}", order_bys_);
 }
 
 auto LimitPlanNode::PlanNodeToString() const -> std::string { return fmt::format("Limit {{ limit={} }}", limit_); }
 
 auto TopNPlanNode::PlanNodeToString() const -> std::string {
+  if (workers_ > 0) {
+    return fmt::format("TopN {{ n={}, order_bys={}, workers={} }}", n_, order_bys_, workers_);
+  }
   return fmt::format("TopN {{ n={}, order_bys={}}}", n_, order_bys_);
 }
 
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// gather_executor.cpp
+//
+// Identification: src/execution/gather_executor.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/executors/gather_executor.h"
+
+#include <utility>
+
+#include "../include/execution/executor_factory.h"
+
+namespace hmssql {
+
+GatherExecutor::GatherExecutor(ExecutorContext *exec_ctx, const GatherPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+GatherExecutor::~GatherExecutor() { StopWorkers(); }
+
+void GatherExecutor::Init() {
+  BUSTUB_ASSERT(exec_ctx_->GetThreadPool() != nullptr, "parallel plans need a thread pool");
+  StopWorkers();
+  parallel_state_ = std::make_unique<ParallelState>();
+  exchange_ = std::make_unique<ExchangeQueue>(plan_->GetWorkers());
+  current_batch_.Reset(&GetOutputSchema());
+  current_idx_ = 0;
+  for (size_t i = 0; i < plan_->GetWorkers(); i++) {
+    worker_ctxs_.push_back(std::make_unique<ExecutorContext>(exec_ctx_, parallel_state_.get(), i));
+    worker_executors_.push_back(ExecutorFactory::CreateExecutor(worker_ctxs_.back().get(), plan_->GetChildPlan()));
+  }
+  for (auto &executor : worker_executors_) {
+    workers_.push_back(exec_ctx_->GetThreadPool()->Submit([this, child = executor.get()] { RunWorker(child); }));
+  }
+}
+
+auto GatherExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (current_idx_ >= current_batch_.Size()) {
+    if (!exchange_->Pop(&current_batch_)) {
+      return false;
+    }
+    current_idx_ = 0;
+  }
+  auto row = current_batch_.RowAt(current_idx_++);
+  *tuple = current_batch_.GetTuple(row);
+  *rid = current_batch_.GetRid(row);
+  return true;
+}
+
+auto GatherExecutor::NextBatch(TupleBatch *batch) -> bool { return exchange_->Pop(batch); }
+
+void GatherExecutor::RunWorker(AbstractExecutor *child) {
+  try {
+    // Blocking operators below, like the build of a hash join, run in Init() on the worker as well
+    child->Init();
+    TupleBatch batch;
+    while (child->NextBatch(&batch)) {
+      if (!exchange_->Push(std::move(batch))) {
+        break;
+      }
+    }
+    exchange_->ProducerDone();
+  } catch (...) {
+    exchange_->Fail(std::current_exception());
+  }
+}
+
+void GatherExecutor::StopWorkers() {
+  if (exchange_ != nullptr) {
+    exchange_->Close();
+  }
+  for (auto &worker : workers_) {
+    worker.wait();
+  }
+  workers_.clear();
+  // The executors go before the state they share, which waits for the producers of repartitions below
+  worker_executors_.clear();
+  worker_ctxs_.clear();
+  parallel_state_.reset();
+}
+
+}  // namespace hmssql
@@ -10,6 +10,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "../include/execution/executors/hash_join_executor.h"
+
+#include <algorithm>
+
+#include "../include/execution/expressions/column_value_expression.h"
 #include "../include/type/value_factory.h"
 
 // Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
@@ -28,63 +32,362 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw hmssql::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
+  // Only an inner join drops the left rows without a match, and the scan can only read plain columns of its table
+  if (plan->GetJoinType() != JoinType::INNER) {
+    return;
+  }
+  for (const auto &key : plan->LeftJoinKeyExpressions()) {
+    const auto *column = dynamic_cast<const ColumnValueExpression *>(key.get());
+    if (column == nullptr || column->GetTupleIdx() != 0) {
+      probe_key_columns_.clear();
+      return;
+    }
+    probe_key_columns_.push_back(column->GetColIdx());
+  }
+  probe_scan_ = dynamic_cast<SeqScanExecutor *>(left_executor_.get());
+}
+
+void JoinHashTable::Reset(uint32_t key_width, uint32_t row_width) {
+  key_width_ = key_width;
+  row_width_ = row_width;
+  // Released rather than only cleared, MemoryUsage counts what the vectors hold on to
+  values_.clear();
+  values_.shrink_to_fit();
+  next_rows_.clear();
+  next_rows_.shrink_to_fit();
+  keys_.clear();
+  keys_.shrink_to_fit();
+  tags_.assign(64, 0);
+  slots_.assign(64, Slot{});
+  varlen_arena_.Reset();
+}
+
+auto JoinHashTable::HasNull(const Value *key) const -> bool {
+  return std::any_of(key, key + key_width_, [](const Value &value) { return value.IsNull(); });
+}
+
+auto JoinHashTable::HashKey(const Value *key) const -> hash_t { return HashUtil::HashValues(key, key_width_); }
+
+auto JoinHashTable::KeyEquals(uint32_t key_idx, const Value *key) const -> bool {
+  const auto *stored = &keys_[static_cast<size_t>(key_idx) * key_width_];
+  for (uint32_t i = 0; i < key_width_; i++) {
+    if (stored[i].CompareEquals(key[i]) != CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto JoinHashTable::MemoryUsage() const -> size_t {
+  return (values_.capacity() + keys_.capacity()) * sizeof(Value) + next_rows_.capacity() * sizeof(uint32_t) +
+         slots_.size() * (sizeof(Slot) + sizeof(uint8_t)) + varlen_arena_.GetMemoryUsage();
+}
+
+void JoinHashTable::AppendValue(std::vector<Value> *values, const Value &value) {
+  values->push_back(ValueFactory::Clone(value, &varlen_arena_));
+}
+
+void JoinHashTable::Insert(const Value *key, hash_t hash, const TupleBatch &batch, uint32_t row) {
+  for (uint32_t col_idx = 0; col_idx < row_width_; col_idx++) {
+    AppendValue(&values_, batch.GetValueView(col_idx, row));
+  }
+  Link(key, hash);
+}
+
+void JoinHashTable::Insert(const Value *key, hash_t hash, const Value *row_values) {
+  for (uint32_t col_idx = 0; col_idx < row_width_; col_idx++) {
+    AppendValue(&values_, row_values[col_idx]);
+  }
+  Link(key, hash);
+}
+
+void JoinHashTable::Link(const Value *key, hash_t hash) {
+  auto build_row = static_cast<uint32_t>(next_rows_.size());
+  next_rows_.push_back(NO_ROW);
+  auto key_count = keys_.size() / key_width_;
+  if ((key_count + 1) * 2 > slots_.size()) {
+    Grow();
+  }
+
+  auto tag = TagOf(hash);
+  auto mask = slots_.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    if (tags_[pos] == 0) {
+      tags_[pos] = tag;
+      slots_[pos] = Slot{hash, static_cast<uint32_t>(key_count), build_row, build_row};
+      for (uint32_t i = 0; i < key_width_; i++) {
+        AppendValue(&keys_, key[i]);
+      }
+      return;
+    }
+    auto &slot = slots_[pos];
+    if (tags_[pos] == tag && slot.hash_ == hash && KeyEquals(slot.key_, key)) {
+      next_rows_[slot.last_row_] = build_row;
+      slot.last_row_ = build_row;
+      return;
+    }
+  }
+}
+
+auto JoinHashTable::Find(const Value *key, hash_t hash) const -> uint32_t {
+  auto tag = TagOf(hash);
+  auto mask = slots_.size() - 1;
+  for (auto pos = hash & mask; tags_[pos] != 0; pos = (pos + 1) & mask) {
+    if (tags_[pos] != tag) {
+      continue;
+    }
+    const auto &slot = slots_[pos];
+    if (slot.hash_ == hash && KeyEquals(slot.key_, key)) {
+      return slot.first_row_;
+    }
+  }
+  return NO_ROW;
+}
+
+void JoinHashTable::Grow() {
+  std::vector<uint8_t> tags(tags_.size() * 2, 0);
+  std::vector<Slot> slots(slots_.size() * 2);
+  auto mask = slots.size() - 1;
+  for (size_t i = 0; i < slots_.size(); i++) {
+    if (tags_[i] == 0) {
+      continue;
+    }
+    auto pos = slots_[i].hash_ & mask;
+    while (tags[pos] != 0) {
+      pos = (pos + 1) & mask;
+    }
+    tags[pos] = tags_[i];
+    slots[pos] = slots_[i];
+  }
+  tags_ = std::move(tags);
+  slots_ = std::move(slots);
 }
 
 void HashJoinExecutor::Init() {
   left_executor_->Init();
   right_executor_->Init();
 
-  Tuple tmp_tuple{};
-  RID rid;
-  while (right_executor_->Next(&tmp_tuple, &rid)) {
-    auto join_key = plan_->RightJoinKeyExpression().Evaluate(&tmp_tuple, plan_->GetRightPlan()->OutputSchema());
-    hash_join_table_[HashUtil::HashValue(&join_key)].push_back(tmp_tuple);
-  }
-
-  while (left_executor_->Next(&tmp_tuple, &rid)) {
-    auto join_key = plan_->LeftJoinKeyExpression().Evaluate(&tmp_tuple, plan_->GetLeftPlan()->OutputSchema());
-    if (hash_join_table_.count(HashUtil::HashValue(&join_key)) > 0) {
-      auto right_tuples = hash_join_table_[HashUtil::HashValue(&join_key)];
-      for (const auto &tuple : right_tuples) {
-        auto right_join_key = plan_->RightJoinKeyExpression().Evaluate(&tuple, plan_->GetRightPlan()->OutputSchema());
-        if (right_join_key.CompareEquals(join_key) == CmpBool::CmpTrue) {
-          std::vector<Value> values{};
-          values.reserve(plan_->GetLeftPlan()->OutputSchema().GetColumnCount() +
-                         plan_->GetRightPlan()->OutputSchema().GetColumnCount());
-          for (uint32_t col_idx = 0; col_idx < plan_->GetLeftPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-            values.push_back(tmp_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), col_idx));
-          }
-          for (uint32_t col_idx = 0; col_idx < plan_->GetRightPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-            values.push_back(tuple.GetValue(&plan_->GetRightPlan()->OutputSchema(), col_idx));
-          }
-          output_tuples_.emplace_back(values, &GetOutputSchema());
-        }
+  pending_partitions_.clear();
+  current_partition_ = SpillPartition{};
+  Build([this](TupleBatch *batch) { return right_executor_->NextBatch(batch); }, 0);
+  PushRuntimeFilter();
+
+  left_batch_.Reset(&plan_->GetLeftPlan()->OutputSchema());
+  left_idx_ = 0;
+  left_done_ = false;
+  build_row_ = JoinHashTable::NO_ROW;
+}
+
+void HashJoinExecutor::Build(const std::function<bool(TupleBatch *)> &next_batch, uint32_t level) {
+  const auto &right_keys = plan_->RightJoinKeyExpressions();
+  hash_join_table_.Reset(right_keys.size(), plan_->GetRightPlan()->OutputSchema().GetColumnCount());
+  spill_partitions_.clear();
+  memory_partition_ = 0;
+  build_level_ = level;
+
+  // The build side is read a batch at a time and the join keys evaluated on whole batches
+  TupleBatch batch;
+  std::vector<ColumnVector> keys;
+  while (next_batch(&batch)) {
+    EvaluateKeys(right_keys, batch, &keys);
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      GatherKey(keys, row);
+      if (hash_join_table_.HasNull(key_.data())) {
+        continue;
       }
-    } else if (plan_->GetJoinType() == JoinType::LEFT) {
-      std::vector<Value> values{};
-      values.reserve(plan_->GetLeftPlan()->OutputSchema().GetColumnCount() +
-                     plan_->GetRightPlan()->OutputSchema().GetColumnCount());
-      for (uint32_t col_idx = 0; col_idx < plan_->GetLeftPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-        values.push_back(tmp_tuple.GetValue(&plan_->GetLeftPlan()->OutputSchema(), col_idx));
+      auto hash = hash_join_table_.HashKey(key_.data());
+      if (!spill_partitions_.empty()) {
+        auto partition = PartitionOf(hash);
+        if (partition != memory_partition_) {
+          spill_partitions_[partition].build_->Append(batch.GetTuple(row));
+          continue;
+        }
       }
-      for (uint32_t col_idx = 0; col_idx < plan_->GetRightPlan()->OutputSchema().GetColumnCount(); col_idx++) {
-        values.push_back(
-            ValueFactory::GetNullValueByType(plan_->GetRightPlan()->OutputSchema().GetColumn(col_idx).GetType()));
+      hash_join_table_.Insert(key_.data(), hash, batch, row);
+    }
+    while (hash_join_table_.MemoryUsage() > exec_ctx_->GetWorkMem() && Spill()) {
+    }
+  }
+}
+
+void HashJoinExecutor::PushRuntimeFilter() {
+  // The keys of spilled partitions are not at hand
+  if (probe_scan_ == nullptr || !spill_partitions_.empty()) {
+    return;
+  }
+  BlockedBloomFilter bloom(hash_join_table_.KeyCount());
+  hash_join_table_.ForEachKey([&](const Value *key, hash_t hash, uint32_t row) { bloom.Insert(hash); });
+  runtime_filter_ = std::make_unique<RuntimeFilter>(probe_key_columns_, std::move(bloom));
+  probe_scan_->SetRuntimeFilter(runtime_filter_.get());
+}
+
+auto HashJoinExecutor::Spill() -> bool {
+  auto *file = exec_ctx_->GetTmpFile();
+  if (build_level_ >= MAX_SPILL_LEVEL || memory_partition_ == NO_PARTITION) {
+    return false;
+  }
+  if (spill_partitions_.empty()) {
+    for (uint32_t i = 0; i < HASH_JOIN_SPILL_PARTITIONS; i++) {
+      spill_partitions_.push_back(
+          SpillPartition{std::make_unique<TmpTupleHeap>(file), std::make_unique<TmpTupleHeap>(file), build_level_ + 1});
+    }
+  } else {
+    // The partition kept in memory outgrew work_mem on its own
+    memory_partition_ = NO_PARTITION;
+  }
+
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  auto right_width = right_schema.GetColumnCount();
+  JoinHashTable kept;
+  kept.Reset(plan_->RightJoinKeyExpressions().size(), right_width);
+  std::vector<Value> values;
+  hash_join_table_.ForEachKey([&](const Value *key, hash_t hash, uint32_t row) {
+    auto partition = PartitionOf(hash);
+    for (; row != JoinHashTable::NO_ROW; row = hash_join_table_.NextRow(row)) {
+      const auto *row_values = hash_join_table_.GetRow(row);
+      if (partition == memory_partition_) {
+        kept.Insert(key, hash, row_values);
+        continue;
       }
-      output_tuples_.emplace_back(values, &GetOutputSchema());
+      values.assign(row_values, row_values + right_width);
+      spill_partitions_[partition].build_->Append(Tuple(values, &right_schema));
+    }
+  });
+  hash_join_table_ = std::move(kept);
+  return true;
+}
+
+auto HashJoinExecutor::PartitionOf(hash_t hash) const -> uint32_t {
+  static_assert((HASH_JOIN_SPILL_PARTITIONS & (HASH_JOIN_SPILL_PARTITIONS - 1)) == 0, "a power of two");
+  // Every level splits by the next bits down from the tag, the low bits pick the slot
+  constexpr uint32_t partition_bits = __builtin_ctz(HASH_JOIN_SPILL_PARTITIONS);
+  return (hash >> (56 - partition_bits * (build_level_ + 1))) & (HASH_JOIN_SPILL_PARTITIONS - 1);
+}
+
+auto HashJoinExecutor::ReadBatch(TmpTupleHeap *heap, const Schema *schema, TupleBatch *batch) -> bool {
+  batch->Reset(schema);
+  Tuple tuple;
+  while (!batch->IsFull() && heap->Next(&tuple)) {
+    batch->AppendTuple(tuple, RID{});
+  }
+  return batch->GetRowCount() > 0;
+}
+
+auto HashJoinExecutor::NextProbeBatch() -> bool {
+  if (current_partition_.probe_ != nullptr) {
+    return ReadBatch(current_partition_.probe_.get(), &plan_->GetLeftPlan()->OutputSchema(), &left_batch_);
+  }
+  if (left_done_ || !left_executor_->NextBatch(&left_batch_)) {
+    left_done_ = true;
+    return false;
+  }
+  return true;
+}
+
+auto HashJoinExecutor::NextPartition() -> bool {
+  // A partition without build rows joined its probe rows as they came, one without probe rows has nothing to join
+  for (auto &partition : spill_partitions_) {
+    if (partition.build_->Size() > 0 && partition.probe_->Size() > 0) {
+      pending_partitions_.push_back(std::move(partition));
     }
   }
+  spill_partitions_.clear();
+  if (pending_partitions_.empty()) {
+    return false;
+  }
+  current_partition_ = std::move(pending_partitions_.back());
+  pending_partitions_.pop_back();
+  const auto *right_schema = &plan_->GetRightPlan()->OutputSchema();
+  Build([this, right_schema](TupleBatch *batch) {
+    return ReadBatch(current_partition_.build_.get(), right_schema, batch);
+  }, current_partition_.level_);
+  current_partition_.build_.reset();
+  left_idx_ = 0;
+  left_batch_.Reset(&plan_->GetLeftPlan()->OutputSchema());
+  return true;
+}
 
-  output_tuples_iter_ = output_tuples_.cbegin();
+void HashJoinExecutor::EvaluateKeys(const std::vector<AbstractExpressionRef> &key_expressions,
+                                    const TupleBatch &batch, std::vector<ColumnVector> *keys) {
+  keys->resize(key_expressions.size());
+  for (size_t i = 0; i < key_expressions.size(); i++) {
+    key_expressions[i]->EvaluateBatch(batch, &(*keys)[i]);
+  }
+}
+
+void HashJoinExecutor::GatherKey(const std::vector<ColumnVector> &keys, uint32_t row) {
+  key_.clear();
+  for (const auto &column : keys) {
+    key_.push_back(column.GetValueView(row));
+  }
+}
+
+auto HashJoinExecutor::NextJoinedRow() -> bool {
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  auto left_width = plan_->GetLeftPlan()->OutputSchema().GetColumnCount();
+  auto right_width = right_schema.GetColumnCount();
+  while (build_row_ == JoinHashTable::NO_ROW) {
+    if (left_idx_ >= left_batch_.Size()) {
+      if (!NextProbeBatch()) {
+        if (!NextPartition()) {
+          return false;
+        }
+        continue;
+      }
+      EvaluateKeys(plan_->LeftJoinKeyExpressions(), left_batch_, &left_keys_);
+      left_idx_ = 0;
+      continue;
+    }
+    auto row = left_batch_.RowAt(left_idx_++);
+    GatherKey(left_keys_, row);
+    if (!hash_join_table_.HasNull(key_.data())) {
+      auto hash = hash_join_table_.HashKey(key_.data());
+      auto partition = spill_partitions_.empty() ? memory_partition_ : PartitionOf(hash);
+      if (partition == memory_partition_) {
+        build_row_ = hash_join_table_.Find(key_.data(), hash);
+      } else if (spill_partitions_[partition].build_->Size() > 0) {
+        // Joined once its partition is built
+        spill_partitions_[partition].probe_->Append(left_batch_.GetTuple(row));
+        continue;
+      }
+    }
+    if (build_row_ == JoinHashTable::NO_ROW && plan_->GetJoinType() != JoinType::LEFT) {
+      continue;
+    }
+    values_.clear();
+    for (uint32_t col_idx = 0; col_idx < left_width; col_idx++) {
+      values_.push_back(left_batch_.GetValueView(col_idx, row));
+    }
+    if (build_row_ == JoinHashTable::NO_ROW) {
+      for (uint32_t col_idx = 0; col_idx < right_width; col_idx++) {
+        values_.push_back(ValueFactory::GetNullValueByType(right_schema.GetColumn(col_idx).GetType()));
+      }
+      return true;
+    }
+  }
+  // The left columns stay in place while the matches of the row are walked
+  values_.resize(left_width);
+  const auto *build_values = hash_join_table_.GetRow(build_row_);
+  values_.insert(values_.end(), build_values, build_values + right_width);
+  build_row_ = hash_join_table_.NextRow(build_row_);
+  return true;
 }
 
 auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (output_tuples_iter_ == output_tuples_.cend()) {
+  if (!NextJoinedRow()) {
     return false;
   }
-  *tuple = *output_tuples_iter_;
-  ++output_tuples_iter_;
+  *tuple = Tuple(values_, &GetOutputSchema());
   return true;
 }
 
+auto HashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && NextJoinedRow()) {
+    batch->AppendValues(values_);
+  }
+  return batch->GetRowCount() > 0;
+}
+
 }  // namespace hmssql
@@ -33,24 +33,26 @@ void IndexScanExecutor::Init() {
 }
 
 auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  // The index may point at tuples the snapshot of the transaction does not contain, skip those
+  auto *txn = exec_ctx_->GetTransaction();
   if (plan_->filter_predicate_ != nullptr) {
-    if (rid_iter_ != rids_.end()) {
+    while (rid_iter_ != rids_.end()) {
       *rid = *rid_iter_;
-
-      auto result = table_info_->table_->GetTuple(*rid, tuple);
       rid_iter_++;
-      return result;
+      if (table_info_->table_->GetTuple(*rid, tuple, txn)) {
+        return true;
+      }
     }
     return false;
   }
-  if (iter_ == tree_->GetEndIterator()) {
-    return false;
+  while (iter_ != tree_->GetEndIterator()) {
+    *rid = (*iter_).second;
+    ++iter_;
+    if (table_info_->table_->GetTuple(*rid, tuple, txn)) {
+      return true;
+    }
   }
-  *rid = (*iter_).second;
-  auto result = table_info_->table_->GetTuple(*rid, tuple);
-  ++iter_;
-
-  return result;
+  return false;
 }
 
 }  // namespace hmssql
\ No newline at end of file
@@ -11,7 +11,9 @@
 
 #include <memory>
 
+#include "../include/common/exception.h"
 #include "../include/execution/executors/insert_executor.h"
+#include "fmt/format.h"
 
 namespace hmssql {
 
@@ -22,6 +24,12 @@ InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *
 }
 
 void InsertExecutor::Init() {
+  // New rows are invisible to everybody else until the commit, the table lock is enough
+  auto *lock_manager = exec_ctx_->GetLockManager();
+  if (lock_manager != nullptr &&
+      !lock_manager->LockTable(exec_ctx_->GetTransaction(), LockMode::INTENTION_EXCLUSIVE, table_info_->oid_)) {
+    throw ExecutionException(fmt::format("deadlock detected while locking table {}", table_info_->name_));
+  }
   child_executor_->Init();
   table_indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
 }
@@ -34,15 +42,20 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   RID emit_rid;
   int32_t insert_count = 0;
 
+  auto *txn = exec_ctx_->GetTransaction();
+
   while (child_executor_->Next(&to_insert_tuple, &emit_rid)) {
-    bool inserted = table_info_->table_->InsertTuple(to_insert_tuple, rid);
+    bool inserted = table_info_->table_->InsertTuple(to_insert_tuple, rid, txn);
 
     if (inserted) {
       std::for_each(table_indexes_.begin(), table_indexes_.end(),
-                    [&to_insert_tuple, &rid, &table_info = table_info_, &exec_ctx = exec_ctx_](IndexInfo *index) {
-                      index->index_->InsertEntry(to_insert_tuple.KeyFromTuple(table_info->schema_, index->key_schema_,
-                                                                              index->index_->GetKeyAttrs()),
-                                                 *rid);
+                    [&to_insert_tuple, &rid, &table_info = table_info_, txn](IndexInfo *index) {
+                      auto key = to_insert_tuple.KeyFromTuple(table_info->schema_, index->key_schema_,
+                                                              index->index_->GetKeyAttrs());
+                      index->index_->InsertEntry(key, *rid);
+                      if (txn != nullptr) {
+                        txn->AppendIndexWriteRecord(IndexWriteRecord{index->index_.get(), key, *rid, true});
+                      }
                     });
       insert_count++;
     }
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/executors/merge_join_executor.h"
+
+#include <algorithm>
+
+#include "../include/type/value_factory.h"
+
+namespace hmssql {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_child,
+                                     std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      left_executor_{std::move(left_child)},
+      right_executor_(std::move(right_child)) {
+  if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
+    throw hmssql::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
+  }
+}
+
+void MergeJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  left_ = SortedInput{};
+  left_.executor_ = left_executor_.get();
+  left_.key_expressions_ = &plan_->LeftJoinKeyExpressions();
+  right_ = SortedInput{};
+  right_.executor_ = right_executor_.get();
+  right_.key_expressions_ = &plan_->RightJoinKeyExpressions();
+  run_.clear();
+  has_run_ = false;
+  run_row_ = 0;
+  run_rows_ = 0;
+}
+
+auto MergeJoinExecutor::SortedInput::HasRow() -> bool {
+  while (!done_ && idx_ >= batch_.Size()) {
+    if (!executor_->NextBatch(&batch_)) {
+      done_ = true;
+      break;
+    }
+    keys_.resize(key_expressions_->size());
+    for (size_t i = 0; i < key_expressions_->size(); i++) {
+      (*key_expressions_)[i]->EvaluateBatch(batch_, &keys_[i]);
+    }
+    idx_ = 0;
+  }
+  return !done_;
+}
+
+void MergeJoinExecutor::SortedInput::GatherKey(std::vector<Value> *key) const {
+  key->clear();
+  auto row = Row();
+  for (const auto &column : keys_) {
+    key->push_back(column.GetValue(row));
+  }
+}
+
+auto MergeJoinExecutor::CompareKeys(const std::vector<Value> &a, const std::vector<Value> &b) -> int {
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].CompareLessThan(b[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (a[i].CompareGreaterThan(b[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+auto MergeJoinExecutor::HasNull(const std::vector<Value> &key) -> bool {
+  return std::any_of(key.begin(), key.end(), [](const Value &value) { return value.IsNull(); });
+}
+
+auto MergeJoinExecutor::SeekRun(const std::vector<Value> &key) -> bool {
+  if (has_run_) {
+    auto cmp = CompareKeys(run_key_, key);
+    if (cmp >= 0) {
+      // The run is the one of key, or the right side has nothing for key
+      return cmp == 0;
+    }
+  }
+
+  // The run is behind key, the right rows up to key are skipped without being copied
+  run_.clear();
+  run_rows_ = 0;
+  has_run_ = false;
+  while (right_.HasRow()) {
+    right_.GatherKey(&right_key_);
+    if (!HasNull(right_key_) && CompareKeys(right_key_, key) >= 0) {
+      break;
+    }
+    right_.idx_++;
+  }
+  if (right_.done_) {
+    return false;
+  }
+
+  run_key_ = right_key_;
+  has_run_ = true;
+  auto right_width = plan_->GetRightPlan()->OutputSchema().GetColumnCount();
+  do {
+    auto row = right_.Row();
+    for (uint32_t col_idx = 0; col_idx < right_width; col_idx++) {
+      run_.push_back(right_.batch_.GetValue(col_idx, row));
+    }
+    run_rows_++;
+    right_.idx_++;
+    if (!right_.HasRow()) {
+      break;
+    }
+    right_.GatherKey(&right_key_);
+  } while (!HasNull(right_key_) && CompareKeys(right_key_, run_key_) == 0);
+  return CompareKeys(run_key_, key) == 0;
+}
+
+auto MergeJoinExecutor::NextJoinedRow() -> bool {
+  auto left_width = plan_->GetLeftPlan()->OutputSchema().GetColumnCount();
+  auto right_width = plan_->GetRightPlan()->OutputSchema().GetColumnCount();
+  while (run_row_ >= run_rows_) {
+    // An inner join is done once the right side is
+    if (plan_->GetJoinType() == JoinType::INNER && right_.done_ && !has_run_) {
+      return false;
+    }
+    if (!left_.HasRow()) {
+      return false;
+    }
+    auto row = left_.Row();
+    left_.GatherKey(&left_key_);
+    bool matched = !HasNull(left_key_) && SeekRun(left_key_);
+    if (!matched && plan_->GetJoinType() != JoinType::LEFT) {
+      left_.idx_++;
+      continue;
+    }
+    values_.clear();
+    for (uint32_t col_idx = 0; col_idx < left_width; col_idx++) {
+      values_.push_back(left_.batch_.GetValue(col_idx, row));
+    }
+    left_.idx_++;
+    if (!matched) {
+      const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+      for (uint32_t col_idx = 0; col_idx < right_width; col_idx++) {
+        values_.push_back(ValueFactory::GetNullValueByType(right_schema.GetColumn(col_idx).GetType()));
+      }
+      return true;
+    }
+    run_row_ = 0;
+  }
+  // The left columns stay in place while the run is walked
+  values_.resize(left_width);
+  auto first = run_.begin() + run_row_ * right_width;
+  values_.insert(values_.end(), first, first + right_width);
+  run_row_++;
+  return true;
+}
+
+auto MergeJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (!NextJoinedRow()) {
+    return false;
+  }
+  *tuple = Tuple(values_, &GetOutputSchema());
+  return true;
+}
+
+auto MergeJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && NextJoinedRow()) {
+    batch->AppendValues(values_);
+  }
+  return batch->GetRowCount() > 0;
+}
+
+}  // namespace hmssql
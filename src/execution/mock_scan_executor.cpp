@@ -16,6 +16,7 @@
 #include "../include/common/exception.h"
 #include "../include/common/util/string_util.h"
 #include "../include/execution/expressions/column_value_expression.h"
+#include "../include/execution/parallel_state.h"
 #include "../include/type/type_id.h"
 #include "../include/type/value_factory.h"
 
@@ -393,14 +394,28 @@ MockScanExecutor::MockScanExecutor(ExecutorContext *exec_ctx, const MockScanPlan
 void MockScanExecutor::Init() {
   // Reset the cursor
   cursor_ = 0;
+  end_ = size_;
+  auto *parallel_state = exec_ctx_->GetParallelState();
+  if (parallel_state != nullptr) {
+    shared_cursor_ = parallel_state->GetOrCreate<std::atomic<size_t>>(
+        plan_, [] { return std::make_unique<std::atomic<size_t>>(0); });
+    end_ = 0;
+  }
 }
 
 auto MockScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (cursor_ == size_) {
-    // Scan complete
-    return EXECUTOR_EXHAUSTED;
+  if (cursor_ == end_) {
+    if (shared_cursor_ == nullptr) {
+      // Scan complete
+      return EXECUTOR_EXHAUSTED;
+    }
+    cursor_ = std::min(shared_cursor_->fetch_add(TUPLE_BATCH_SIZE), size_);
+    end_ = std::min(cursor_ + TUPLE_BATCH_SIZE, size_);
+    if (cursor_ == end_) {
+      return EXECUTOR_EXHAUSTED;
+    }
   }
-  if (shuffled_idx_.empty()) {
+  if (shuffled_idx_.empty() || shared_cursor_ != nullptr) {
     *tuple = func_(cursor_);
   } else {
     *tuple = func_(shuffled_idx_[cursor_]);
@@ -40,8 +40,7 @@ auto NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     tree_->ScanKey(Tuple{{value}, index_info_->index_->GetKeySchema()}, &rids);
 
     Tuple right_tuple{};
-    if (!rids.empty()) {
-      table_info_->table_->GetTuple(rids[0], &right_tuple);
+    if (!rids.empty() && table_info_->table_->GetTuple(rids[0], &right_tuple, exec_ctx_->GetTransaction())) {
       for (uint32_t idx = 0; idx < child_->GetOutputSchema().GetColumnCount(); idx++) {
         vals.push_back(left_tuple.GetValue(&child_->GetOutputSchema(), idx));
       }
@@ -13,24 +13,35 @@ void ProjectionExecutor::Init() {
 }
 
 auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  Tuple child_tuple{};
-
   // Get the next tuple
-  const auto status = child_executor_->Next(&child_tuple, rid);
+  const auto status = child_executor_->Next(&child_tuple_, rid);
 
   if (!status) {
     return false;
   }
 
   // Compute expressions
-  std::vector<Value> values{};
-  values.reserve(GetOutputSchema().GetColumnCount());
+  values_.clear();
   for (const auto &expr : plan_->GetExpressions()) {
-    values.push_back(expr->Evaluate(&child_tuple, child_executor_->GetOutputSchema()));
+    values_.push_back(expr->Evaluate(&child_tuple_, child_executor_->GetOutputSchema()));
   }
 
-  *tuple = Tuple{values, &GetOutputSchema()};
+  *tuple = Tuple{values_, &GetOutputSchema()};
+
+  return true;
+}
 
+auto ProjectionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  if (!child_executor_->NextBatch(&child_batch_)) {
+    return false;
+  }
+  batch->Reset(&GetOutputSchema());
+  const auto &exprs = plan_->GetExpressions();
+  for (uint32_t col_idx = 0; col_idx < exprs.size(); col_idx++) {
+    exprs[col_idx]->EvaluateBatch(child_batch_, &batch->GetColumn(col_idx));
+  }
+  // The rows the child dropped stay unselected
+  batch->InheritRows(child_batch_);
   return true;
 }
 }  // namespace hmssql
@@ -0,0 +1,339 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// radix_hash_join_executor.cpp
+//
+// Identification: src/execution/radix_hash_join_executor.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/executors/radix_hash_join_executor.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "../include/execution/parallel_state.h"
+#include "../include/type/value_factory.h"
+
+namespace hmssql {
+
+namespace {
+
+/** The partition of a hash in the pass that takes bits of it starting at shift */
+inline auto RadixOf(hash_t hash, uint32_t shift, uint32_t bits) -> uint32_t {
+  return static_cast<uint32_t>(hash >> shift) & ((1U << bits) - 1);
+}
+
+/** The first pass splits by the bits above the low 32, the second by the ones above those */
+constexpr uint32_t FIRST_PASS_SHIFT = 32;
+constexpr uint32_t SECOND_PASS_SHIFT = FIRST_PASS_SHIFT + RADIX_JOIN_BITS;
+
+}  // namespace
+
+void RadixPartition::Append(const TupleBatch &source, uint32_t row, hash_t hash) {
+  if (batches_.empty() || batches_.back().IsFull()) {
+    batches_.emplace_back();
+    batches_.back().Reset(source.GetSchema());
+  }
+  batches_.back().AppendRow(source, row);
+  hashes_.push_back(hash);
+}
+
+void RadixPartition::Clear() {
+  batches_ = {};
+  hashes_ = {};
+}
+
+RadixJoinState::RadixJoinState(size_t workers) : build_(workers), probe_(workers) {
+  for (size_t i = 0; i < workers; i++) {
+    build_[i].resize(PARTITIONS);
+    probe_[i].resize(PARTITIONS);
+  }
+}
+
+auto RadixJoinState::ArriveAndWait() -> bool {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (++arrived_ == build_.size()) {
+    cv_.notify_all();
+  }
+  cv_.wait(lock, [&] { return abandoned_ || arrived_ == build_.size(); });
+  return !abandoned_;
+}
+
+void RadixJoinState::Abandon() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  abandoned_ = true;
+  cv_.notify_all();
+}
+
+auto RadixJoinState::TakePartition() -> uint32_t {
+  auto partition = next_partition_.fetch_add(1);
+  return std::min(partition, PARTITIONS);
+}
+
+RadixHashJoinExecutor::RadixHashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                                             std::unique_ptr<AbstractExecutor> &&left_child,
+                                             std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      left_executor_{std::move(left_child)},
+      right_executor_(std::move(right_child)) {
+  if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
+    throw hmssql::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
+  }
+}
+
+void RadixHashJoinExecutor::Init() {
+  auto *parallel_state = exec_ctx_->GetParallelState();
+  BUSTUB_ASSERT(parallel_state != nullptr, "radix joins run in the workers of a parallel pipeline");
+  BUSTUB_ASSERT(exec_ctx_->GetWorkerIndex() < plan_->GetRadixWorkers(), "one worker of the join each");
+  state_ = parallel_state->GetOrCreate<RadixJoinState>(
+      plan_, [&] { return std::make_unique<RadixJoinState>(plan_->GetRadixWorkers()); });
+
+  hash_join_table_.Reset(plan_->RightJoinKeyExpressions().size(),
+                         plan_->GetRightPlan()->OutputSchema().GetColumnCount());
+  try {
+    auto worker = exec_ctx_->GetWorkerIndex();
+    right_executor_->Init();
+    Partition(right_executor_.get(), plan_->RightJoinKeyExpressions(), false, &state_->GetBuildPartitions(worker));
+    left_executor_->Init();
+    Partition(left_executor_.get(), plan_->LeftJoinKeyExpressions(), plan_->GetJoinType() == JoinType::LEFT,
+              &state_->GetProbePartitions(worker));
+  } catch (...) {
+    state_->Abandon();
+    throw;
+  }
+  joinable_ = state_->ArriveAndWait();
+
+  pairs_.clear();
+  pair_idx_ = 0;
+  probe_batch_ = nullptr;
+  build_row_ = JoinHashTable::NO_ROW;
+  current_batch_.Reset(&GetOutputSchema());
+  current_idx_ = 0;
+}
+
+void RadixHashJoinExecutor::Partition(AbstractExecutor *child,
+                                      const std::vector<AbstractExpressionRef> &key_expressions, bool keep_nulls,
+                                      std::vector<RadixPartition> *partitions) {
+  TupleBatch batch;
+  while (child->NextBatch(&batch)) {
+    EvaluateKeys(key_expressions, batch);
+    for (uint32_t i = 0; i < batch.Size(); i++) {
+      auto row = batch.RowAt(i);
+      GatherKey(row);
+      if (hash_join_table_.HasNull(key_.data())) {
+        if (keep_nulls) {
+          (*partitions)[0].Append(batch, row, 0);
+        }
+        continue;
+      }
+      auto hash = hash_join_table_.HashKey(key_.data());
+      (*partitions)[RadixOf(hash, FIRST_PASS_SHIFT, RADIX_JOIN_BITS)].Append(batch, row, hash);
+    }
+  }
+}
+
+auto RadixHashJoinExecutor::TakePartition() -> bool {
+  bool left_join = plan_->GetJoinType() == JoinType::LEFT;
+  while (true) {
+    auto partition = state_->TakePartition();
+    if (partition == RadixJoinState::PARTITIONS) {
+      return false;
+    }
+    PartitionPair pair;
+    size_t build_rows = 0;
+    size_t probe_rows = 0;
+    for (size_t worker = 0; worker < state_->GetWorkers(); worker++) {
+      pair.build_.push_back(&state_->GetBuildPartitions(worker)[partition]);
+      pair.probe_.push_back(&state_->GetProbePartitions(worker)[partition]);
+      build_rows += pair.build_.back()->RowCount();
+      probe_rows += pair.probe_.back()->RowCount();
+    }
+    pairs_.clear();
+    pair_idx_ = 0;
+    split_build_.clear();
+    split_probe_.clear();
+    if (probe_rows == 0 || (build_rows == 0 && !left_join)) {
+      for (size_t i = 0; i < pair.build_.size(); i++) {
+        pair.build_[i]->Clear();
+        pair.probe_[i]->Clear();
+      }
+      continue;
+    }
+
+    // The build side of the partition takes about this much room in the JoinHashTable
+    auto row_values = plan_->GetRightPlan()->OutputSchema().GetColumnCount() + plan_->RightJoinKeyExpressions().size();
+    auto row_bytes = row_values * sizeof(Value) + sizeof(uint32_t);
+    uint32_t bits = 0;
+    while (bits < RADIX_JOIN_BITS && (build_rows * row_bytes >> bits) > RADIX_JOIN_PARTITION_BYTES) {
+      bits++;
+    }
+    if (bits == 0) {
+      pairs_.push_back(std::move(pair));
+      return true;
+    }
+
+    // The second pass, the rows with null keys of a left join stay in the first part
+    split_build_.resize(1 << bits);
+    split_probe_.resize(1 << bits);
+    auto split = [&](const std::vector<RadixPartition *> &parts, std::vector<RadixPartition> *split_parts) {
+      for (auto *part : parts) {
+        const auto &batches = part->GetBatches();
+        for (size_t batch_idx = 0; batch_idx < batches.size(); batch_idx++) {
+          for (uint32_t row = 0; row < batches[batch_idx].GetRowCount(); row++) {
+            auto hash = part->GetHash(batch_idx, row);
+            (*split_parts)[RadixOf(hash, SECOND_PASS_SHIFT, bits)].Append(batches[batch_idx], row, hash);
+          }
+        }
+        part->Clear();
+      }
+    };
+    split(pair.build_, &split_build_);
+    split(pair.probe_, &split_probe_);
+    for (size_t i = 0; i < split_build_.size(); i++) {
+      if (split_probe_[i].RowCount() > 0 && (split_build_[i].RowCount() > 0 || left_join)) {
+        pairs_.push_back(PartitionPair{{&split_build_[i]}, {&split_probe_[i]}});
+      }
+    }
+    if (!pairs_.empty()) {
+      return true;
+    }
+  }
+}
+
+auto RadixHashJoinExecutor::NextPair() -> bool {
+  // The probe side of the pair joined last is not needed anymore
+  if (pair_idx_ > 0) {
+    for (auto *part : pairs_[pair_idx_ - 1].probe_) {
+      part->Clear();
+    }
+  }
+  if (pair_idx_ >= pairs_.size() && !TakePartition()) {
+    return false;
+  }
+
+  const auto &pair = pairs_[pair_idx_++];
+  const auto &right_keys = plan_->RightJoinKeyExpressions();
+  hash_join_table_.Reset(right_keys.size(), plan_->GetRightPlan()->OutputSchema().GetColumnCount());
+  for (auto *part : pair.build_) {
+    const auto &batches = part->GetBatches();
+    for (size_t batch_idx = 0; batch_idx < batches.size(); batch_idx++) {
+      EvaluateKeys(right_keys, batches[batch_idx]);
+      for (uint32_t row = 0; row < batches[batch_idx].GetRowCount(); row++) {
+        GatherKey(row);
+        hash_join_table_.Insert(key_.data(), part->GetHash(batch_idx, row), batches[batch_idx], row);
+      }
+    }
+    part->Clear();
+  }
+  probe_part_idx_ = 0;
+  probe_batch_idx_ = 0;
+  probe_batch_ = nullptr;
+  return true;
+}
+
+auto RadixHashJoinExecutor::NextProbeBatch() -> bool {
+  if (probe_batch_ != nullptr) {
+    probe_batch_idx_++;
+  } else if (!NextPair()) {
+    return false;
+  }
+  while (true) {
+    const auto &probe = pairs_[pair_idx_ - 1].probe_;
+    if (probe_part_idx_ >= probe.size()) {
+      if (!NextPair()) {
+        return false;
+      }
+      continue;
+    }
+    const auto &batches = probe[probe_part_idx_]->GetBatches();
+    if (probe_batch_idx_ >= batches.size()) {
+      probe_part_idx_++;
+      probe_batch_idx_ = 0;
+      continue;
+    }
+    probe_batch_ = &batches[probe_batch_idx_];
+    EvaluateKeys(plan_->LeftJoinKeyExpressions(), *probe_batch_);
+    left_idx_ = 0;
+    return true;
+  }
+}
+
+void RadixHashJoinExecutor::EvaluateKeys(const std::vector<AbstractExpressionRef> &key_expressions,
+                                         const TupleBatch &batch) {
+  keys_.resize(key_expressions.size());
+  for (size_t i = 0; i < key_expressions.size(); i++) {
+    key_expressions[i]->EvaluateBatch(batch, &keys_[i]);
+  }
+}
+
+void RadixHashJoinExecutor::GatherKey(uint32_t row) {
+  key_.clear();
+  for (const auto &column : keys_) {
+    key_.push_back(column.GetValueView(row));
+  }
+}
+
+auto RadixHashJoinExecutor::NextJoinedRow() -> bool {
+  const auto &right_schema = plan_->GetRightPlan()->OutputSchema();
+  auto left_width = plan_->GetLeftPlan()->OutputSchema().GetColumnCount();
+  auto right_width = right_schema.GetColumnCount();
+  while (build_row_ == JoinHashTable::NO_ROW) {
+    if (probe_batch_ == nullptr || left_idx_ >= probe_batch_->GetRowCount()) {
+      if (!joinable_ || !NextProbeBatch()) {
+        // The pairs are gone once the partitions ran out, later calls must not look at them
+        joinable_ = false;
+        return false;
+      }
+      continue;
+    }
+    auto row = left_idx_++;
+    GatherKey(row);
+    if (!hash_join_table_.HasNull(key_.data())) {
+      auto hash = pairs_[pair_idx_ - 1].probe_[probe_part_idx_]->GetHash(probe_batch_idx_, row);
+      build_row_ = hash_join_table_.Find(key_.data(), hash);
+    }
+    if (build_row_ == JoinHashTable::NO_ROW && plan_->GetJoinType() != JoinType::LEFT) {
+      continue;
+    }
+    values_.clear();
+    for (uint32_t col_idx = 0; col_idx < left_width; col_idx++) {
+      values_.push_back(probe_batch_->GetValueView(col_idx, row));
+    }
+    if (build_row_ == JoinHashTable::NO_ROW) {
+      for (uint32_t col_idx = 0; col_idx < right_width; col_idx++) {
+        values_.push_back(ValueFactory::GetNullValueByType(right_schema.GetColumn(col_idx).GetType()));
+      }
+      return true;
+    }
+  }
+  values_.resize(left_width);
+  const auto *build_values = hash_join_table_.GetRow(build_row_);
+  values_.insert(values_.end(), build_values, build_values + right_width);
+  build_row_ = hash_join_table_.NextRow(build_row_);
+  return true;
+}
+
+auto RadixHashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (current_idx_ >= current_batch_.Size()) {
+    if (!NextBatch(&current_batch_)) {
+      return false;
+    }
+    current_idx_ = 0;
+  }
+  *tuple = current_batch_.GetTuple(current_batch_.RowAt(current_idx_++));
+  return true;
+}
+
+auto RadixHashJoinExecutor::NextBatch(TupleBatch *batch) -> bool {
+  batch->Reset(&GetOutputSchema());
+  while (!batch->IsFull() && NextJoinedRow()) {
+    batch->AppendValues(values_);
+  }
+  return batch->GetRowCount() > 0;
+}
+
+}  // namespace hmssql
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// repartition_executor.cpp
+//
+// Identification: src/execution/repartition_executor.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/executors/repartition_executor.h"
+
+#include <utility>
+
+#include "../include/common/util/hash_util.h"
+#include "../include/execution/executor_factory.h"
+
+namespace hmssql {
+
+RepartitionState::RepartitionState(ExecutorContext *exec_ctx, const RepartitionPlanNode *plan) : plan_(plan) {
+  BUSTUB_ASSERT(exec_ctx->GetThreadPool() != nullptr, "parallel plans need a thread pool");
+  for (size_t i = 0; i < plan_->GetPartitions(); i++) {
+    partitions_.push_back(std::make_unique<ExchangeQueue>(plan_->GetProducers()));
+  }
+  // A single producer runs the child as a serial plan, several split its scans like the workers of a gather
+  if (plan_->GetProducers() > 1) {
+    parallel_state_ = std::make_unique<ParallelState>();
+  }
+  for (size_t i = 0; i < plan_->GetProducers(); i++) {
+    producer_ctxs_.push_back(std::make_unique<ExecutorContext>(exec_ctx, parallel_state_.get(), i));
+    producer_executors_.push_back(
+        ExecutorFactory::CreateExecutor(producer_ctxs_.back().get(), plan_->GetChildPlan()));
+  }
+  for (auto &executor : producer_executors_) {
+    producers_.push_back(exec_ctx->GetThreadPool()->Submit([this, child = executor.get()] { RunProducer(child); }));
+  }
+}
+
+RepartitionState::~RepartitionState() {
+  for (auto &partition : partitions_) {
+    partition->Close();
+  }
+  for (auto &producer : producers_) {
+    producer.wait();
+  }
+  producer_executors_.clear();
+  producer_ctxs_.clear();
+  parallel_state_.reset();
+}
+
+void RepartitionState::RunProducer(AbstractExecutor *child) {
+  try {
+    child->Init();
+    const auto &schema = child->GetOutputSchema();
+    const auto &keys = plan_->GetPartitionKeys();
+    std::vector<TupleBatch> outputs(partitions_.size());
+    for (auto &output : outputs) {
+      output.Reset(&schema);
+    }
+    std::vector<bool> closed(partitions_.size(), false);
+    size_t open = partitions_.size();
+    TupleBatch batch;
+    std::vector<ColumnVector> key_columns(keys.size());
+    while (open > 0 && child->NextBatch(&batch)) {
+      for (size_t k = 0; k < keys.size(); k++) {
+        keys[k]->EvaluateBatch(batch, &key_columns[k]);
+      }
+      for (uint32_t i = 0; i < batch.Size(); i++) {
+        auto row = batch.RowAt(i);
+        hash_t hash = 0;
+        for (const auto &column : key_columns) {
+          auto key = column.GetValueView(row);
+          hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&key));
+        }
+        auto partition = hash % partitions_.size();
+        if (closed[partition]) {
+          continue;
+        }
+        outputs[partition].AppendRow(batch, row);
+        if (outputs[partition].IsFull() && !PushPartition(partition, &outputs)) {
+          closed[partition] = true;
+          open--;
+        }
+      }
+    }
+    for (size_t partition = 0; partition < partitions_.size(); partition++) {
+      if (!closed[partition] && outputs[partition].GetRowCount() > 0) {
+        PushPartition(partition, &outputs);
+      }
+      partitions_[partition]->ProducerDone();
+    }
+  } catch (...) {
+    for (auto &partition : partitions_) {
+      partition->Fail(std::current_exception());
+    }
+  }
+}
+
+auto RepartitionState::PushPartition(size_t partition, std::vector<TupleBatch> *outputs) -> bool {
+  const auto *schema = (*outputs)[partition].GetSchema();
+  bool pushed = partitions_[partition]->Push(std::move((*outputs)[partition]));
+  (*outputs)[partition].Reset(schema);
+  return pushed;
+}
+
+RepartitionExecutor::RepartitionExecutor(ExecutorContext *exec_ctx, const RepartitionPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+RepartitionExecutor::~RepartitionExecutor() {
+  // Producers blocked on a full partition nobody reads would never finish
+  if (state_ != nullptr) {
+    state_->GetPartition(exec_ctx_->GetWorkerIndex()).Close();
+  }
+}
+
+void RepartitionExecutor::Init() {
+  auto *parallel_state = exec_ctx_->GetParallelState();
+  BUSTUB_ASSERT(parallel_state != nullptr, "repartition runs in a worker of a parallel pipeline");
+  BUSTUB_ASSERT(exec_ctx_->GetWorkerIndex() < plan_->GetPartitions(), "one partition per worker");
+  state_ = parallel_state->GetOrCreate<RepartitionState>(
+      plan_, [&] { return std::make_unique<RepartitionState>(exec_ctx_, plan_); });
+  current_batch_.Reset(&GetOutputSchema());
+  current_idx_ = 0;
+}
+
+auto RepartitionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (current_idx_ >= current_batch_.Size()) {
+    if (!NextBatch(&current_batch_)) {
+      return false;
+    }
+    current_idx_ = 0;
+  }
+  auto row = current_batch_.RowAt(current_idx_++);
+  *tuple = current_batch_.GetTuple(row);
+  *rid = current_batch_.GetRid(row);
+  return true;
+}
+
+auto RepartitionExecutor::NextBatch(TupleBatch *batch) -> bool {
+  return state_->GetPartition(exec_ctx_->GetWorkerIndex()).Pop(batch);
+}
+
+}  // namespace hmssql
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// runtime_filter.cpp
+//
+// Identification: src/execution/runtime_filter.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/runtime_filter.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace hmssql {
+
+BlockedBloomFilter::BlockedBloomFilter(size_t keys) {
+  // A power of two of blocks, so the block is picked by a mask
+  size_t bits = std::max<size_t>(keys, 1) * RUNTIME_FILTER_BITS_PER_KEY;
+  size_t block_count = 1;
+  while (block_count * sizeof(Block) * 8 < bits) {
+    block_count *= 2;
+  }
+  blocks_.assign(block_count, Block{});
+}
+
+auto BlockedBloomFilter::MaskOf(hash_t hash) -> Block {
+  // The salts of the split block bloom filter of Parquet
+  static constexpr std::array<uint32_t, 8> SALTS = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                                    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+  auto key = static_cast<uint32_t>(hash);
+  Block mask;
+  for (size_t i = 0; i < mask.size(); i++) {
+    mask[i] = 1U << ((key * SALTS[i]) >> 27);
+  }
+  return mask;
+}
+
+void BlockedBloomFilter::Insert(hash_t hash) {
+  auto &block = blocks_[BlockOf(hash)];
+  auto mask = MaskOf(hash);
+  for (size_t i = 0; i < block.size(); i++) {
+    block[i] |= mask[i];
+  }
+}
+
+auto BlockedBloomFilter::MayContain(hash_t hash) const -> bool {
+  const auto &block = blocks_[BlockOf(hash)];
+  auto mask = MaskOf(hash);
+  uint32_t missing = 0;
+  for (size_t i = 0; i < block.size(); i++) {
+    missing |= mask[i] & ~block[i];
+  }
+  return missing == 0;
+}
+
+RuntimeFilter::RuntimeFilter(std::vector<uint32_t> key_columns, BlockedBloomFilter bloom)
+    : key_columns_(std::move(key_columns)), bloom_(std::move(bloom)) {}
+
+auto RuntimeFilter::MayMatch(const Tuple &tuple, const Schema *schema) -> bool {
+  if (!enabled_) {
+    return true;
+  }
+  key_.clear();
+  for (auto col_idx : key_columns_) {
+    key_.push_back(tuple.GetValue(schema, col_idx));
+  }
+  bool pass = std::none_of(key_.begin(), key_.end(), [](const Value &value) { return value.IsNull(); }) &&
+              bloom_.MayContain(HashUtil::HashValues(key_.data(), key_.size()));
+  if (checked_ < RUNTIME_FILTER_SAMPLE_ROWS) {
+    checked_++;
+    passed_ += pass ? 1 : 0;
+    if (checked_ == RUNTIME_FILTER_SAMPLE_ROWS && passed_ * 8 > checked_ * 7) {
+      enabled_ = false;
+    }
+  }
+  return pass;
+}
+
+}  // namespace hmssql
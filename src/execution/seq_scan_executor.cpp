@@ -11,6 +11,9 @@
 
 #include "../include/execution/executors/seq_scan_executor.h"
 
+#include <functional>
+#include <memory>
+
 namespace hmssql {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
@@ -19,21 +22,104 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
 }
 
 void SeqScanExecutor::Init() {
-  this->table_iter_ = table_info_->table_->Begin();
+  runtime_filter_ = nullptr;
+  auto *parallel_state = exec_ctx_->GetParallelState();
+  if (parallel_state == nullptr) {
+    this->table_iter_ = table_info_->table_->Begin(exec_ctx_->GetTransaction());
+    return;
+  }
+  dispenser_ = parallel_state->GetOrCreate<MorselDispenser>(
+      plan_, [&] { return std::make_unique<MorselDispenser>(table_info_->table_.get()); });
+  page_ids_.clear();
+  page_idx_ = 0;
+  tuples_.clear();
+  tuple_idx_ = 0;
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   do {
-    if (table_iter_ == table_info_->table_->End()) {
-      return false;
+    if (ReadsPages()) {
+      const auto *next = NextPageTuple();
+      if (next == nullptr) {
+        return false;
+      }
+      *tuple = *next;
+    } else {
+      if (table_iter_ == table_info_->table_->End()) {
+        return false;
+      }
+      *tuple = *table_iter_;
+      ++table_iter_;
     }
-    *tuple = *table_iter_;
     *rid = tuple->GetRid();
-    ++table_iter_;
   } while (plan_->filter_predicate_ != nullptr &&
           !plan_->filter_predicate_->Evaluate(tuple, table_info_->schema_).GetAs<bool>());
 
   return true;
 }
 
+auto SeqScanExecutor::NextBatch(TupleBatch *batch) -> bool {
+  do {
+    // Tuples are laid out by the table schema, it is what the predicate is evaluated against as well
+    batch->Reset(&table_info_->schema_);
+    if (ReadsPages()) {
+      const Tuple *next;
+      while (!batch->IsFull() && (next = NextPageTuple()) != nullptr) {
+        batch->AppendTuple(*next, next->GetRid());
+      }
+    } else {
+      while (!batch->IsFull() && table_iter_ != table_info_->table_->End()) {
+        batch->AppendTuple(*table_iter_, table_iter_->GetRid());
+        ++table_iter_;
+      }
+    }
+    if (batch->GetRowCount() == 0) {
+      return false;
+    }
+    if (plan_->filter_predicate_ != nullptr) {
+      batch->ApplyFilter(*plan_->filter_predicate_);
+    }
+  } while (batch->Size() == 0);
+  return true;
+}
+
+void SeqScanExecutor::SetRuntimeFilter(RuntimeFilter *filter) {
+  runtime_filter_ = filter;
+  if (!IsPartial()) {
+    // The iterator copies every tuple, the pages are read instead
+    page_ids_.clear();
+    page_idx_ = 0;
+    tuples_.clear();
+    tuple_idx_ = 0;
+    next_page_id_ = table_info_->table_->GetFirstPageId();
+  }
+}
+
+auto SeqScanExecutor::NextPageTuple() -> const Tuple * {
+  while (tuple_idx_ >= tuples_.size()) {
+    if (page_idx_ >= page_ids_.size()) {
+      if (IsPartial()) {
+        if (!dispenser_->Claim(&page_ids_)) {
+          return nullptr;
+        }
+      } else {
+        if (next_page_id_ == INVALID_PAGE_ID) {
+          return nullptr;
+        }
+        page_ids_.assign(1, next_page_id_);
+        next_page_id_ = table_info_->table_->GetNextPageId(next_page_id_);
+      }
+      page_idx_ = 0;
+    }
+    tuples_.clear();
+    tuple_idx_ = 0;
+    std::function<bool(const Tuple &)> keep;
+    if (runtime_filter_ != nullptr) {
+      keep = [this](const Tuple &tuple) { return runtime_filter_->MayMatch(tuple, &table_info_->schema_); };
+    }
+    table_info_->table_->ScanPage(page_ids_[page_idx_++], &tuples_, exec_ctx_->GetTransaction(), keep);
+  }
+  return &tuples_[tuple_idx_++];
+}
+
 }  // namespace hmssql
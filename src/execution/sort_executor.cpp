@@ -1,60 +1,258 @@
 #include "../include/execution/executors/sort_executor.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "../include/execution/executor_factory.h"
+#include "../include/execution/parallel_state.h"
+
 namespace hmssql {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_{plan}, child_{std::move(child_executor)} {}
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      child_{std::move(child_executor)},
+      sort_keys_(plan->GetOrderBy(), &plan->GetChildPlan()->OutputSchema()) {}
 
 void SortExecutor::Init() {
-  child_->Init();
+  shares_.clear();
+  merged_.clear();
+  merged_range_ = 0;
+  merged_row_ = 0;
+  runs_.clear();
+  first_run_ = 0;
+  merge_runs_.clear();
+
+  auto workers = plan_->GetWorkers();
+  if (workers == 0) {
+    shares_.resize(1);
+    child_->Init();
+    SortShare(child_.get(), exec_ctx_->GetWorkMem(), &shares_[0]);
+  } else {
+    BUSTUB_ASSERT(exec_ctx_->GetThreadPool() != nullptr, "parallel plans need a thread pool");
+    // The executors go before the state they share
+    auto parallel_state = std::make_unique<ParallelState>();
+    std::vector<std::unique_ptr<ExecutorContext>> worker_ctxs;
+    std::vector<std::unique_ptr<AbstractExecutor>> worker_executors;
+    for (size_t i = 0; i < workers; i++) {
+      worker_ctxs.push_back(std::make_unique<ExecutorContext>(exec_ctx_, parallel_state.get(), i));
+      worker_executors.push_back(ExecutorFactory::CreateExecutor(worker_ctxs.back().get(), plan_->GetChildPlan()));
+    }
+    shares_.resize(workers);
+    exec_ctx_->GetThreadPool()->RunAll(workers, [&](size_t worker) {
+      worker_executors[worker]->Init();
+      SortShare(worker_executors[worker].get(), exec_ctx_->GetWorkMem() / workers, &shares_[worker]);
+    });
+  }
+
+  if (std::all_of(shares_.begin(), shares_.end(), [](const SortedShare &share) { return share.runs_.empty(); })) {
+    MergeShares();
+  } else {
+    MergeRuns();
+  }
+}
+
+void SortExecutor::SortShare(AbstractExecutor *child, size_t work_mem, SortedShare *share) {
+  size_t memory_usage = 0;
   Tuple child_tuple{};
   RID child_rid;
-  while (child_->Next(&child_tuple, &child_rid)) {
-    child_tuples_.push_back(child_tuple);
-  }
-
-  std::sort(
-      child_tuples_.begin(), child_tuples_.end(),
-      [order_bys = plan_->order_bys_, schema = child_->GetOutputSchema()](const Tuple &tuple_a, const Tuple &tuple_b) {
-        for (const auto &order_key : order_bys) {
-          switch (order_key.first) {
-            case OrderByType::INVALID:
-            case OrderByType::DEFAULT:
-            case OrderByType::ASC:
-              if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                        .CompareLessThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return true;
-              } else if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                               .CompareGreaterThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return false;
-              }
-              break;
-            case OrderByType::DESC:
-              if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                        .CompareGreaterThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return true;
-              } else if (static_cast<bool>(order_key.second->Evaluate(&tuple_a, schema)
-                                               .CompareLessThan(order_key.second->Evaluate(&tuple_b, schema)))) {
-                return false;
-              }
-              break;
-          }
-        }
-        return false;
-      });
-
-  child_iter_ = child_tuples_.begin();
+  while (child->Next(&child_tuple, &child_rid)) {
+    memory_usage += sizeof(Tuple) + child_tuple.GetLength() + sort_keys_.KeySize();
+    share->tuples_.push_back(child_tuple);
+    if (memory_usage > work_mem) {
+      SpillRun(share);
+      memory_usage = 0;
+    }
+  }
+  if (share->runs_.empty()) {
+    share->order_ = sort_keys_.Sort(share->tuples_, &share->keys_, &share->exact_);
+  }
+}
+
+void SortExecutor::SpillRun(SortedShare *share) {
+  auto run = std::make_unique<TmpTupleHeap>(exec_ctx_->GetTmpFile());
+  for (auto row : sort_keys_.Sort(share->tuples_, &share->keys_, &share->exact_)) {
+    run->Append(share->tuples_[row]);
+  }
+  share->runs_.push_back(std::move(run));
+  share->tuples_.clear();
+  share->keys_.clear();
+  share->exact_.clear();
+}
+
+auto SortExecutor::CompareRows(const SortedShare &share_a, uint32_t row_a, const SortedShare &share_b,
+                               uint32_t row_b) const -> int {
+  auto key_size = sort_keys_.KeySize();
+  return sort_keys_.Compare(share_a.tuples_[row_a], &share_a.keys_[row_a * key_size], share_a.exact_[row_a],
+                            share_b.tuples_[row_b], &share_b.keys_[row_b * key_size], share_b.exact_[row_b]);
+}
+
+void SortExecutor::MergeShares() {
+  auto ranges = shares_.size();
+  if (ranges == 1) {
+    auto &share = shares_[0];
+    merged_.resize(1);
+    merged_[0].reserve(share.order_.size());
+    for (auto row : share.order_) {
+      merged_[0].push_back(&share.tuples_[row]);
+    }
+    return;
+  }
+
+  // Rows evenly spaced in every share, the splitters evenly spaced among them once they are sorted
+  std::vector<std::pair<size_t, uint32_t>> samples;
+  for (size_t share = 0; share < ranges; share++) {
+    const auto &order = shares_[share].order_;
+    for (size_t i = 0; i < SORT_SPLITTER_SAMPLES && i < order.size(); i++) {
+      samples.emplace_back(share, order[i * order.size() / std::min(SORT_SPLITTER_SAMPLES, order.size())]);
+    }
+  }
+  auto less = [this](const std::pair<size_t, uint32_t> &a, const std::pair<size_t, uint32_t> &b) {
+    return CompareRows(shares_[a.first], a.second, shares_[b.first], b.second) < 0;
+  };
+  std::sort(samples.begin(), samples.end(), less);
+
+  // Rows equal to a splitter go to the range after it in every share
+  cuts_.assign(ranges, std::vector<size_t>(ranges + 1, 0));
+  for (size_t share = 0; share < ranges; share++) {
+    const auto &order = shares_[share].order_;
+    for (size_t range = 1; range < ranges; range++) {
+      if (samples.empty()) {
+        break;
+      }
+      const auto &splitter = samples[range * samples.size() / ranges];
+      auto first = order.begin() + cuts_[share][range - 1];
+      cuts_[share][range] = std::lower_bound(first, order.end(), splitter,
+                                             [&](uint32_t row, const std::pair<size_t, uint32_t> &bound) {
+                                               return less({share, row}, bound);
+                                             }) -
+                            order.begin();
+    }
+    cuts_[share][ranges] = order.size();
+  }
+
+  merged_.resize(ranges);
+  exec_ctx_->GetThreadPool()->RunAll(ranges, [this](size_t range) { MergeRange(range); });
+}
+
+void SortExecutor::MergeRange(size_t range) {
+  std::vector<size_t> next(shares_.size());
+  size_t rows = 0;
+  for (size_t share = 0; share < shares_.size(); share++) {
+    next[share] = cuts_[share][range];
+    rows += cuts_[share][range + 1] - cuts_[share][range];
+  }
+  auto live = [&](size_t share) { return next[share] < cuts_[share][range + 1]; };
+  auto beats = [&](size_t a, size_t b) {
+    if (!live(a) || !live(b)) {
+      return live(a);
+    }
+    return CompareRows(shares_[a], shares_[a].order_[next[a]], shares_[b], shares_[b].order_[next[b]]) <= 0;
+  };
+
+  auto &merged = merged_[range];
+  merged.reserve(rows);
+  LoserTree tree;
+  tree.Init(shares_.size(), beats);
+  while (live(tree.Winner())) {
+    auto &share = shares_[tree.Winner()];
+    merged.push_back(&share.tuples_[share.order_[next[tree.Winner()]++]]);
+    tree.Replay(beats);
+  }
+}
+
+void SortExecutor::MergeRuns() {
+  for (auto &share : shares_) {
+    if (!share.tuples_.empty()) {
+      SpillRun(&share);
+    }
+    for (auto &run : share.runs_) {
+      runs_.push_back(std::move(run));
+    }
+  }
+  shares_.clear();
+
+  Tuple tuple;
+  while (runs_.size() - first_run_ > SORT_MERGE_FAN_IN) {
+    StartMerge(SORT_MERGE_FAN_IN);
+    auto run = std::make_unique<TmpTupleHeap>(exec_ctx_->GetTmpFile());
+    while (NextMerged(&tuple)) {
+      run->Append(tuple);
+    }
+    runs_.push_back(std::move(run));
+  }
+  StartMerge(runs_.size() - first_run_);
+}
+
+void SortExecutor::StartMerge(size_t count) {
+  // The runs of the previous merge were read to their end
+  for (size_t i = 0; i < first_run_; i++) {
+    runs_[i].reset();
+  }
+  merge_runs_.clear();
+  for (size_t i = 0; i < count; i++) {
+    merge_runs_.push_back(runs_[first_run_ + i].get());
+  }
+  first_run_ += count;
+
+  heads_.resize(count);
+  head_keys_.resize(count * sort_keys_.KeySize());
+  head_exact_.resize(count);
+  live_.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    ReadHead(i);
+  }
+
+  tree_.Init(count, [this](size_t a, size_t b) { return Beats(a, b); });
+}
+
+void SortExecutor::ReadHead(size_t run) {
+  live_[run] = merge_runs_[run]->Next(&heads_[run]);
+  if (live_[run]) {
+    head_exact_[run] = sort_keys_.Encode(heads_[run], &head_keys_[run * sort_keys_.KeySize()]);
+  }
+}
+
+auto SortExecutor::Beats(size_t a, size_t b) const -> bool {
+  if (!live_[a] || !live_[b]) {
+    return live_[a];
+  }
+  auto key_size = sort_keys_.KeySize();
+  return sort_keys_.Compare(heads_[a], &head_keys_[a * key_size], head_exact_[a], heads_[b], &head_keys_[b * key_size],
+                            head_exact_[b]) <= 0;
+}
+
+auto SortExecutor::NextMerged(Tuple *tuple) -> bool {
+  auto winner = tree_.Winner();
+  if (!live_[winner]) {
+    return false;
+  }
+  *tuple = heads_[winner];
+  ReadHead(winner);
+  tree_.Replay([this](size_t a, size_t b) { return Beats(a, b); });
+  return true;
 }
 
 auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (child_iter_ == child_tuples_.end()) {
+  if (!merge_runs_.empty()) {
+    if (!NextMerged(tuple)) {
+      return false;
+    }
+    *rid = tuple->GetRid();
+    return true;
+  }
+
+  while (merged_range_ < merged_.size() && merged_row_ == merged_[merged_range_].size()) {
+    merged_range_++;
+    merged_row_ = 0;
+  }
+  if (merged_range_ == merged_.size()) {
     return false;
   }
 
-  *tuple = *child_iter_;
+  *tuple = *merged_[merged_range_][merged_row_++];
   *rid = tuple->GetRid();
-  ++child_iter_;
 
   return true;
 }
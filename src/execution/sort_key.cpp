@@ -0,0 +1,194 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/sort_key.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "../include/common/config.h"
+#include "../include/common/exception.h"
+
+namespace hmssql {
+
+namespace {
+
+/** @return the size of the value of a column of type in a key */
+auto ValueSize(TypeId type) -> size_t {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return sizeof(int8_t);
+    case TypeId::SMALLINT:
+      return sizeof(int16_t);
+    case TypeId::INTEGER:
+      return sizeof(int32_t);
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return sizeof(int64_t);
+    case TypeId::VARCHAR:
+      return SORT_KEY_VARCHAR_PREFIX;
+    default:
+      throw Exception(ExceptionType::NOT_IMPLEMENTED, "cannot sort by a value of this type");
+  }
+}
+
+/** Store the low size bytes of bits, most significant first. */
+void StoreBigEndian(uint64_t bits, size_t size, char *out) {
+  for (size_t i = 0; i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * (size - 1 - i)));
+  }
+}
+
+/** @return a signed integer of size bytes as bits that order like it unsigned */
+auto SignedBits(int64_t value, size_t size) -> uint64_t {
+  return static_cast<uint64_t>(value) ^ (uint64_t{1} << (8 * size - 1));
+}
+
+}  // namespace
+
+SortKeyEncoder::SortKeyEncoder(const std::vector<OrderBy> &order_bys, const Schema *schema) : schema_(schema) {
+  for (const auto &[order_type, expr] : order_bys) {
+    columns_.push_back(KeyColumn{order_type, expr, expr->GetReturnType(), key_size_});
+    key_size_ += 1 + ValueSize(expr->GetReturnType());
+  }
+}
+
+auto SortKeyEncoder::Encode(const Tuple &tuple, char *key) const -> size_t {
+  size_t exact = key_size_;
+  for (const auto &column : columns_) {
+    char *out = key + column.offset_;
+    auto size = ValueSize(column.type_);
+    auto value = column.expr_->Evaluate(&tuple, *schema_);
+    if (value.IsNull()) {
+      memset(out, 0, 1 + size);
+    } else {
+      out[0] = 1;
+      if (value.GetTypeId() != column.type_) {
+        value = value.CastAs(column.type_);
+      }
+      switch (column.type_) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          StoreBigEndian(SignedBits(value.GetAs<int8_t>(), size), size, out + 1);
+          break;
+        case TypeId::SMALLINT:
+          StoreBigEndian(SignedBits(value.GetAs<int16_t>(), size), size, out + 1);
+          break;
+        case TypeId::INTEGER:
+          StoreBigEndian(SignedBits(value.GetAs<int32_t>(), size), size, out + 1);
+          break;
+        case TypeId::BIGINT:
+          StoreBigEndian(SignedBits(value.GetAs<int64_t>(), size), size, out + 1);
+          break;
+        case TypeId::TIMESTAMP:
+          StoreBigEndian(value.GetAs<uint64_t>(), size, out + 1);
+          break;
+        case TypeId::DECIMAL: {
+          // Negative doubles order the other way round as bits, -0.0 is 0.0
+          auto number = value.GetAs<double>();
+          uint64_t bits;
+          number = number == 0 ? 0 : number;
+          memcpy(&bits, &number, sizeof(bits));
+          StoreBigEndian((bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63), size, out + 1);
+          break;
+        }
+        default: {
+          // Shorter strings are padded with zeros, which only a string with zeros of its own can tell apart
+          size_t length = value.GetLength() - 1;
+          size_t copied = std::min(length, size);
+          memcpy(out + 1, value.GetData(), copied);
+          memset(out + 1 + copied, 0, size - copied);
+          if (length >= size || memchr(value.GetData(), 0, copied) != nullptr) {
+            exact = std::min(exact, column.offset_ + 1 + size);
+          }
+          break;
+        }
+      }
+    }
+    if (column.order_type_ == OrderByType::DESC) {
+      for (size_t i = 0; i <= size; i++) {
+        out[i] = static_cast<char>(~out[i]);
+      }
+    }
+  }
+  return exact;
+}
+
+auto SortKeyEncoder::Compare(const Tuple &tuple_a, const char *key_a, size_t exact_a, const Tuple &tuple_b,
+                             const char *key_b, size_t exact_b) const -> int {
+  auto exact = std::min(exact_a, exact_b);
+  auto cmp = memcmp(key_a, key_b, exact);
+  return cmp != 0 || exact == key_size_ ? cmp : Compare(tuple_a, tuple_b);
+}
+
+auto SortKeyEncoder::Compare(const Tuple &tuple_a, const Tuple &tuple_b) const -> int {
+  for (const auto &column : columns_) {
+    auto value_a = column.expr_->Evaluate(&tuple_a, *schema_);
+    auto value_b = column.expr_->Evaluate(&tuple_b, *schema_);
+    int cmp;
+    if (value_a.IsNull() || value_b.IsNull()) {
+      cmp = static_cast<int>(!value_a.IsNull()) - static_cast<int>(!value_b.IsNull());
+    } else if (value_a.CompareLessThan(value_b) == CmpBool::CmpTrue) {
+      cmp = -1;
+    } else {
+      cmp = value_a.CompareGreaterThan(value_b) == CmpBool::CmpTrue ? 1 : 0;
+    }
+    if (cmp != 0) {
+      return column.order_type_ == OrderByType::DESC ? -cmp : cmp;
+    }
+  }
+  return 0;
+}
+
+auto SortKeyEncoder::Prefix(const char *key) const -> uint64_t {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < key_size_ ? static_cast<uint8_t>(key[i]) : 0);
+  }
+  return prefix;
+}
+
+auto SortKeyEncoder::Sort(const std::vector<Tuple> &tuples, std::vector<char> *keys, std::vector<size_t> *exact) const
+    -> std::vector<uint32_t> {
+  // The sort moves the first 8 bytes of every key along with its row, most comparisons end there. They are always in
+  // the exact part of the key, a varchar prefix ends past them.
+  struct Entry {
+    uint64_t prefix_;
+    uint32_t row_;
+  };
+  keys->resize(tuples.size() * key_size_);
+  exact->resize(tuples.size());
+  std::vector<Entry> entries(tuples.size());
+  for (uint32_t row = 0; row < tuples.size(); row++) {
+    char *key = keys->data() + row * key_size_;
+    (*exact)[row] = Encode(tuples[row], key);
+    entries[row] = Entry{Prefix(key), row};
+  }
+
+  std::sort(entries.begin(), entries.end(), [&](const Entry &entry_a, const Entry &entry_b) {
+    if (entry_a.prefix_ != entry_b.prefix_) {
+      return entry_a.prefix_ < entry_b.prefix_;
+    }
+    return Compare(tuples[entry_a.row_], keys->data() + entry_a.row_ * key_size_, (*exact)[entry_a.row_],
+                   tuples[entry_b.row_], keys->data() + entry_b.row_ * key_size_, (*exact)[entry_b.row_]) < 0;
+  });
+
+  std::vector<uint32_t> order;
+  order.reserve(entries.size());
+  for (const auto &entry : entries) {
+    order.push_back(entry.row_);
+  }
+  return order;
+}
+
+}  // namespace hmssql
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// thread_pool.cpp
+//
+// Identification: src/execution/thread_pool.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/thread_pool.h"
+
+#include <utility>
+
+namespace hmssql {
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+auto ThreadPool::Submit(std::function<void()> task) -> std::future<void> {
+  std::packaged_task<void()> packaged(std::move(task));
+  auto future = packaged.get_future();
+  std::scoped_lock<std::mutex> lock(latch_);
+  tasks_.push_back(std::move(packaged));
+  // Every idle thread takes one queued task, start a thread for the tasks left over
+  if (idle_ < tasks_.size()) {
+    threads_.emplace_back([this] { WorkerLoop(); });
+  } else {
+    cv_.notify_one();
+  }
+  return future;
+}
+
+void ThreadPool::RunAll(size_t count, const std::function<void(size_t)> &task) {
+  // A packaged task keeps what it threw in its future
+  std::vector<std::future<void>> futures;
+  futures.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    futures.push_back(Submit([&task, i] { task(i); }));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+auto ThreadPool::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return threads_.size();
+}
+
+void ThreadPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    idle_++;
+    cv_.wait(lock, [&] { return shutdown_ || !tasks_.empty(); });
+    idle_--;
+    if (tasks_.empty()) {
+      return;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+}  // namespace hmssql
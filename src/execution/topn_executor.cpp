@@ -1,67 +1,115 @@
 #include "../include/execution/executors/topn_executor.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "../include/execution/executor_factory.h"
+#include "../include/execution/parallel_state.h"
+
 namespace hmssql {
 
 TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_{plan}, child_{std::move(child_executor)} {}
+    : AbstractExecutor(exec_ctx),
+      plan_{plan},
+      child_{std::move(child_executor)},
+      sort_keys_(plan->GetOrderBy(), &plan->GetChildPlan()->OutputSchema()) {}
 
 void TopNExecutor::Init() {
-  child_->Init();
+  candidates_ = Candidates{};
+  order_.clear();
+  next_ = 0;
 
-  auto cmp = [order_bys = plan_->order_bys_, schema = child_->GetOutputSchema()](const Tuple &a, const Tuple &b) {
-    for (const auto &order_key : order_bys) {
-      switch (order_key.first) {
-        case OrderByType::INVALID:
-        case OrderByType::DEFAULT:
-        case OrderByType::ASC:
-          if (static_cast<bool>(
-                  order_key.second->Evaluate(&a, schema).CompareLessThan(order_key.second->Evaluate(&b, schema)))) {
-            return true;
-          } else if (static_cast<bool>(order_key.second->Evaluate(&a, schema)
-                                           .CompareGreaterThan(order_key.second->Evaluate(&b, schema)))) {
-            return false;
-          }
-          break;
-        case OrderByType::DESC:
-          if (static_cast<bool>(
-                  order_key.second->Evaluate(&a, schema).CompareGreaterThan(order_key.second->Evaluate(&b, schema)))) {
-            return true;
-          } else if (static_cast<bool>(order_key.second->Evaluate(&a, schema)
-                                           .CompareLessThan(order_key.second->Evaluate(&b, schema)))) {
-            return false;
-          }
-          break;
+  auto workers = plan_->GetWorkers();
+  if (workers == 0) {
+    child_->Init();
+    Collect(child_.get(), &candidates_);
+  } else {
+    BUSTUB_ASSERT(exec_ctx_->GetThreadPool() != nullptr, "parallel plans need a thread pool");
+    // The executors go before the state they share
+    auto parallel_state = std::make_unique<ParallelState>();
+    std::vector<std::unique_ptr<ExecutorContext>> worker_ctxs;
+    std::vector<std::unique_ptr<AbstractExecutor>> worker_executors;
+    for (size_t i = 0; i < workers; i++) {
+      worker_ctxs.push_back(std::make_unique<ExecutorContext>(exec_ctx_, parallel_state.get(), i));
+      worker_executors.push_back(ExecutorFactory::CreateExecutor(worker_ctxs.back().get(), plan_->GetChildPlan()));
+    }
+    std::vector<Candidates> worker_candidates(workers);
+    exec_ctx_->GetThreadPool()->RunAll(workers, [&](size_t worker) {
+      worker_executors[worker]->Init();
+      Collect(worker_executors[worker].get(), &worker_candidates[worker]);
+    });
+    // The keys of the workers are offered as they are, no row is encoded twice
+    auto key_size = sort_keys_.KeySize();
+    for (const auto &candidates : worker_candidates) {
+      for (uint32_t slot = 0; slot < candidates.tuples_.size(); slot++) {
+        Offer(candidates.tuples_[slot], &candidates.keys_[slot * key_size], candidates.exact_[slot], &candidates_);
       }
     }
-    return false;
-  };
+  }
 
-  std::priority_queue<Tuple, std::vector<Tuple>, decltype(cmp)> pq(cmp);
+  // Popping the worst one to the back each time leaves the best one in front
+  order_ = candidates_.heap_;
+  auto less = [this](uint32_t a, uint32_t b) { return CompareSlots(candidates_, a, b) < 0; };
+  std::sort_heap(order_.begin(), order_.end(), less);
+}
 
+void TopNExecutor::Collect(AbstractExecutor *child, Candidates *candidates) {
+  std::vector<char> key(sort_keys_.KeySize());
   Tuple child_tuple{};
   RID child_rid;
-  while (child_->Next(&child_tuple, &child_rid)) {
-    pq.push(child_tuple);
-    if (pq.size() > plan_->GetN()) {
-      pq.pop();
-    }
+  while (child->Next(&child_tuple, &child_rid)) {
+    auto exact = sort_keys_.Encode(child_tuple, key.data());
+    Offer(child_tuple, key.data(), exact, candidates);
   }
+}
+
+void TopNExecutor::Offer(const Tuple &tuple, const char *key, size_t exact, Candidates *candidates) {
+  auto n = plan_->GetN();
+  auto key_size = sort_keys_.KeySize();
+  auto &heap = candidates->heap_;
+  auto less = [&](uint32_t a, uint32_t b) { return CompareSlots(*candidates, a, b) < 0; };
 
-  while (!pq.empty()) {
-    child_tuples_.push(pq.top());
-    pq.pop();
+  uint32_t slot;
+  if (heap.size() < n) {
+    slot = heap.size();
+    candidates->tuples_.push_back(tuple);
+    candidates->keys_.resize((slot + 1) * key_size);
+    candidates->exact_.push_back(exact);
+  } else {
+    // A row that does not beat the worst candidate is dropped before it is copied
+    if (n == 0) {
+      return;
+    }
+    auto worst = heap.front();
+    if (sort_keys_.Compare(tuple, key, exact, candidates->tuples_[worst], &candidates->keys_[worst * key_size],
+                           candidates->exact_[worst]) >= 0) {
+      return;
+    }
+    std::pop_heap(heap.begin(), heap.end(), less);
+    heap.pop_back();
+    slot = worst;
+    candidates->tuples_[slot] = tuple;
+    candidates->exact_[slot] = exact;
   }
+  memcpy(&candidates->keys_[slot * key_size], key, key_size);
+  heap.push_back(slot);
+  std::push_heap(heap.begin(), heap.end(), less);
+}
+
+auto TopNExecutor::CompareSlots(const Candidates &candidates, uint32_t a, uint32_t b) const -> int {
+  auto key_size = sort_keys_.KeySize();
+  return sort_keys_.Compare(candidates.tuples_[a], &candidates.keys_[a * key_size], candidates.exact_[a],
+                            candidates.tuples_[b], &candidates.keys_[b * key_size], candidates.exact_[b]);
 }
 
 auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (child_tuples_.empty()) {
+  if (next_ >= order_.size()) {
     return false;
   }
-  *tuple = child_tuples_.top();
+  *tuple = candidates_.tuples_[order_[next_++]];
   *rid = tuple->GetRid();
-  child_tuples_.pop();
-
   return true;
 }
 }  // namespace hmssql
@@ -0,0 +1,334 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/execution/tuple_batch.h"
+
+#include <cstring>
+#include <utility>
+
+#include "../include/common/macros.h"
+#include "../include/execution/expressions/abstract_expression.h"
+#include "../include/type/limits.h"
+#include "../include/type/value_factory.h"
+
+namespace hmssql {
+
+namespace {
+
+auto NullValueOf(TypeId type) -> Value {
+  // ValueFactory has no null TIMESTAMP
+  if (type == TypeId::TIMESTAMP) {
+    return {TypeId::TIMESTAMP, BUSTUB_TIMESTAMP_NULL};
+  }
+  return ValueFactory::GetNullValueByType(type);
+}
+
+template <typename T>
+auto ReadInlined(const char *storage) -> T {
+  T value;
+  std::memcpy(&value, storage, sizeof(T));
+  return value;
+}
+
+template <typename T>
+void SetInlinedInteger(ColumnVector *vector, uint32_t row, const char *storage, T null) {
+  auto value = ReadInlined<T>(storage);
+  if (value == null) {
+    vector->SetNull(row);
+  } else {
+    vector->SetInteger(row, static_cast<int64_t>(value));
+  }
+}
+
+}  // namespace
+
+void ColumnVector::Reset(TypeId type) {
+  type_ = type;
+  storage_ = StorageOf(type);
+  size_ = 0;
+  integers_.clear();
+  decimals_.clear();
+  values_.clear();
+  varlen_arena_.Reset();
+  nulls_.clear();
+}
+
+auto ColumnVector::operator=(const ColumnVector &other) -> ColumnVector & {
+  if (this == &other) {
+    return *this;
+  }
+  type_ = other.type_;
+  storage_ = other.storage_;
+  size_ = other.size_;
+  integers_ = other.integers_;
+  decimals_ = other.decimals_;
+  nulls_ = other.nulls_;
+  varlen_arena_.Reset();
+  values_.clear();
+  values_.reserve(other.values_.size());
+  for (const auto &value : other.values_) {
+    values_.push_back(ValueFactory::Clone(value, &varlen_arena_));
+  }
+  return *this;
+}
+
+void ColumnVector::Resize(uint32_t size) {
+  size_ = size;
+  switch (storage_) {
+    case Storage::INTEGRAL:
+      integers_.resize(size);
+      break;
+    case Storage::DECIMAL:
+      decimals_.resize(size);
+      break;
+    case Storage::VALUE:
+      values_.resize(size);
+      break;
+  }
+  nulls_.resize((size + 63) / 64, 0);
+}
+
+auto ColumnVector::GetValue(uint32_t row) const -> Value {
+  if (storage_ == Storage::VALUE) {
+    const auto &value = values_[row];
+    if (value.GetTypeId() == TypeId::VARCHAR && !value.IsNull()) {
+      return {TypeId::VARCHAR, value.GetData(), value.GetLength(), true};
+    }
+    return value;
+  }
+  if (IsNull(row)) {
+    return NullValueOf(type_);
+  }
+  if (storage_ == Storage::DECIMAL) {
+    return {type_, decimals_[row]};
+  }
+  return {type_, integers_[row]};
+}
+
+void ColumnVector::AppendFrom(const ColumnVector &source, uint32_t row) {
+  if (storage_ == Storage::VALUE || source.storage_ != storage_ || source.type_ != type_) {
+    Append(source.GetValueView(row));
+    return;
+  }
+  Resize(size_ + 1);
+  if (source.IsNull(row)) {
+    SetNull(size_ - 1);
+  } else if (storage_ == Storage::DECIMAL) {
+    SetDecimal(size_ - 1, source.decimals_[row]);
+  } else {
+    SetInteger(size_ - 1, source.integers_[row]);
+  }
+}
+
+void ColumnVector::Set(uint32_t row, const Value &value) {
+  if (storage_ != Storage::VALUE && value.GetTypeId() != type_) {
+    ConvertToValues();
+  }
+  if (value.IsNull()) {
+    SetNull(row);
+    if (storage_ == Storage::VALUE) {
+      values_[row] = value;
+    }
+    return;
+  }
+  switch (storage_) {
+    case Storage::INTEGRAL:
+      SetInteger(row, IntegerOf(value));
+      break;
+    case Storage::DECIMAL:
+      SetDecimal(row, value.GetAs<double>());
+      break;
+    case Storage::VALUE:
+      values_[row] = ValueFactory::Clone(value, &varlen_arena_);
+      nulls_[row / 64] &= ~(uint64_t{1} << (row % 64));
+      break;
+  }
+}
+
+void ColumnVector::SetVarchar(uint32_t row, const char *data, uint32_t len) {
+  BUSTUB_ASSERT(storage_ == Storage::VALUE, "VARCHAR columns keep Values");
+  values_[row] = ValueFactory::GetVarcharValue(data, len, false, &varlen_arena_);
+  nulls_[row / 64] &= ~(uint64_t{1} << (row % 64));
+}
+
+auto ColumnVector::StorageOf(TypeId type) -> Storage {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::TIMESTAMP:
+      return Storage::INTEGRAL;
+    case TypeId::DECIMAL:
+      return Storage::DECIMAL;
+    default:
+      return Storage::VALUE;
+  }
+}
+
+auto ColumnVector::IntegerOf(const Value &value) -> int64_t {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    case TypeId::TIMESTAMP:
+      return static_cast<int64_t>(value.GetAs<uint64_t>());
+    default:
+      UNREACHABLE("not an integral type");
+  }
+}
+
+void ColumnVector::ConvertToValues() {
+  std::vector<Value> values;
+  values.reserve(size_);
+  for (uint32_t row = 0; row < size_; row++) {
+    values.push_back(GetValue(row));
+  }
+  values_ = std::move(values);
+  integers_.clear();
+  decimals_.clear();
+  storage_ = Storage::VALUE;
+}
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  columns_.resize(schema->GetColumnCount());
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    columns_[col_idx].Reset(schema->GetColumn(col_idx).GetType());
+  }
+  rids_.clear();
+  row_count_ = 0;
+  has_selection_ = false;
+  selection_.clear();
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  uint32_t row = row_count_++;
+  rids_.push_back(rid);
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    const auto &column = schema_->GetColumn(col_idx);
+    auto &vector = columns_[col_idx];
+    vector.Resize(row_count_);
+    if (!column.IsInlined() && vector.IsValues()) {
+      // A VARCHAR is stored as the offset of its length and bytes in the tuple, the bytes go straight to the column
+      const char *storage = tuple.GetData() + ReadInlined<int32_t>(tuple.GetData() + column.GetOffset());
+      auto len = ReadInlined<uint32_t>(storage);
+      if (len == BUSTUB_VALUE_NULL) {
+        vector.Set(row, NullValueOf(column.GetType()));
+      } else {
+        vector.SetVarchar(row, storage + sizeof(uint32_t), len);
+      }
+      continue;
+    }
+    if (!column.IsInlined() || !(vector.IsIntegral() || vector.IsDecimal())) {
+      vector.Set(row, tuple.GetValue(schema_, col_idx));
+      continue;
+    }
+    // The same layout Type::SerializeTo writes, nulls are stored as the smallest value of the type
+    const char *storage = tuple.GetData() + column.GetOffset();
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        SetInlinedInteger<int8_t>(&vector, row, storage, BUSTUB_INT8_NULL);
+        break;
+      case TypeId::SMALLINT:
+        SetInlinedInteger<int16_t>(&vector, row, storage, BUSTUB_INT16_NULL);
+        break;
+      case TypeId::INTEGER:
+        SetInlinedInteger<int32_t>(&vector, row, storage, BUSTUB_INT32_NULL);
+        break;
+      case TypeId::BIGINT:
+        SetInlinedInteger<int64_t>(&vector, row, storage, BUSTUB_INT64_NULL);
+        break;
+      case TypeId::TIMESTAMP:
+        SetInlinedInteger<uint64_t>(&vector, row, storage, BUSTUB_TIMESTAMP_NULL);
+        break;
+      case TypeId::DECIMAL: {
+        auto value = ReadInlined<double>(storage);
+        if (value == BUSTUB_DECIMAL_NULL) {
+          vector.SetNull(row);
+        } else {
+          vector.SetDecimal(row, value);
+        }
+        break;
+      }
+      default:
+        vector.Set(row, tuple.GetValue(schema_, col_idx));
+        break;
+    }
+  }
+}
+
+void TupleBatch::AppendValues(const std::vector<Value> &values, const RID &rid) {
+  BUSTUB_ASSERT(values.size() == columns_.size(), "one value per column");
+  row_count_++;
+  rids_.push_back(rid);
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    columns_[col_idx].Append(values[col_idx]);
+  }
+}
+
+void TupleBatch::AppendRow(const TupleBatch &source, uint32_t row) {
+  BUSTUB_ASSERT(source.columns_.size() == columns_.size(), "same layout");
+  row_count_++;
+  rids_.push_back(source.rids_[row]);
+  for (uint32_t col_idx = 0; col_idx < columns_.size(); col_idx++) {
+    columns_[col_idx].AppendFrom(source.columns_[col_idx], row);
+  }
+}
+
+auto TupleBatch::GetTuple(uint32_t row) const -> Tuple {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    // The tuple copies the bytes, so VARCHARs are not copied on the way
+    values.push_back(column.GetValueView(row));
+  }
+  return {values, schema_};
+}
+
+void TupleBatch::InheritRows(const TupleBatch &input) {
+  rids_ = input.rids_;
+  row_count_ = input.row_count_;
+  has_selection_ = input.has_selection_;
+  selection_ = input.selection_;
+}
+
+void TupleBatch::ApplyFilter(const AbstractExpression &predicate) {
+  ColumnVector result;
+  predicate.EvaluateBatch(*this, &result);
+  std::vector<uint32_t> selection;
+  selection.reserve(Size());
+  for (uint32_t i = 0; i < Size(); i++) {
+    auto row = RowAt(i);
+    bool keep;
+    if (result.IsIntegral()) {
+      keep = !result.IsNull(row) && result.GetInteger(row) != 0;
+    } else {
+      auto value = result.GetValue(row);
+      keep = !value.IsNull() && value.GetAs<bool>();
+    }
+    if (keep) {
+      selection.push_back(row);
+    }
+  }
+  selection_ = std::move(selection);
+  has_selection_ = true;
+}
+
+}  // namespace hmssql
@@ -10,7 +10,9 @@
 //===----------------------------------------------------------------------===//
 #include <memory>
 
+#include "../include/common/exception.h"
 #include "../include/execution/executors/update_executor.h"
+#include "fmt/format.h"
 
 namespace hmssql {
 
@@ -22,6 +24,11 @@ UpdateExecutor::UpdateExecutor(ExecutorContext *exec_ctx, const UpdatePlanNode *
 }
 
 void UpdateExecutor::Init() {
+  auto *lock_manager = exec_ctx_->GetLockManager();
+  if (lock_manager != nullptr &&
+      !lock_manager->LockTable(exec_ctx_->GetTransaction(), LockMode::INTENTION_EXCLUSIVE, table_info_->oid_)) {
+    throw ExecutionException(fmt::format("deadlock detected while locking table {}", table_info_->name_));
+  }
   child_executor_->Init();
   table_indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
 }
@@ -33,8 +40,13 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   Tuple old_tuple{};
   RID old_rid;
   int32_t update_count = 0;
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *lock_manager = txn != nullptr && !txn->IsOptimistic() ? exec_ctx_->GetLockManager() : nullptr;
 
   while (child_executor_->Next(&old_tuple, &old_rid)) {
+    if (lock_manager != nullptr && !lock_manager->LockRow(txn, LockMode::EXCLUSIVE, table_info_->oid_, old_rid)) {
+      throw ExecutionException(fmt::format("deadlock detected while locking tuple {}", old_rid.ToString()));
+    }
     std::vector<Value> values{};
     values.reserve(child_executor_->GetOutputSchema().GetColumnCount());
     for (const auto &expr : plan_->target_expressions_) {
@@ -43,10 +55,16 @@ auto UpdateExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
 
     auto to_update_tuple = Tuple{values, &child_executor_->GetOutputSchema()};
 
-    bool updated = table_info_->table_->UpdateTuple(to_update_tuple, old_rid);
+    bool updated = table_info_->table_->UpdateTuple(to_update_tuple, old_rid, &table_info_->schema_, txn);
 
     if (updated) {
       update_count++;
+    } else if (txn != nullptr && txn->GetState() == TransactionState::TAINTED) {
+      throw ExecutionException(fmt::format("tuple {} was changed by a concurrent transaction", old_rid.ToString()));
+    } else {
+      // The row keeping its old value would be a lost update, the statement fails and its transaction rolls back
+      throw ExecutionException(
+          fmt::format("tuple {} can't be updated, the new value does not fit its page", old_rid.ToString()));
     }
   }
   std::vector<Value> values{};
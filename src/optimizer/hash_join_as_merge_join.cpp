@@ -0,0 +1,136 @@
+#include <memory>
+#include <utility>
+#include <vector>
+#include "../include/binder/bound_order_by.h"
+#include "../include/catalog/catalog.h"
+#include "../include/execution/expressions/column_value_expression.h"
+#include "../include/execution/plans/abstract_plan.h"
+#include "../include/execution/plans/hash_join_plan.h"
+#include "../include/execution/plans/index_scan_plan.h"
+#include "../include/execution/plans/merge_join_plan.h"
+#include "../include/execution/plans/projection_plan.h"
+#include "../include/execution/plans/sort_plan.h"
+#include "../include/execution/plans/topn_plan.h"
+#include "../include/optimizer/optimizer.h"
+
+namespace hmssql {
+
+namespace {
+
+/** @return the column of the output a key reads, nullptr if the key is not a plain column */
+auto KeyColumn(const AbstractExpressionRef &key) -> const ColumnValueExpression * {
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(key.get());
+  return column != nullptr && column->GetTupleIdx() == 0 ? column : nullptr;
+}
+
+/** @return true if order_bys sort ascending by keys first */
+auto OrderByStartsWith(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys,
+                       const std::vector<AbstractExpressionRef> &keys) -> bool {
+  if (order_bys.size() < keys.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    const auto &[order_type, expr] = order_bys[i];
+    const auto *order_column = KeyColumn(expr);
+    if ((order_type != OrderByType::ASC && order_type != OrderByType::DEFAULT) || order_column == nullptr ||
+        order_column->GetColIdx() != KeyColumn(keys[i])->GetColIdx()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+auto Optimizer::IsSortedBy(const AbstractPlanNodeRef &plan, const std::vector<AbstractExpressionRef> &keys) -> bool {
+  for (const auto &key : keys) {
+    if (KeyColumn(key) == nullptr) {
+      return false;
+    }
+  }
+  switch (plan->GetType()) {
+    case PlanType::Sort:
+      return OrderByStartsWith(dynamic_cast<const SortPlanNode &>(*plan).GetOrderBy(), keys);
+
+    case PlanType::TopN:
+      return OrderByStartsWith(dynamic_cast<const TopNPlanNode &>(*plan).GetOrderBy(), keys);
+
+    case PlanType::IndexScan: {
+      // The B+ tree is walked in key order, a lookup of one key is sorted anyway
+      const auto *index_info = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(*plan).GetIndexOid());
+      const auto &key_attrs = index_info->index_->GetKeyAttrs();
+      if (key_attrs.size() < keys.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < keys.size(); i++) {
+        if (key_attrs[i] != KeyColumn(keys[i])->GetColIdx()) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Both keep the order of their child, a projection moves the columns around
+    case PlanType::Filter:
+    case PlanType::Limit:
+      return IsSortedBy(plan->GetChildAt(0), keys);
+
+    case PlanType::Projection: {
+      const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*plan);
+      std::vector<AbstractExpressionRef> child_keys;
+      for (const auto &key : keys) {
+        const auto &expr = projection_plan.GetExpressions()[KeyColumn(key)->GetColIdx()];
+        if (KeyColumn(expr) == nullptr) {
+          return false;
+        }
+        child_keys.push_back(expr);
+      }
+      return IsSortedBy(projection_plan.GetChildPlan(), child_keys);
+    }
+
+    // The output is in the order of the left input, whose columns come first
+    case PlanType::MergeJoin: {
+      const auto &join_plan = dynamic_cast<const MergeJoinPlanNode &>(*plan);
+      const auto &left_keys = join_plan.LeftJoinKeyExpressions();
+      auto left_width = join_plan.GetLeftPlan()->OutputSchema().GetColumnCount();
+      if (keys.size() > left_keys.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < keys.size(); i++) {
+        auto col_idx = KeyColumn(keys[i])->GetColIdx();
+        if (col_idx >= left_width || KeyColumn(left_keys[i]) == nullptr ||
+            KeyColumn(left_keys[i])->GetColIdx() != col_idx) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+auto Optimizer::OptimizeHashJoinAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeHashJoinAsMergeJoin(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::HashJoin) {
+    const auto &join_plan = dynamic_cast<const HashJoinPlanNode &>(*optimized_plan);
+    if (join_plan.GetRadixWorkers() == 0 &&
+        (join_plan.GetJoinType() == JoinType::INNER || join_plan.GetJoinType() == JoinType::LEFT) &&
+        IsSortedBy(join_plan.GetLeftPlan(), join_plan.LeftJoinKeyExpressions()) &&
+        IsSortedBy(join_plan.GetRightPlan(), join_plan.RightJoinKeyExpressions())) {
+      return std::make_shared<MergeJoinPlanNode>(join_plan.output_schema_, join_plan.GetLeftPlan(),
+                                                 join_plan.GetRightPlan(), join_plan.left_key_expressions_,
+                                                 join_plan.right_key_expressions_, join_plan.GetJoinType());
+    }
+  }
+
+  return optimized_plan;
+}
+
+}  // namespace hmssql
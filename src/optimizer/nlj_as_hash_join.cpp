@@ -1,5 +1,7 @@
 #include <algorithm>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "../include/catalog/column.h"
 #include "../include/catalog/schema.h"
 #include "../include/common/exception.h"
@@ -7,6 +9,7 @@
 #include "../include/execution/expressions/column_value_expression.h"
 #include "../include/execution/expressions/comparison_expression.h"
 #include "../include/execution/expressions/constant_value_expression.h"
+#include "../include/execution/expressions/logic_expression.h"
 #include "../include/execution/plans/abstract_plan.h"
 #include "../include/execution/plans/filter_plan.h"
 #include "../include/execution/plans/hash_join_plan.h"
@@ -17,6 +20,43 @@
 
 namespace hmssql {
 
+namespace {
+
+/**
+ * Split predicate into the keys of an equi-join. Every conjunct of the predicate has to be <column> = <column>,
+ * with one column of the left table and one of the right one.
+ * @return false if the predicate has a conjunct of another form
+ */
+auto CollectEquiJoinKeys(const AbstractExpression &predicate, std::vector<AbstractExpressionRef> *left_keys,
+                         std::vector<AbstractExpressionRef> *right_keys) -> bool {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&predicate); logic_expr != nullptr) {
+    return logic_expr->logic_type_ == LogicType::And &&
+           CollectEquiJoinKeys(*logic_expr->GetChildAt(0), left_keys, right_keys) &&
+           CollectEquiJoinKeys(*logic_expr->GetChildAt(1), left_keys, right_keys);
+  }
+  const auto *expr = dynamic_cast<const ComparisonExpression *>(&predicate);
+  if (expr == nullptr || expr->comp_type_ != ComparisonType::Equal) {
+    return false;
+  }
+  const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
+  const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
+  if (left_expr == nullptr || right_expr == nullptr || left_expr->GetTupleIdx() == right_expr->GetTupleIdx()) {
+    return false;
+  }
+  // Now it's in form of <column_expr> = <column_expr> with one column of each table. The key expressions are
+  // evaluated on the tuples of one side, so both get tuple_idx 0.
+  if (left_expr->GetTupleIdx() == 1) {
+    std::swap(left_expr, right_expr);
+  }
+  left_keys->push_back(
+      std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType()));
+  right_keys->push_back(
+      std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType()));
+  return true;
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
@@ -29,33 +69,13 @@ auto Optimizer::OptimizeNLJAsHashJoin(const AbstractPlanNodeRef &plan) -> Abstra
     // Has exactly two children
     BUSTUB_ENSURE(nlj_plan.children_.size() == 2, "NLJ should have exactly 2 children.");
 
-    // Check if expr is equal condition where one is for the left table, and one is for the right table.
-    if (const auto *expr = dynamic_cast<const ComparisonExpression *>(&nlj_plan.Predicate()); expr != nullptr) {
-      if (expr->comp_type_ == ComparisonType::Equal) {
-        if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-            left_expr != nullptr) {
-          if (const auto *right_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
-            // Ensure both exprs have tuple_id == 0
-            auto left_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, left_expr->GetColIdx(), left_expr->GetReturnType());
-            auto right_expr_tuple_0 =
-                std::make_shared<ColumnValueExpression>(0, right_expr->GetColIdx(), right_expr->GetReturnType());
-            // Now it's in form of <column_expr> = <column_expr>. Let's check if one of them is from the left table, and
-            // the other is from the right table.
-            if (left_expr->GetTupleIdx() == 0 && right_expr->GetTupleIdx() == 1) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(left_expr_tuple_0),
-                                                        std::move(right_expr_tuple_0), nlj_plan.GetJoinType());
-            }
-            if (left_expr->GetTupleIdx() == 1 && right_expr->GetTupleIdx() == 0) {
-              return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
-                                                        nlj_plan.GetRightPlan(), std::move(right_expr_tuple_0),
-                                                        std::move(left_expr_tuple_0), nlj_plan.GetJoinType());
-            }
-          }
-        }
-      }
+    // A conjunction of equalities between a column of the left and one of the right table joins on all of them
+    std::vector<AbstractExpressionRef> left_keys;
+    std::vector<AbstractExpressionRef> right_keys;
+    if (CollectEquiJoinKeys(nlj_plan.Predicate(), &left_keys, &right_keys)) {
+      return std::make_shared<HashJoinPlanNode>(nlj_plan.output_schema_, nlj_plan.GetLeftPlan(),
+                                                nlj_plan.GetRightPlan(), std::move(left_keys), std::move(right_keys),
+                                                nlj_plan.GetJoinType());
     }
   }
 
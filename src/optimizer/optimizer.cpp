@@ -14,10 +14,11 @@ auto Optimizer::Optimize(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef
     p = OptimizeNLJAsIndexJoin(p);
     p = OptimizeOrderByAsIndexScan(p);
     p = OptimizeSortLimitAsTopN(p);
-    return p;
+    return max_parallel_workers_ > 1 ? OptimizeParallelPlan(p) : p;
   }
   // By default, use user-defined rules.
-  return OptimizeCustom(plan);
+  auto p = OptimizeCustom(plan);
+  return max_parallel_workers_ > 1 ? OptimizeParallelPlan(p) : p;
 }
 
 auto Optimizer::EstimatedCardinality(const std::string &table_name) -> std::optional<size_t> {
@@ -0,0 +1,178 @@
+#include <memory>
+#include <optional>
+#include <vector>
+#include "../include/execution/plans/aggregation_plan.h"
+#include "../include/execution/plans/gather_plan.h"
+#include "../include/execution/plans/hash_join_plan.h"
+#include "../include/execution/plans/mock_scan_plan.h"
+#include "../include/execution/plans/repartition_plan.h"
+#include "../include/execution/plans/seq_scan_plan.h"
+#include "../include/execution/plans/sort_plan.h"
+#include "../include/execution/plans/topn_plan.h"
+
+#include "../include/optimizer/optimizer.h"
+
+namespace hmssql {
+
+auto Optimizer::OptimizeParallelPlan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  bool partial;
+  auto parallel_plan = ParallelizePlan(plan, &partial);
+  return GatherIfPartial(parallel_plan, partial);
+}
+
+auto Optimizer::GatherIfPartial(const AbstractPlanNodeRef &plan, bool partial) -> AbstractPlanNodeRef {
+  if (!partial) {
+    return plan;
+  }
+  return std::make_shared<GatherPlanNode>(plan->output_schema_, plan, max_parallel_workers_);
+}
+
+auto Optimizer::IsEstimatedLarge(const AbstractPlanNodeRef &plan) -> bool {
+  auto rows = EstimatedRows(plan);
+  return rows.has_value() && *rows >= RADIX_JOIN_MIN_ROWS;
+}
+
+auto Optimizer::EstimatedRows(const AbstractPlanNodeRef &plan) -> std::optional<size_t> {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return EstimatedCardinality(dynamic_cast<const SeqScanPlanNode &>(*plan).table_name_);
+    case PlanType::MockScan:
+      return EstimatedCardinality(dynamic_cast<const MockScanPlanNode &>(*plan).GetTable());
+    case PlanType::Filter:
+    case PlanType::Projection:
+      return EstimatedRows(plan->GetChildAt(0));
+    default:
+      return std::nullopt;
+  }
+}
+
+auto Optimizer::EstimatedMemoryUsage(const AbstractPlanNodeRef &plan) -> std::optional<size_t> {
+  auto rows = EstimatedRows(plan);
+  if (!rows.has_value()) {
+    return std::nullopt;
+  }
+  // As a hash join or a sort counts a tuple: the Tuple and its data, a VARCHAR stored as its length and its bytes
+  const auto &schema = plan->OutputSchema();
+  size_t tuple_bytes = sizeof(Tuple) + schema.GetLength();
+  for (auto column_idx : schema.GetUnlinedColumns()) {
+    tuple_bytes += sizeof(uint32_t) + schema.GetColumn(column_idx).GetVariableLength();
+  }
+  return *rows * tuple_bytes;
+}
+
+auto Optimizer::ParallelizePlan(const AbstractPlanNodeRef &plan, bool *partial) -> AbstractPlanNodeRef {
+  *partial = false;
+  switch (plan->GetType()) {
+    // Writers keep reading their input in table order, while they change the pages the scan reads
+    case PlanType::Insert:
+    case PlanType::Update:
+    case PlanType::Delete:
+      return plan;
+
+    case PlanType::SeqScan: {
+      const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+      auto cardinality = EstimatedCardinality(seq_scan_plan.table_name_);
+      *partial = !cardinality.has_value() || *cardinality >= PARALLEL_SCAN_MIN_ROWS;
+      return plan;
+    }
+
+    case PlanType::MockScan: {
+      auto cardinality = EstimatedCardinality(dynamic_cast<const MockScanPlanNode &>(*plan).GetTable());
+      *partial = cardinality.has_value() && *cardinality >= PARALLEL_SCAN_MIN_ROWS;
+      return plan;
+    }
+
+    // Row at a time operators work on the share of their worker
+    case PlanType::Filter:
+    case PlanType::Projection: {
+      auto child = ParallelizePlan(plan->GetChildAt(0), partial);
+      return plan->CloneWithChildren({child});
+    }
+
+    case PlanType::Aggregation: {
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      bool child_partial;
+      auto child = ParallelizePlan(agg_plan.GetChildPlan(), &child_partial);
+      if (!child_partial || agg_plan.GetGroupBys().empty()) {
+        return plan->CloneWithChildren({GatherIfPartial(child, child_partial)});
+      }
+      // Every group lands in one partition, so each worker aggregates its groups completely
+      *partial = true;
+      auto repartition = std::make_shared<RepartitionPlanNode>(child->output_schema_, child, agg_plan.GetGroupBys(),
+                                                               max_parallel_workers_, max_parallel_workers_);
+      return plan->CloneWithChildren({repartition});
+    }
+
+    case PlanType::HashJoin: {
+      const auto &join_plan = dynamic_cast<const HashJoinPlanNode &>(*plan);
+      bool left_partial;
+      bool right_partial;
+      auto left = ParallelizePlan(join_plan.GetLeftPlan(), &left_partial);
+      auto right = ParallelizePlan(join_plan.GetRightPlan(), &right_partial);
+      if (!left_partial && !right_partial) {
+        return plan->CloneWithChildren({left, right});
+      }
+      *partial = true;
+      // Joins of two large pipelines partition both sides in the workers, into partitions whose tables fit the cache.
+      // The partitions are kept in memory, inputs that may not fit work_mem go to the hash joins below, which spill.
+      if (left_partial && right_partial && IsEstimatedLarge(join_plan.GetLeftPlan()) &&
+          IsEstimatedLarge(join_plan.GetRightPlan()) &&
+          *EstimatedMemoryUsage(join_plan.GetLeftPlan()) + *EstimatedMemoryUsage(join_plan.GetRightPlan()) <=
+              work_mem_) {
+        return std::make_shared<HashJoinPlanNode>(join_plan.output_schema_, left, right,
+                                                  join_plan.left_key_expressions_, join_plan.right_key_expressions_,
+                                                  join_plan.GetJoinType(), max_parallel_workers_);
+      }
+      // Otherwise both sides are partitioned by the join keys, worker i joins partition i of the left with the one of
+      // the right. A side that is not a pipeline is read by one producer.
+      auto left_repartition =
+          std::make_shared<RepartitionPlanNode>(left->output_schema_, left, join_plan.left_key_expressions_,
+                                                max_parallel_workers_, left_partial ? max_parallel_workers_ : 1);
+      auto right_repartition =
+          std::make_shared<RepartitionPlanNode>(right->output_schema_, right, join_plan.right_key_expressions_,
+                                                max_parallel_workers_, right_partial ? max_parallel_workers_ : 1);
+      return plan->CloneWithChildren({left_repartition, right_repartition});
+    }
+
+    // Every worker sorts its share, the workers merge ranges of the sorted shares
+    case PlanType::Sort: {
+      const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*plan);
+      bool child_partial;
+      auto child = ParallelizePlan(sort_plan.GetChildPlan(), &child_partial);
+      if (!child_partial) {
+        return plan->CloneWithChildren({child});
+      }
+      return std::make_shared<SortPlanNode>(sort_plan.output_schema_, child, sort_plan.GetOrderBy(),
+                                            max_parallel_workers_);
+    }
+
+    // Every worker keeps the top n of its share, the best n of all of them are the result
+    case PlanType::TopN: {
+      const auto &topn_plan = dynamic_cast<const TopNPlanNode &>(*plan);
+      bool child_partial;
+      auto child = ParallelizePlan(topn_plan.GetChildPlan(), &child_partial);
+      if (!child_partial) {
+        return plan->CloneWithChildren({child});
+      }
+      return std::make_shared<TopNPlanNode>(topn_plan.output_schema_, child, topn_plan.GetOrderBy(), topn_plan.GetN(),
+                                            max_parallel_workers_);
+    }
+
+    default: {
+      std::vector<AbstractPlanNodeRef> children;
+      for (size_t i = 0; i < plan->GetChildren().size(); i++) {
+        // The inner side of a nested loop join is initialized again for every outer tuple
+        if (plan->GetType() == PlanType::NestedLoopJoin && i == 1) {
+          children.emplace_back(plan->GetChildAt(i));
+          continue;
+        }
+        bool child_partial;
+        auto child = ParallelizePlan(plan->GetChildAt(i), &child_partial);
+        children.emplace_back(GatherIfPartial(child, child_partial));
+      }
+      return plan->CloneWithChildren(std::move(children));
+    }
+  }
+}
+
+}  // namespace hmssql
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// backup_manager.cpp
+//
+// Identification: src/recovery/backup_manager.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/recovery/backup_manager.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "../include/buffer/buffer_pool_manager_instance.h"
+#include "../include/common/exception.h"
+#include "../include/concurrency/transaction_manager.h"
+#include "../include/recovery/log_recovery.h"
+#include "../third_party/spdlog/spdlog.h"
+#include "fmt/format.h"
+
+namespace hmssql {
+
+namespace {
+
+void WriteManifest(const std::filesystem::path &file, const BackupManifest &manifest) {
+  std::ofstream out(file, std::ios::trunc);
+  out << "start_offset=" << manifest.start_offset_ << "\n"
+      << "end_offset=" << manifest.end_offset_ << "\n"
+      << "end_lsn=" << manifest.end_lsn_ << "\n"
+      << "page_count=" << manifest.page_count_ << "\n"
+      << "page_size=" << BUSTUB_PAGE_SIZE << "\n";
+  if (!out) {
+    throw Exception(fmt::format("can't write {}", file.string()));
+  }
+}
+
+auto ReadManifest(const std::filesystem::path &file) -> BackupManifest {
+  std::ifstream in(file);
+  if (!in) {
+    throw Exception(fmt::format("can't read {}", file.string()));
+  }
+  BackupManifest manifest;
+  std::string line;
+  while (std::getline(in, line)) {
+    auto eq = line.find('=');
+    if (eq == std::string::npos) {
+      continue;
+    }
+    auto key = line.substr(0, eq);
+    auto value = line.substr(eq + 1);
+    if (key == "start_offset") {
+      manifest.start_offset_ = std::stoull(value);
+    } else if (key == "end_offset") {
+      manifest.end_offset_ = std::stoull(value);
+    } else if (key == "end_lsn") {
+      manifest.end_lsn_ = std::stoi(value);
+    } else if (key == "page_count") {
+      manifest.page_count_ = std::stoi(value);
+    } else if (key == "page_size" && std::stoi(value) != BUSTUB_PAGE_SIZE) {
+      throw Exception(fmt::format("backup was taken with page size {}", value));
+    }
+  }
+  return manifest;
+}
+
+}  // namespace
+
+auto BackupManager::Backup(const std::string &backup_dir) -> BackupManifest {
+  namespace fs = std::filesystem;
+  std::unique_lock<std::mutex> lock(backup_latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    throw Exception("Backup already in progress");
+  }
+  if (!enable_logging || log_manager_ == nullptr || buffer_pool_manager_ == nullptr || txn_manager_ == nullptr) {
+    throw Exception("online backup needs the WAL, turn on enable_logging in the configuration");
+  }
+  std::error_code ec;
+  fs::path dir(backup_dir);
+  if (fs::exists(dir, ec) && !fs::is_empty(dir, ec)) {
+    throw Exception(fmt::format("backup directory {} is not empty", backup_dir));
+  }
+  fs::create_directories(dir, ec);
+  if (ec) {
+    throw Exception(fmt::format("can't create backup directory {}: {}", backup_dir, ec.message()));
+  }
+
+  // Everything logged before the start offset is in the database file once the dirty pages are written out, so the
+  // page copy plus the WAL from there on is enough to rebuild the database
+  BackupManifest manifest;
+  lsn_t start_lsn;
+  manifest.start_offset_ = log_manager_->FlushLogTail(&start_lsn);
+  disk_manager_->HoldLog(manifest.start_offset_);
+  // Restore undoes the unfinished transactions along their prevLSN chains, which must not reach back before the start
+  // offset. Transactions that logged earlier are waited for, so none of them is unfinished when the backup ends.
+  txn_manager_->WaitForLoggedTransactions();
+  buffer_pool_manager_->FlushAllPages();
+  spdlog::info("Backup to {} started at LSN {}", backup_dir, start_lsn);
+
+  std::ofstream wal_out(dir / WAL_FILE, std::ios::binary | std::ios::trunc);
+  archived_offset_ = manifest.start_offset_;
+  stop_offset_ = UINT64_MAX;
+  archive_failed_ = false;
+  std::thread archiver([this, &wal_out] { ArchiveLog(&wal_out); });
+
+  try {
+    std::ofstream pages_out(dir / PAGES_FILE, std::ios::binary | std::ios::trunc);
+    std::vector<char> chunk(static_cast<size_t>(BACKUP_CHUNK_PAGES) * BUSTUB_PAGE_SIZE);
+    // Pages allocated after this point are rebuilt from their NEWPAGE records
+    int page_count = disk_manager_->GetNumPages();
+    while (manifest.page_count_ < page_count) {
+      int read = disk_manager_->ReadPages(manifest.page_count_,
+                                          std::min(BACKUP_CHUNK_PAGES, page_count - manifest.page_count_),
+                                          chunk.data());
+      if (read == 0) {
+        break;
+      }
+      pages_out.write(chunk.data(), static_cast<std::streamsize>(read) * BUSTUB_PAGE_SIZE);
+      manifest.page_count_ += read;
+    }
+    pages_out.flush();
+    if (!pages_out) {
+      throw Exception(fmt::format("can't write {}", (dir / PAGES_FILE).string()));
+    }
+
+    // Every page write during the copy was preceded by the WAL describing it, the end of the log covers them all
+    manifest.end_offset_ = log_manager_->FlushLogTail(&manifest.end_lsn_);
+    stop_offset_ = manifest.end_offset_;
+  } catch (...) {
+    stop_offset_ = 0;
+    archiver.join();
+    disk_manager_->ReleaseLog();
+    throw;
+  }
+  archiver.join();
+  disk_manager_->ReleaseLog();
+
+  wal_out.flush();
+  if (archive_failed_ || !wal_out) {
+    throw Exception(fmt::format("can't archive the WAL into {}", (dir / WAL_FILE).string()));
+  }
+  WriteManifest(dir / MANIFEST_FILE, manifest);
+  spdlog::info("Backup to {} finished: {} pages, {} bytes of WAL up to LSN {}", backup_dir, manifest.page_count_,
+               manifest.end_offset_ - manifest.start_offset_, manifest.end_lsn_);
+  return manifest;
+}
+
+void BackupManager::ArchiveLog(std::ofstream *out) {
+  std::vector<char> buffer(ARCHIVE_CHUNK_SIZE);
+  while (archived_offset_ < stop_offset_) {
+    uint64_t tail = std::min<uint64_t>(disk_manager_->GetLogTail(), stop_offset_);
+    if (archived_offset_ >= tail) {
+      std::this_thread::sleep_for(ARCHIVE_POLL_INTERVAL);
+      continue;
+    }
+    auto chunk = static_cast<int>(std::min<uint64_t>(buffer.size(), tail - archived_offset_));
+    if (!disk_manager_->ReadLog(buffer.data(), chunk, archived_offset_)) {
+      archive_failed_ = true;
+      return;
+    }
+    out->write(buffer.data(), chunk);
+    archived_offset_ += chunk;
+    // Checkpoints may recycle the segments that are archived already
+    disk_manager_->HoldLog(archived_offset_);
+  }
+}
+
+auto BackupManager::Restore(const std::string &backup_dir, const std::string &db_file) -> BackupManifest {
+  namespace fs = std::filesystem;
+  fs::path dir(backup_dir);
+  auto manifest = ReadManifest(dir / MANIFEST_FILE);
+
+  std::error_code ec;
+  fs::copy_file(dir / PAGES_FILE, db_file, fs::copy_options::overwrite_existing, ec);
+  if (ec) {
+    throw Exception(fmt::format("can't restore {}: {}", db_file, ec.message()));
+  }
+
+  DiskManager disk_manager(db_file);
+  // The archived WAL becomes the whole log, its first block starts at offset 0
+  disk_manager.ResetLog();
+  std::ifstream wal_in(dir / WAL_FILE, std::ios::binary);
+  std::vector<char> buffer(ARCHIVE_CHUNK_SIZE);
+  while (wal_in) {
+    wal_in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (wal_in.gcount() > 0) {
+      disk_manager.WriteLog(buffer.data(), static_cast<int>(wal_in.gcount()), false);
+    }
+  }
+  disk_manager.FlushLog();
+  if (disk_manager.GetLogTail() != manifest.end_offset_ - manifest.start_offset_) {
+    throw Exception(fmt::format("WAL archive in {} is incomplete", backup_dir));
+  }
+
+  {
+    BufferPoolManagerInstance buffer_pool_manager(BUFFER_POOL_SIZE, &disk_manager, LRUK_REPLACER_K, nullptr);
+    LogRecovery log_recovery(&disk_manager, &buffer_pool_manager);
+    int applied = log_recovery.Redo();
+    if (log_recovery.GetLSN() != INVALID_LSN) {
+      manifest.end_lsn_ = log_recovery.GetLSN();
+    }
+    int undone = log_recovery.Undo();
+    buffer_pool_manager.FlushAllPages();
+    spdlog::info("Restored {} from {}: {} pages, {} log records redone, {} unfinished transactions undone, consistent "
+                 "at LSN {}",
+                 db_file, backup_dir, manifest.page_count_, applied, undone, manifest.end_lsn_);
+  }
+
+  // Every change is in the database file now
+  disk_manager.ResetLog();
+  disk_manager.ShutDown();
+  return manifest;
+}
+
+}  // namespace hmssql
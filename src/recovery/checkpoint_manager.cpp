@@ -25,15 +25,23 @@ void CheckpointManager::BeginCheckpoint() {
   // Set checkpoint flag
   checkpoint_in_progress_ = true;
   
-  // Flush WAL
+  // Flush WAL, everything logged so far is covered by the page flush below,
+  // so the current end of the log becomes the redo point
+  uint64_t redo_offset = 0;
   if (log_manager_ != nullptr) {
     log_manager_->FlushAllLogs();
+    redo_offset = log_manager_->GetDiskManager()->GetLogTail();
   }
   
   // Flush all dirty pages to disk
   if (buffer_pool_manager_ != nullptr) {
     buffer_pool_manager_->FlushAllPages();
   }
+
+  // Segments before the redo point are no longer needed for recovery
+  if (log_manager_ != nullptr) {
+    log_manager_->GetDiskManager()->TruncateLog(redo_offset);
+  }
 }
 
 void CheckpointManager::EndCheckpoint() {
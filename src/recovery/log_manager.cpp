@@ -9,6 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
+
+#include "../include/common/config.h"
+#include "../include/common/macros.h"
 #include "../include/recovery/log_manager.h"
 #include "../third_party/spdlog/spdlog.h"
 
@@ -19,15 +23,15 @@ void LogManager::RunFlushThread() {
     if (flush_thread_running_) {
         return;
     }
-    
+
     flush_thread_running_ = true;
     flush_thread_ = new std::thread([this] {
+        std::unique_lock<std::mutex> guard(latch_);
         while (flush_thread_running_) {
-            std::unique_lock<std::mutex> guard(latch_);
-            if (!log_buffer_.empty()) {
-                FlushAllLogs();
-            }
-            cv_.wait_for(guard, std::chrono::milliseconds(100));
+            cv_.wait_for(guard, log_timeout);
+            guard.unlock();
+            FlushLogBuffer();
+            guard.lock();
         }
     });
 }
@@ -40,45 +44,148 @@ void LogManager::StopFlushThread() {
         }
         flush_thread_running_ = false;
     }
-    
+
     cv_.notify_one();
     if (flush_thread_ && flush_thread_->joinable()) {
         flush_thread_->join();
         delete flush_thread_;
         flush_thread_ = nullptr;
     }
+    FlushLogBuffer();
 }
 
 void LogManager::FlushAllLogs() {
-    std::unique_lock<std::mutex> lock(latch_);
-    
-    if (log_buffer_.empty()) {
+    FlushLogBuffer();
+}
+
+void LogManager::Flush(lsn_t lsn) {
+    if (lsn == INVALID_LSN || persistent_lsn_ >= lsn) {
         return;
     }
+    // A flush that was already in flight may have covered lsn by the time we get the latch
+    std::scoped_lock<std::mutex> flush_lock(flush_latch_);
+    if (persistent_lsn_ >= lsn) {
+        return;
+    }
+    // The previous flush buffer is already on disk, so everything up to lsn is in the log buffer
+    lsn_t flushed_lsn;
+    int flush_size;
+    {
+        std::scoped_lock<std::mutex> lock(latch_);
+        flush_size = log_buffer_offset_;
+        flushed_lsn = next_lsn_ - 1;
+        if (flush_size > LOG_BLOCK_HEADER_SIZE) {
+            std::swap(log_buffer_, flush_buffer_);
+            log_buffer_offset_ = LOG_BLOCK_HEADER_SIZE;
+        }
+    }
+    if (flush_size > LOG_BLOCK_HEADER_SIZE) {
+        WriteLogBlock(flush_size);
+        disk_manager_->FlushLog();
+    }
+    persistent_lsn_ = flushed_lsn;
+}
 
-    for (const auto& record : log_buffer_) {
-        // No need to remove const now since WriteLog accepts const char*
-        disk_manager_->WriteLog(
-            reinterpret_cast<const char*>(&record),
-            sizeof(LogRecord)
-        );
-        // GetLSN() is now const-qualified
-        persistent_lsn_ = record.GetLSN();
+auto LogManager::FlushLogTail(lsn_t *tail_lsn) -> uint64_t {
+    FlushLogBuffer();
+    // No block can be written while flush_latch_ is held, so the tail and persistent_lsn_ match
+    std::scoped_lock<std::mutex> flush_lock(flush_latch_);
+    *tail_lsn = persistent_lsn_;
+    return disk_manager_->GetLogTail();
+}
+
+void LogManager::WriteLogBlock(int flush_size) {
+    auto raw_size = static_cast<uint32_t>(flush_size - LOG_BLOCK_HEADER_SIZE);
+    if (GetLogCompression()) {
+        size_t compressed_size =
+            CompressionUtil::Compress(flush_buffer_ + LOG_BLOCK_HEADER_SIZE, raw_size,
+                                      compress_buffer_ + LOG_BLOCK_HEADER_SIZE,
+                                      CompressionUtil::MaxCompressedSize(LOG_BUFFER_SIZE));
+        if (compressed_size > 0 && compressed_size < raw_size) {
+            auto stored_size = static_cast<uint32_t>(compressed_size);
+            memcpy(compress_buffer_, &raw_size, sizeof(uint32_t));
+            memcpy(compress_buffer_ + 4, &stored_size, sizeof(uint32_t));
+            disk_manager_->WriteLog(compress_buffer_, LOG_BLOCK_HEADER_SIZE + stored_size);
+            return;
+        }
     }
-    
-    disk_manager_->FlushLog();
-    log_buffer_.clear();
-    
-    spdlog::info("Flushed {} log records to disk", log_buffer_.size());
+    memcpy(flush_buffer_, &raw_size, sizeof(uint32_t));
+    memcpy(flush_buffer_ + 4, &raw_size, sizeof(uint32_t));
+    disk_manager_->WriteLog(flush_buffer_, flush_size);
+}
+
+void LogManager::FlushLogBuffer() {
+    Flush(next_lsn_ - 1);
+    spdlog::debug("Log flushed up to LSN {}", persistent_lsn_.load());
 }
 
+/*
+ * Serialize the log record into the log buffer, see log_record.h for the layout
+ * of each record type. The LSN is assigned here, so records are ordered in the
+ * buffer exactly as their LSNs are.
+ */
 auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+    BUSTUB_ASSERT(log_record->size_ <= LOG_BUFFER_SIZE - LOG_BLOCK_HEADER_SIZE,
+                  "Log record does not fit into the log buffer.");
     std::unique_lock<std::mutex> lock(latch_);
-    
+    while (log_buffer_offset_ + log_record->size_ > LOG_BUFFER_SIZE) {
+        lock.unlock();
+        FlushLogBuffer();
+        lock.lock();
+    }
+
     log_record->lsn_ = next_lsn_++;
-    log_buffer_.push_back(*log_record);
-    
+    char *pos = log_buffer_ + log_buffer_offset_;
+    memcpy(pos, &log_record->size_, sizeof(int32_t));
+    memcpy(pos + 4, &log_record->lsn_, sizeof(lsn_t));
+    memcpy(pos + 8, &log_record->txn_id_, sizeof(txn_id_t));
+    memcpy(pos + 12, &log_record->prev_lsn_, sizeof(lsn_t));
+    memcpy(pos + 16, &log_record->log_record_type_, sizeof(LogRecordType));
+    pos += LogRecord::HEADER_SIZE;
+
+    switch (log_record->log_record_type_) {
+        case LogRecordType::INSERT:
+            memcpy(pos, &log_record->insert_rid_, sizeof(RID));
+            pos += sizeof(RID);
+            log_record->insert_tuple_.SerializeTo(pos);
+            break;
+        case LogRecordType::MARKDELETE:
+        case LogRecordType::APPLYDELETE:
+        case LogRecordType::ROLLBACKDELETE:
+            memcpy(pos, &log_record->delete_rid_, sizeof(RID));
+            pos += sizeof(RID);
+            log_record->delete_tuple_.SerializeTo(pos);
+            break;
+        case LogRecordType::UPDATE:
+            memcpy(pos, &log_record->update_rid_, sizeof(RID));
+            pos += sizeof(RID);
+            log_record->old_tuple_.SerializeTo(pos);
+            pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+            log_record->new_tuple_.SerializeTo(pos);
+            break;
+        case LogRecordType::UPDATE_DELTA:
+            memcpy(pos, &log_record->update_rid_, sizeof(RID));
+            pos += sizeof(RID);
+            memcpy(pos, log_record->update_delta_.data(), log_record->update_delta_.size());
+            break;
+        case LogRecordType::NEWPAGE:
+            memcpy(pos, &log_record->prev_page_id_, sizeof(page_id_t));
+            pos += sizeof(page_id_t);
+            memcpy(pos, &log_record->page_id_, sizeof(page_id_t));
+            break;
+        case LogRecordType::CREATE_DATABASE: {
+            size_t name_length = log_record->database_name_.length();
+            memcpy(pos, &name_length, sizeof(size_t));
+            pos += sizeof(size_t);
+            memcpy(pos, log_record->database_name_.data(), name_length);
+            break;
+        }
+        default:
+            break;
+    }
+    log_buffer_offset_ += log_record->size_;
+
     return log_record->lsn_;
 }
 
-} // namespace hmssql
\ No newline at end of file
+} // namespace hmssql
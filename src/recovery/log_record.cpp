@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/recovery/log_record.h"
+
+#include <cstring>
+#include <vector>
+
+namespace hmssql {
+
+namespace {
+
+/** @return the number of bytes a serialized value of the given type occupies at storage */
+auto SerializedSize(const char *storage, TypeId type_id) -> uint32_t {
+  if (type_id != TypeId::VARCHAR) {
+    return Type::GetTypeSize(type_id);
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(storage);
+  return len == BUSTUB_VALUE_NULL ? sizeof(uint32_t) : sizeof(uint32_t) + len;
+}
+
+/** @return the value in the form it is stored in a tuple: fixed-size bytes, or length followed by the varlen data */
+auto SerializeValue(const Value &value) -> std::string {
+  uint32_t size = Type::GetTypeSize(value.GetTypeId());
+  if (value.GetTypeId() == TypeId::VARCHAR) {
+    size = value.IsNull() ? sizeof(uint32_t) : sizeof(uint32_t) + value.GetLength();
+  }
+  std::string bytes(size, '\0');
+  value.SerializeTo(bytes.data());
+  return bytes;
+}
+
+}  // namespace
+
+LogRecord::LogRecord(txn_id_t txn_id, lsn_t prev_lsn, const RID &update_rid, const Tuple &old_tuple,
+                     const Tuple &new_tuple, const Schema &schema)
+    : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(LogRecordType::UPDATE_DELTA), update_rid_(update_rid) {
+  auto column_count = static_cast<uint16_t>(schema.GetColumnCount());
+  std::string bitmap((column_count + 7) / 8, '\0');
+  std::string changed_values;
+  // The old values of the changed columns are what undo needs
+  std::string old_values;
+  for (uint16_t i = 0; i < column_count; i++) {
+    auto new_bytes = SerializeValue(new_tuple.GetValue(&schema, i));
+    auto old_bytes = SerializeValue(old_tuple.GetValue(&schema, i));
+    if (new_bytes != old_bytes) {
+      bitmap[i / 8] = static_cast<char>(bitmap[i / 8] | (1 << (i % 8)));
+      changed_values += new_bytes;
+      old_values += old_bytes;
+    }
+  }
+
+  update_delta_.reserve(sizeof(uint16_t) + column_count + bitmap.size() + changed_values.size() + old_values.size());
+  update_delta_.append(reinterpret_cast<const char *>(&column_count), sizeof(uint16_t));
+  for (uint16_t i = 0; i < column_count; i++) {
+    update_delta_.push_back(static_cast<char>(schema.GetColumn(i).GetType()));
+  }
+  update_delta_ += bitmap;
+  update_delta_ += changed_values;
+  update_delta_ += old_values;
+  // calculate log record size
+  size_ = HEADER_SIZE + sizeof(RID) + update_delta_.size();
+}
+
+auto LogRecord::ApplyUpdateDelta(const Tuple &old_tuple) const -> Tuple { return ReplaceDeltaColumns(old_tuple, false); }
+
+auto LogRecord::UndoUpdateDelta(const Tuple &new_tuple) const -> Tuple {
+  return ReplaceDeltaColumns(new_tuple, true);
+}
+
+auto LogRecord::ReplaceDeltaColumns(const Tuple &tuple, bool old_values) const -> Tuple {
+  BUSTUB_ASSERT(log_record_type_ == LogRecordType::UPDATE_DELTA, "Not a delta-encoded update.");
+  const char *pos = update_delta_.data();
+  uint16_t column_count;
+  memcpy(&column_count, pos, sizeof(uint16_t));
+  pos += sizeof(uint16_t);
+
+  // Column names and varchar lengths do not matter for the tuple layout, only the types do.
+  std::vector<Column> columns;
+  columns.reserve(column_count);
+  for (uint16_t i = 0; i < column_count; i++) {
+    auto type_id = static_cast<TypeId>(pos[i]);
+    if (type_id == TypeId::VARCHAR) {
+      columns.emplace_back("#" + std::to_string(i), type_id, VARCHAR_DEFAULT_LENGTH);
+    } else {
+      columns.emplace_back("#" + std::to_string(i), type_id);
+    }
+  }
+  pos += column_count;
+  Schema schema(columns);
+
+  const char *bitmap = pos;
+  pos += (column_count + 7) / 8;
+  auto changed = [bitmap](uint16_t i) { return (bitmap[i / 8] & (1 << (i % 8))) != 0; };
+  if (old_values) {
+    // The old values follow the new ones
+    for (uint16_t i = 0; i < column_count; i++) {
+      if (changed(i)) {
+        pos += SerializedSize(pos, columns[i].GetType());
+      }
+    }
+  }
+  std::vector<Value> values;
+  values.reserve(column_count);
+  for (uint16_t i = 0; i < column_count; i++) {
+    if (changed(i)) {
+      auto type_id = columns[i].GetType();
+      values.push_back(Value::DeserializeFrom(pos, type_id));
+      pos += SerializedSize(pos, type_id);
+    } else {
+      values.push_back(tuple.GetValue(&schema, i));
+    }
+  }
+  return {values, &schema};
+}
+
+}  // namespace hmssql
@@ -11,15 +11,79 @@
 
 #include "../include/recovery/log_recovery.h"
 
+#include <cstring>
+
+#include "../include/common/util/compression_util.h"
+#include "../include/recovery/log_manager.h"
 #include "../include/storage/page/table_page.h"
+#include "../third_party/spdlog/spdlog.h"
 
 namespace hmssql {
+
+namespace {
+
+/** A page that was allocated but never written out reads back as zeros. */
+auto IsZeroPage(Page *page) -> bool {
+  const char *data = page->GetData();
+  return data[0] == 0 && memcmp(data, data + 1, BUSTUB_PAGE_SIZE - 1) == 0;
+}
+
+}  // namespace
+
 /*
  * deserialize a log record from log buffer
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool { return false; }
+auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool {
+  memcpy(&log_record->size_, data, sizeof(int32_t));
+  if (log_record->size_ < LogRecord::HEADER_SIZE) {
+    return false;
+  }
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  memcpy(&log_record->log_record_type_, data + 16, sizeof(LogRecordType));
+  const char *pos = data + LogRecord::HEADER_SIZE;
+
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::UPDATE_DELTA:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->update_delta_.assign(pos, log_record->size_ - LogRecord::HEADER_SIZE - sizeof(RID));
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::CREATE_DATABASE: {
+      size_t name_length;
+      memcpy(&name_length, pos, sizeof(size_t));
+      log_record->database_name_.assign(pos + sizeof(size_t), name_length);
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -28,12 +92,271 @@ auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+auto LogRecovery::ReadLogBlock(uint64_t offset, uint32_t *raw_size) -> bool {
+  uint64_t tail = disk_manager_->GetLogTail();
+  uint32_t stored_size;
+  char block_header[LogManager::LOG_BLOCK_HEADER_SIZE];
+  if (offset + LogManager::LOG_BLOCK_HEADER_SIZE > tail ||
+      !disk_manager_->ReadLog(block_header, LogManager::LOG_BLOCK_HEADER_SIZE, offset)) {
+    return false;
+  }
+  memcpy(raw_size, block_header, sizeof(uint32_t));
+  memcpy(&stored_size, block_header + 4, sizeof(uint32_t));
+  if (*raw_size > static_cast<uint32_t>(LOG_BUFFER_SIZE) || stored_size > *raw_size ||
+      offset + LogManager::LOG_BLOCK_HEADER_SIZE + stored_size > tail) {
+    spdlog::warn("Log block at offset {} is incomplete", offset);
+    return false;
+  }
+  // Uncompressed blocks are read directly into the record buffer
+  char *stored = stored_size == *raw_size ? log_buffer_ : block_buffer_;
+  if (!disk_manager_->ReadLog(stored, static_cast<int>(stored_size), offset + LogManager::LOG_BLOCK_HEADER_SIZE)) {
+    return false;
+  }
+  if (stored_size != *raw_size &&
+      CompressionUtil::Decompress(block_buffer_, stored_size, log_buffer_, LOG_BUFFER_SIZE) != *raw_size) {
+    spdlog::warn("Log block at offset {} does not decompress", offset);
+    return false;
+  }
+  offset_ = offset + LogManager::LOG_BLOCK_HEADER_SIZE + stored_size;
+  return true;
+}
+
+auto LogRecovery::Redo() -> int {
+  int applied = 0;
+  offset_ = disk_manager_->GetLogHead();
+  uint32_t raw_size;
+  while (true) {
+    uint64_t block_offset = offset_;
+    if (!ReadLogBlock(block_offset, &raw_size)) {
+      break;
+    }
+    for (uint32_t pos = 0; pos + LogRecord::HEADER_SIZE <= raw_size;) {
+      LogRecord log_record;
+      if (!DeserializeLogRecord(log_buffer_ + pos, &log_record) || pos + log_record.size_ > raw_size) {
+        break;
+      }
+      lsn_mapping_[log_record.lsn_] = static_cast<int>(block_offset);
+      if (log_record.txn_id_ != INVALID_TXN_ID) {
+        if (log_record.log_record_type_ == LogRecordType::COMMIT ||
+            log_record.log_record_type_ == LogRecordType::ABORT) {
+          active_txn_.erase(log_record.txn_id_);
+        } else {
+          active_txn_[log_record.txn_id_] = log_record.lsn_;
+        }
+      }
+      if (const RID *rid = TupleRidOf(&log_record); rid != nullptr) {
+        last_writer_[*rid] = log_record.txn_id_;
+      }
+      if (RedoLogRecord(&log_record)) {
+        applied++;
+      }
+      pos += log_record.size_;
+    }
+  }
+  // Undo reads blocks into the same buffer
+  buffered_block_ = -1;
+  return applied;
+}
+
+auto LogRecovery::TupleRidOf(LogRecord *log_record) -> const RID * {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      return &log_record->insert_rid_;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return &log_record->delete_rid_;
+    case LogRecordType::UPDATE:
+    case LogRecordType::UPDATE_DELTA:
+      return &log_record->update_rid_;
+    default:
+      return nullptr;
+  }
+}
+
+auto LogRecovery::RedoLogRecord(LogRecord *log_record) -> bool {
+  page_id_t page_id;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      page_id = log_record->insert_rid_.GetPageId();
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      page_id = log_record->delete_rid_.GetPageId();
+      break;
+    case LogRecordType::UPDATE:
+    case LogRecordType::UPDATE_DELTA:
+      page_id = log_record->update_rid_.GetPageId();
+      break;
+    case LogRecordType::NEWPAGE:
+      page_id = log_record->page_id_;
+      break;
+    default:
+      return false;
+  }
+
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(fmt::format("redo can't fetch page {}", page_id));
+  }
+  // A page written out after the record was logged already contains it
+  bool redo = IsZeroPage(page) || page->GetLSN() < log_record->lsn_;
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    // Only initialize pages that never reached the disk, a page that did may hold later changes already
+    redo = IsZeroPage(page) || page->GetTablePageId() != page_id;
+  }
+  if (redo) {
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT: {
+        RID rid;
+        page->InsertTuple(log_record->insert_tuple_, &rid, nullptr);
+        if (!(rid == log_record->insert_rid_)) {
+          spdlog::warn("Redo of LSN {} inserted at {} instead of {}", log_record->lsn_, rid.ToString(),
+                       log_record->insert_rid_.ToString());
+        }
+        break;
+      }
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record->delete_rid_, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record->delete_rid_, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record->delete_rid_, nullptr);
+        break;
+      case LogRecordType::UPDATE: {
+        Tuple old_tuple;
+        page->UpdateTuple(log_record->new_tuple_, &old_tuple, log_record->update_rid_, nullptr);
+        break;
+      }
+      case LogRecordType::UPDATE_DELTA: {
+        Tuple old_tuple;
+        if (page->GetTuple(log_record->update_rid_, &old_tuple)) {
+          auto new_tuple = log_record->ApplyUpdateDelta(old_tuple);
+          page->UpdateTuple(new_tuple, &old_tuple, log_record->update_rid_, nullptr);
+        }
+        break;
+      }
+      case LogRecordType::NEWPAGE:
+        page->Init(page_id, BUSTUB_PAGE_SIZE, log_record->prev_page_id_, nullptr);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(log_record->lsn_);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, redo);
+
+  // The link from the previous page is not logged on its own, so restore it together with the new page
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE && log_record->prev_page_id_ != INVALID_PAGE_ID) {
+    auto prev_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(log_record->prev_page_id_));
+    if (prev_page != nullptr) {
+      bool relink = prev_page->GetNextPageId() != page_id;
+      if (relink) {
+        prev_page->SetNextPageId(page_id);
+      }
+      buffer_pool_manager_->UnpinPage(log_record->prev_page_id_, relink);
+    }
+  }
+  return redo;
+}
+
+auto LogRecovery::FindLogRecord(lsn_t lsn, LogRecord *log_record) -> bool {
+  auto it = lsn_mapping_.find(lsn);
+  if (it == lsn_mapping_.end()) {
+    return false;
+  }
+  // A transaction writes runs of records into the same block, so keep the last one read
+  if (it->second != buffered_block_) {
+    buffered_block_ = -1;
+    if (!ReadLogBlock(it->second, &buffered_size_)) {
+      return false;
+    }
+    buffered_block_ = it->second;
+  }
+  for (uint32_t pos = 0; pos + LogRecord::HEADER_SIZE <= buffered_size_;) {
+    LogRecord candidate;
+    if (!DeserializeLogRecord(log_buffer_ + pos, &candidate) || pos + candidate.size_ > buffered_size_) {
+      return false;
+    }
+    if (candidate.lsn_ == lsn) {
+      *log_record = candidate;
+      return true;
+    }
+    pos += candidate.size_;
+  }
+  return false;
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+auto LogRecovery::Undo() -> int {
+  int undone = 0;
+  for (const auto &[txn_id, last_lsn] : active_txn_) {
+    for (lsn_t lsn = last_lsn; lsn != INVALID_LSN;) {
+      LogRecord log_record;
+      if (!FindLogRecord(lsn, &log_record)) {
+        spdlog::warn("Undo of transaction {} can't find LSN {}, its earlier changes stay", txn_id, lsn);
+        break;
+      }
+      // A rollback of the row, or a writer after it, is logged later. The row is restored already.
+      const RID *rid = TupleRidOf(&log_record);
+      if (rid != nullptr && last_writer_[*rid] == txn_id) {
+        UndoLogRecord(&log_record);
+      }
+      lsn = log_record.prev_lsn_;
+    }
+    undone++;
+  }
+  active_txn_.clear();
+  last_writer_.clear();
+  return undone;
+}
+
+auto LogRecovery::UndoLogRecord(LogRecord *log_record) -> bool {
+  const RID &rid = *TupleRidOf(log_record);
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) {
+    throw Exception(fmt::format("undo can't fetch page {}", rid.GetPageId()));
+  }
+  Tuple current;
+  bool is_deleted = false;
+  bool undone = page->GetTuple(rid, &current, &is_deleted);
+  if (undone) {
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT:
+        // A freed slot has no tuple left to remove
+        undone = current.GetLength() != 0;
+        if (undone) {
+          page->ApplyDelete(rid, nullptr);
+        }
+        break;
+      case LogRecordType::MARKDELETE:
+        undone = is_deleted;
+        if (undone) {
+          page->RollbackDelete(rid, nullptr);
+        }
+        break;
+      case LogRecordType::UPDATE:
+        undone = page->UpdateTuple(log_record->old_tuple_, &current, rid, nullptr);
+        break;
+      case LogRecordType::UPDATE_DELTA:
+        undone = page->UpdateTuple(log_record->UndoUpdateDelta(current), &current, rid, nullptr);
+        break;
+      default:
+        undone = false;
+        break;
+    }
+  }
+  if (!undone) {
+    spdlog::warn("Undo of LSN {} can't restore tuple {}", log_record->lsn_, rid.ToString());
+  }
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), undone);
+  return undone;
+}
 
 }  // namespace hmssql
@@ -10,9 +10,13 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <map>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
@@ -28,13 +32,22 @@
 #include "../include/common/exception.h"
 #include "../include/storage/disk/disk_manager.h"
 #include "../third_party/spdlog/spdlog.h"
+#include "fmt/format.h"
 
 namespace hmssql {
 
-char* DiskManager::buffer_used = nullptr;
+namespace {
+
+/** @return the first log block starting in the segment, headers written before the field existed hold zero there */
+auto FirstLogBlock(const LogSegmentHeader &header) -> uint64_t {
+  return header.first_block_offset_ == 0 && header.segment_no_ > 0 ? header.start_offset_
+                                                                    : header.first_block_offset_;
+}
+
+}  // namespace
 
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create a single database file & the log segments
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
@@ -45,16 +58,12 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  log_segment_size_ = static_cast<uint64_t>(GetLogSegmentSize());
+  max_recycled_segments_ = static_cast<uint64_t>(std::max(GetMaxRecycledLogSegments(), 0));
+  if (log_segment_size_ < static_cast<uint64_t>(LOG_SEGMENT_HEADER_SIZE + BUSTUB_PAGE_SIZE)) {
+    throw Exception("log segment size is too small");
   }
+  OpenLogSegments();
 
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
@@ -67,7 +76,6 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw Exception("can't open db file");
     }
   }
-  buffer_used = nullptr;
 }
 
 /**
@@ -78,7 +86,10 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
   log_io_.close();
+  log_read_io_.close();
+  CloseLogSyncHandle();
 }
 
 void DiskManager::SyncFile(std::fstream& file) {
@@ -110,8 +121,15 @@ void DiskManager::SyncFile(std::fstream& file) {
 }
 
 void DiskManager::FlushLog() {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
   if (log_io_.is_open()) {
       SyncFile(log_io_);
+#ifndef _WIN32
+      // pubsync only hands the data to the OS, commits need it on stable storage
+      if (log_sync_fd_ >= 0) {
+          fdatasync(log_sync_fd_);
+      }
+#endif
       spdlog::debug("Log file synced to disk");
   }
 }
@@ -164,18 +182,42 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+auto DiskManager::ReadPages(page_id_t first_page_id, int count, char *page_data) -> int {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  int file_size = GetFileSize(file_name_);
+  int64_t offset = static_cast<int64_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  if (file_size < 0 || offset >= file_size) {
+    return 0;
+  }
+  count = std::min<int64_t>(count, (file_size - offset) / BUSTUB_PAGE_SIZE);
+  db_io_.seekg(offset);
+  db_io_.read(page_data, static_cast<std::streamsize>(count) * BUSTUB_PAGE_SIZE);
+  if (db_io_.bad()) {
+    db_io_.clear();
+    return 0;
+  }
+  int read_count = static_cast<int>(db_io_.gcount() / BUSTUB_PAGE_SIZE);
+  db_io_.clear();
+  return read_count;
+}
+
+auto DiskManager::GetNumPages() -> int {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  int file_size = GetFileSize(file_name_);
+  return file_size < 0 ? 0 : file_size / BUSTUB_PAGE_SIZE;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
-void DiskManager::WriteLog(const char *log_data, int size) {
-  // enforce swap log buffer
-  if (const_cast<char*>(log_data) == buffer_used) {
+void DiskManager::WriteLog(const char *log_data, int size, bool block_start) {
+  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
       return;
   }
-  buffer_used = const_cast<char*>(log_data);  // Safe since we only use it for comparison
 
-  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  if (!log_io_.is_open()) {
       return;
   }
 
@@ -187,14 +229,33 @@ void DiskManager::WriteLog(const char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
-
-  // check for I/O error
-  if (log_io_.bad()) {
-      //LOG_DEBUG("I/O error while writing log");
-      return;
+  // The log starts with a block, also when it is a raw copy of another log
+  block_start = block_start || log_tail_ == 0;
+  // sequence write, continuing in the next segment once the current one is full
+  uint64_t remaining = static_cast<uint64_t>(size);
+  while (remaining > 0) {
+      if (current_segment_used_ == LogSegmentPayloadSize()) {
+          SwitchLogSegment();
+      }
+      if (block_start && current_first_block_ == LogSegmentHeader::NO_BLOCK) {
+          current_first_block_ = log_tail_;
+      }
+      block_start = false;
+      uint64_t chunk = std::min(remaining, LogSegmentPayloadSize() - current_segment_used_);
+      log_io_.seekp(LOG_SEGMENT_HEADER_SIZE + current_segment_used_);
+      log_io_.write(log_data, chunk);
+      // check for I/O error
+      if (log_io_.bad()) {
+          //LOG_DEBUG("I/O error while writing log");
+          return;
+      }
+      log_data += chunk;
+      remaining -= chunk;
+      current_segment_used_ += chunk;
+      log_tail_ += chunk;
   }
+  WriteLogSegmentHeader(log_io_, current_log_segment_, current_segment_used_, current_first_block_);
+
   // needs to flush to keep disk file in sync
   log_io_.flush();
   flush_log_ = false;
@@ -202,32 +263,296 @@ void DiskManager::WriteLog(const char *log_data, int size) {
 
 /**
  * Read the contents of the log into the given memory area
- * Always read from the beginning and perform sequence read
+ * Perform sequence read starting at the given logical offset; the bounds are
+ * tracked in memory, so no file system call is needed to find the end of the log
  * @return: false means already reach the end
  */
-auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
-  if (offset >= GetFileSize(log_name_)) {
+auto DiskManager::ReadLog(char *log_data, int size, uint64_t offset) -> bool {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  uint64_t payload_size = LogSegmentPayloadSize();
+  if (offset >= log_tail_ || offset < first_log_segment_ * payload_size) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
 
-  if (log_io_.bad()) {
-    //LOG_DEBUG("I/O error while reading log");
-    return false;
+  int read_count = 0;
+  while (read_count < size && offset < log_tail_) {
+    uint64_t segment_no = offset / payload_size;
+    uint64_t segment_offset = offset % payload_size;
+    uint64_t chunk = std::min({static_cast<uint64_t>(size - read_count), payload_size - segment_offset,
+                               log_tail_ - offset});
+
+    std::fstream *file = &log_io_;
+    if (segment_no != current_log_segment_) {
+      if (!log_read_io_.is_open() || log_read_segment_ != segment_no) {
+        log_read_io_.close();
+        log_read_io_.clear();
+        log_read_io_.open(GetLogSegmentName(segment_no), std::ios::binary | std::ios::in);
+        log_read_segment_ = segment_no;
+      }
+      file = &log_read_io_;
+    }
+    file->seekg(LOG_SEGMENT_HEADER_SIZE + segment_offset);
+    file->read(log_data + read_count, chunk);
+    if (file->bad() || static_cast<uint64_t>(file->gcount()) < chunk) {
+      //LOG_DEBUG("I/O error while reading log");
+      file->clear();
+      return false;
+    }
+    read_count += chunk;
+    offset += chunk;
   }
-  // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
+
+  // if log ends before reading "size"
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
   return true;
 }
 
+auto DiskManager::GetLogTail() -> uint64_t {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  return log_tail_;
+}
+
+auto DiskManager::GetLogHead() -> uint64_t {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  return log_head_;
+}
+
+/**
+ * Recycle every segment that lies completely before the redo offset. Segments
+ * are renamed past the last existing one so the files (and their disk blocks)
+ * are reused instead of being deleted and allocated again.
+ */
+void DiskManager::TruncateLog(uint64_t redo_offset) {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  if (!log_io_.is_open()) {
+    return;
+  }
+  uint64_t keep_offset = std::min(redo_offset, log_hold_offset_);
+  uint64_t redo_segment = keep_offset / LogSegmentPayloadSize();
+  // Reading the log starts at a block, keep the segment the block holding the redo offset starts in
+  while (redo_segment > first_log_segment_ && GetFirstLogBlock(redo_segment) > keep_offset) {
+    redo_segment--;
+  }
+  uint64_t recycled = 0;
+  uint64_t removed = 0;
+  while (first_log_segment_ < redo_segment && first_log_segment_ < current_log_segment_) {
+    auto old_name = GetLogSegmentName(first_log_segment_);
+    if (log_read_io_.is_open() && log_read_segment_ == first_log_segment_) {
+      log_read_io_.close();
+    }
+    if (last_log_segment_ - current_log_segment_ < max_recycled_segments_) {
+      auto new_name = GetLogSegmentName(last_log_segment_ + 1);
+      if (std::rename(old_name.c_str(), new_name.c_str()) != 0) {
+        throw Exception("can't recycle log segment " + old_name);
+      }
+      std::fstream file(new_name, std::ios::binary | std::ios::in | std::ios::out);
+      WriteLogSegmentHeader(file, last_log_segment_ + 1, 0);
+      last_log_segment_++;
+      recycled++;
+    } else {
+      std::remove(old_name.c_str());
+      removed++;
+    }
+    first_log_segment_++;
+  }
+  if (recycled + removed > 0) {
+    log_head_ = GetFirstLogBlock(first_log_segment_);
+    spdlog::debug("Log truncated before offset {}: {} segments recycled, {} removed", redo_offset, recycled, removed);
+  }
+}
+
+void DiskManager::HoldLog(uint64_t offset) {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  log_hold_offset_ = offset;
+}
+
+void DiskManager::ReleaseLog() {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  log_hold_offset_ = UINT64_MAX;
+}
+
+void DiskManager::ResetLog() {
+  std::scoped_lock scoped_log_io_latch(log_io_latch_);
+  log_io_.close();
+  log_read_io_.close();
+  CloseLogSyncHandle();
+  for (uint64_t segment_no = first_log_segment_; segment_no <= last_log_segment_; segment_no++) {
+    std::remove(GetLogSegmentName(segment_no).c_str());
+  }
+  first_log_segment_ = current_log_segment_ = last_log_segment_ = 0;
+  current_segment_used_ = 0;
+  current_first_block_ = LogSegmentHeader::NO_BLOCK;
+  CreateLogSegment(0);
+  log_head_ = 0;
+  log_tail_ = 0;
+
+  log_io_.clear();
+  log_io_.open(GetLogSegmentName(0), std::ios::binary | std::ios::in | std::ios::out);
+  if (!log_io_.is_open()) {
+    throw Exception("can't open dblog file");
+  }
+  OpenLogSyncHandle();
+}
+
+auto DiskManager::GetLogSegmentName(uint64_t segment_no) const -> std::string {
+  return fmt::format("{}.{:08X}", log_name_, segment_no);
+}
+
+void DiskManager::OpenLogSegments() {
+  namespace fs = std::filesystem;
+  fs::path log_path(log_name_);
+  fs::path directory = log_path.parent_path().empty() ? fs::path(".") : log_path.parent_path();
+  std::string prefix = log_path.filename().string() + ".";
+
+  std::map<uint64_t, LogSegmentHeader> segments;
+  std::error_code ec;
+  for (const auto &entry : fs::directory_iterator(directory, ec)) {
+    auto name = entry.path().filename().string();
+    if (name.size() != prefix.size() + 8 || name.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    LogSegmentHeader header;
+    if (!ReadLogSegmentHeader(entry.path().string(), &header)) {
+      continue;
+    }
+    if (fs::path(GetLogSegmentName(header.segment_no_)).filename().string() != name) {
+      spdlog::warn("Ignoring misnamed log segment {}", name);
+      continue;
+    }
+    segments[header.segment_no_] = header;
+  }
+
+  if (segments.empty()) {
+    CreateLogSegment(0);
+  } else {
+    first_log_segment_ = segments.begin()->first;
+    last_log_segment_ = segments.rbegin()->first;
+    current_log_segment_ = first_log_segment_;
+    for (const auto &[segment_no, header] : segments) {
+      if (header.used_ > 0) {
+        current_log_segment_ = segment_no;
+      }
+    }
+    current_segment_used_ = segments[current_log_segment_].used_;
+    current_first_block_ = FirstLogBlock(segments[current_log_segment_]);
+  }
+  log_tail_ = current_log_segment_ * LogSegmentPayloadSize() + current_segment_used_;
+  // The first block of the log, a block that started in a lost segment can't be read
+  log_head_ = log_tail_;
+  for (const auto &[segment_no, header] : segments) {
+    if (segment_no <= current_log_segment_ && FirstLogBlock(header) != LogSegmentHeader::NO_BLOCK) {
+      log_head_ = FirstLogBlock(header);
+      break;
+    }
+  }
+
+  log_io_.open(GetLogSegmentName(current_log_segment_), std::ios::binary | std::ios::in | std::ios::out);
+  if (!log_io_.is_open()) {
+    throw Exception("can't open dblog file");
+  }
+  OpenLogSyncHandle();
+}
+
+void DiskManager::CreateLogSegment(uint64_t segment_no) {
+  std::fstream file(GetLogSegmentName(segment_no), std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+  if (!file.is_open()) {
+    throw Exception("can't create log segment");
+  }
+  WriteLogSegmentHeader(file, segment_no, 0);
+
+  // write the payload out instead of seeking past it, so the blocks are really allocated
+  static const char zeros[BUSTUB_PAGE_SIZE] = {};
+  file.seekp(LOG_SEGMENT_HEADER_SIZE);
+  for (uint64_t written = LOG_SEGMENT_HEADER_SIZE; written < log_segment_size_;) {
+    uint64_t chunk = std::min<uint64_t>(BUSTUB_PAGE_SIZE, log_segment_size_ - written);
+    file.write(zeros, chunk);
+    written += chunk;
+  }
+  SyncFile(file);
+  if (file.bad()) {
+    throw Exception("I/O error while preallocating log segment");
+  }
+}
+
+void DiskManager::SwitchLogSegment() {
+  WriteLogSegmentHeader(log_io_, current_log_segment_, current_segment_used_, current_first_block_);
+  SyncFile(log_io_);
+  log_io_.close();
+  CloseLogSyncHandle();
+
+  current_log_segment_++;
+  if (current_log_segment_ > last_log_segment_) {
+    CreateLogSegment(current_log_segment_);
+    last_log_segment_ = current_log_segment_;
+  }
+  log_io_.clear();
+  log_io_.open(GetLogSegmentName(current_log_segment_), std::ios::binary | std::ios::in | std::ios::out);
+  if (!log_io_.is_open()) {
+    throw Exception("can't open dblog file");
+  }
+  OpenLogSyncHandle();
+  current_segment_used_ = 0;
+  current_first_block_ = LogSegmentHeader::NO_BLOCK;
+  WriteLogSegmentHeader(log_io_, current_log_segment_, 0);
+}
+
+void DiskManager::OpenLogSyncHandle() {
+#ifndef _WIN32
+  log_sync_fd_ = ::open(GetLogSegmentName(current_log_segment_).c_str(), O_RDWR);
+#endif
+}
+
+void DiskManager::CloseLogSyncHandle() {
+#ifndef _WIN32
+  if (log_sync_fd_ >= 0) {
+    ::close(log_sync_fd_);
+    log_sync_fd_ = -1;
+  }
+#endif
+}
+
+void DiskManager::WriteLogSegmentHeader(std::fstream &file, uint64_t segment_no, uint64_t used,
+                                        uint64_t first_block_offset) {
+  char buf[LOG_SEGMENT_HEADER_SIZE] = {};
+  LogSegmentHeader header{LogSegmentHeader::MAGIC, static_cast<uint32_t>(log_segment_size_), segment_no,
+                          segment_no * LogSegmentPayloadSize(), used, first_block_offset};
+  memcpy(buf, &header, sizeof(header));
+  file.seekp(0);
+  file.write(buf, LOG_SEGMENT_HEADER_SIZE);
+}
+
+auto DiskManager::ReadLogSegmentHeader(const std::string &file_name, LogSegmentHeader *header) -> bool {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  file.read(reinterpret_cast<char *>(header), sizeof(LogSegmentHeader));
+  if (file.gcount() != sizeof(LogSegmentHeader) || header->magic_ != LogSegmentHeader::MAGIC) {
+    return false;
+  }
+  if (header->segment_size_ != log_segment_size_) {
+    spdlog::warn("Log segment {} was written with segment size {}, expected {}", file_name, header->segment_size_,
+                 log_segment_size_);
+    return false;
+  }
+  return true;
+}
+
+auto DiskManager::GetFirstLogBlock(uint64_t segment_no) -> uint64_t {
+  if (segment_no == current_log_segment_) {
+    return current_first_block_;
+  }
+  LogSegmentHeader header;
+  if (!ReadLogSegmentHeader(GetLogSegmentName(segment_no), &header)) {
+    return LogSegmentHeader::NO_BLOCK;
+  }
+  return FirstLogBlock(header);
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tmp_file.cpp
+//
+// Identification: src/storage/disk/tmp_file.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/storage/disk/tmp_file.h"
+
+#include "../include/common/exception.h"
+#include "fmt/format.h"
+
+namespace hmssql {
+
+TmpFile::~TmpFile() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+auto TmpFile::AllocatePage() -> page_id_t {
+  std::scoped_lock lock(latch_);
+  if (!free_pages_.empty()) {
+    auto page_id = free_pages_.back();
+    free_pages_.pop_back();
+    return page_id;
+  }
+  return next_page_id_++;
+}
+
+void TmpFile::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock lock(latch_);
+  free_pages_.push_back(page_id);
+}
+
+void TmpFile::WritePage(page_id_t page_id, const char *data) {
+  std::scoped_lock lock(latch_);
+  if (file_ == nullptr) {
+    file_ = std::tmpfile();
+    if (file_ == nullptr) {
+      throw Exception("can't create a temporary file for spilled pages");
+    }
+  }
+  if (std::fseek(file_, static_cast<long>(page_id) * BUSTUB_PAGE_SIZE, SEEK_SET) != 0 ||  // NOLINT
+      std::fwrite(data, 1, BUSTUB_PAGE_SIZE, file_) != BUSTUB_PAGE_SIZE) {
+    throw Exception(fmt::format("can't write temporary page {}", page_id));
+  }
+}
+
+void TmpFile::ReadPage(page_id_t page_id, char *data) {
+  std::scoped_lock lock(latch_);
+  if (file_ == nullptr || std::fseek(file_, static_cast<long>(page_id) * BUSTUB_PAGE_SIZE, SEEK_SET) != 0 ||  // NOLINT
+      std::fread(data, 1, BUSTUB_PAGE_SIZE, file_) != BUSTUB_PAGE_SIZE) {
+    throw Exception(fmt::format("can't read temporary page {}", page_id));
+  }
+}
+
+auto TmpFile::GetNumPages() -> size_t {
+  std::scoped_lock lock(latch_);
+  return static_cast<size_t>(next_page_id_);
+}
+
+}  // namespace hmssql
@@ -13,16 +13,38 @@
 
 #include <cassert>
 
+#include "../include/concurrency/transaction.h"
+
 namespace hmssql {
 
+namespace {
+
+auto TxnIdOf(Transaction *txn) -> txn_id_t { return txn == nullptr ? INVALID_TXN_ID : txn->GetTransactionId(); }
+
+auto PrevLSNOf(Transaction *txn) -> lsn_t { return txn == nullptr ? INVALID_LSN : txn->GetPrevLSN(); }
+
+}  // namespace
+
+void TablePage::AppendLogRecord(LogManager *log_manager, Transaction *txn, LogRecord *log_record) {
+  if (txn == nullptr) {
+    SetLSN(log_manager->AppendLogRecord(log_record));
+    return;
+  }
+  // An online backup that starts from here on archives the record, one that started earlier waits for txn
+  txn->SetLogged();
+  lsn_t lsn = log_manager->AppendLogRecord(log_record);
+  txn->SetPrevLSN(lsn);
+  SetLSN(lsn);
+}
+
 void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager) {
   // Set the page ID.
   memcpy(GetData(), &page_id, sizeof(page_id));
   
-  // Log that we are creating a new page - simplified without transactions
+  // Log that we are creating a new page.
   if (enable_logging && log_manager != nullptr) {
-    // Simplified logging
-    SetLSN(INVALID_LSN);  // Or some appropriate value
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::NEWPAGE, prev_page_id, page_id);
+    SetLSN(log_manager->AppendLogRecord(&log_record));
   }
   
   // Set the previous and next page IDs.
@@ -32,10 +54,11 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
   SetTupleCount(0);
 }
 
-auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manager) -> bool {
+auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manager, uint32_t reserved,
+                            Transaction *txn) -> bool {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
   // If there is not enough space, then return false.
-  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE + reserved) {
     return false;
   }
 
@@ -50,7 +73,7 @@ auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manage
   }
 
   // If there was no free slot left, and we cannot claim it from the free space, then we give up.
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE + reserved) {
     return false;
   }
 
@@ -67,15 +90,15 @@ auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, LogManager *log_manage
     SetTupleCount(GetTupleCount() + 1);
   }
 
-  // Simplified logging without transactions
   if (enable_logging && log_manager != nullptr) {
-    // Simplified logging code here if needed
+    LogRecord log_record(TxnIdOf(txn), PrevLSNOf(txn), LogRecordType::INSERT, *rid, tuple);
+    AppendLogRecord(log_manager, txn, &log_record);
   }
-  
+
   return true;
 }
 
-auto TablePage::MarkDelete(const RID &rid) -> bool {
+auto TablePage::MarkDelete(const RID &rid, LogManager *log_manager, Transaction *txn) -> bool {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, return false
   if (slot_num >= GetTupleCount()) {
@@ -87,12 +110,20 @@ auto TablePage::MarkDelete(const RID &rid) -> bool {
     return false;
   }
   
+  if (enable_logging && log_manager != nullptr) {
+    Tuple dummy_tuple;
+    LogRecord log_record(TxnIdOf(txn), PrevLSNOf(txn), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    AppendLogRecord(log_manager, txn, &log_record);
+  }
+
   // Just mark the tuple as deleted
   SetTupleSize(slot_num, SetDeletedFlag(tuple_size));
   return true;
 }
 
-auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid) -> bool {
+auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, LogManager *log_manager,
+                            const Schema *schema, uint32_t reserved, Transaction *txn) -> bool {
+  BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
   // Find the slot containing the tuple.
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, return false.
@@ -106,20 +137,46 @@ auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   if (IsDeleted(tuple_size)) {
     return false;
   }
-  
-  // Copy the old value.
-  old_tuple->size_ = tuple_size;
-  old_tuple->allocated_ = true;
+  // If there is not enough space to update, the update fails. Rows are not moved to another page.
+  if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_ + reserved) {
+    return false;
+  }
+
+  // Copy out the old value.
+  old_tuple->CopyData(GetData() + tuple_offset, tuple_size);
   old_tuple->rid_ = rid;
-  memcpy(old_tuple->data_, GetData() + tuple_offset, tuple_size);
-  
-  // Update the tuple.
-  memcpy(GetData() + tuple_offset, new_tuple.data_, new_tuple.size_);
+
+  if (enable_logging && log_manager != nullptr) {
+    if (schema != nullptr) {
+      LogRecord log_record(TxnIdOf(txn), PrevLSNOf(txn), rid, *old_tuple, new_tuple, *schema);
+      AppendLogRecord(log_manager, txn, &log_record);
+    } else {
+      LogRecord log_record(TxnIdOf(txn), PrevLSNOf(txn), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+      AppendLogRecord(log_manager, txn, &log_record);
+    }
+  }
+
+  // Perform the update, shifting the tuples stored below this one when the size changes.
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
+
+  memmove(GetData() + free_space_pointer + tuple_size - new_tuple.size_, GetData() + free_space_pointer,
+          tuple_offset - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer + tuple_size - new_tuple.size_);
+  memcpy(GetData() + tuple_offset + tuple_size - new_tuple.size_, new_tuple.data_, new_tuple.size_);
   SetTupleSize(slot_num, new_tuple.size_);
+
+  // Update all tuple offsets.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
+    if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_tuple.size_);
+    }
+  }
   return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid) {
+void TablePage::ApplyDelete(const RID &rid, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -133,13 +190,13 @@ void TablePage::ApplyDelete(const RID &rid) {
 
   // We need to copy out the deleted tuple for undo purposes.
   Tuple delete_tuple;
-  delete_tuple.size_ = tuple_size;
-  delete_tuple.data_ = new char[delete_tuple.size_];
-  memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
+  delete_tuple.CopyData(GetData() + tuple_offset, tuple_size);
   delete_tuple.rid_ = rid;
-  delete_tuple.allocated_ = true;
 
-  // No transaction logging here anymore
+  if (enable_logging && log_manager != nullptr) {
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::APPLYDELETE, rid, delete_tuple);
+    SetLSN(log_manager->AppendLogRecord(&log_record));
+  }
 
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
@@ -159,7 +216,24 @@ void TablePage::ApplyDelete(const RID &rid) {
   }
 }
 
-auto TablePage::GetTuple(const RID &rid, Tuple *tuple) -> bool {
+void TablePage::RollbackDelete(const RID &rid, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+
+  if (enable_logging && log_manager != nullptr) {
+    Tuple dummy_tuple;
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
+    SetLSN(log_manager->AppendLogRecord(&log_record));
+  }
+
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  // Unset the deleted flag.
+  if (IsDeleted(tuple_size)) {
+    SetTupleSize(slot_num, UnsetDeletedFlag(tuple_size));
+  }
+}
+
+auto TablePage::GetTuple(const RID &rid, Tuple *tuple, bool *is_deleted) -> bool {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, return false
@@ -169,8 +243,11 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple) -> bool {
   
   // Otherwise get the current tuple size too.
   uint32_t tuple_size = GetTupleSize(slot_num);
-  // If the tuple is deleted, return false
-  if (IsDeleted(tuple_size)) {
+  // If the tuple is deleted, return false unless the caller asked for marked ones too. A freed slot has no tuple.
+  if (is_deleted != nullptr && tuple_size != 0) {
+    *is_deleted = IsDeleted(tuple_size);
+    tuple_size = UnsetDeletedFlag(tuple_size);
+  } else if (IsDeleted(tuple_size)) {
     return false;
   }
 
@@ -178,21 +255,29 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple) -> bool {
   
   // Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
+  tuple->CopyData(GetData() + tuple_offset, tuple_size);
+  tuple->rid_ = rid;
+  return true;
+}
+
+auto TablePage::GetTupleView(const RID &rid, Tuple *tuple) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (IsDeleted(tuple_size)) {
+    return false;
   }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
+  tuple->SetView(GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size);
   tuple->rid_ = rid;
-  tuple->allocated_ = true;
   return true;
 }
 
-auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
+auto TablePage::GetFirstTupleRid(RID *first_rid, bool include_deleted) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (include_deleted ? GetTupleSize(i) != 0 : !IsDeleted(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -201,11 +286,11 @@ auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   return false;
 }
 
-auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
+auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted) -> bool {
   BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (include_deleted ? GetTupleSize(i) != 0 : !IsDeleted(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
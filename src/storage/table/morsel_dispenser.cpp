@@ -0,0 +1,32 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// morsel_dispenser.cpp
+//
+// Identification: src/storage/table/morsel_dispenser.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/storage/table/morsel_dispenser.h"
+
+#include "../include/storage/table/table_heap.h"
+
+namespace hmssql {
+
+MorselDispenser::MorselDispenser(TableHeap *table_heap, uint32_t pages_per_morsel)
+    : table_heap_(table_heap), pages_per_morsel_(pages_per_morsel), next_page_id_(table_heap->GetFirstPageId()) {}
+
+auto MorselDispenser::Claim(std::vector<page_id_t> *page_ids) -> bool {
+  page_ids->clear();
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Only the next page pointers are read here, the worker reads the tuples after the latch is released
+  while (page_ids->size() < pages_per_morsel_ && next_page_id_ != INVALID_PAGE_ID) {
+    page_ids->push_back(next_page_id_);
+    next_page_id_ = table_heap_->GetNextPageId(next_page_id_);
+  }
+  return !page_ids->empty();
+}
+
+}  // namespace hmssql
@@ -10,8 +10,11 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <cstring>
 
 #include "fmt/format.h"
+#include "../include/common/exception.h"
+#include "../include/concurrency/transaction_manager.h"
 #include "../include/storage/table/table_heap.h"
 
 namespace hmssql {
@@ -32,7 +35,7 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LogManager *log_man
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
-auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid) -> bool {
+auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
   if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
     return false;
   }
@@ -46,7 +49,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid) -> bool {
 
   // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
   // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, log_manager_)) {
+  while (!cur_page->InsertTuple(tuple, rid, log_manager_, GetReservedBytes(cur_page->GetTablePageId()), txn)) {
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
@@ -75,6 +78,10 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid) -> bool {
       cur_page = new_page;
     }
   }
+  // Register the new row before anybody can read the page, other snapshots must skip it.
+  if (txn != nullptr) {
+    txn->GetTransactionManager()->InsertVersion(txn, this, *rid);
+  }
   // This line has caused most of us to double-take and "whoa double unlatch".
   // We are not, in fact, double unlatching. See the invariant above.
   cur_page->WUnlatch();
@@ -82,32 +89,74 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid) -> bool {
   return true;
 }
 
-auto TableHeap::MarkDelete(const RID &rid) -> bool {
+auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
     return false;
   }
-  
-  // Mark the tuple as deleted
+
+  // Mark the tuple as deleted, older snapshots keep reading the image saved in its version chain. A slot another
+  // transaction marked deleted is still checked against our snapshot, so that a concurrent delete taints us.
   page->WLatch();
-  bool is_deleted = page->MarkDelete(rid);
+  bool is_deleted = false;
+  Tuple old_tuple;
+  bool slot_deleted = false;
+  if (txn == nullptr || (page->GetTuple(rid, &old_tuple, &slot_deleted) &&
+                         txn->GetTransactionManager()->WriteVersion(txn, this, rid, old_tuple, true, slot_deleted))) {
+    is_deleted = page->MarkDelete(rid, log_manager_, txn);
+  }
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_deleted);
   return is_deleted;
 }
 
-auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid) -> bool {
+auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, const Schema *schema, Transaction *txn) -> bool {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     return false;
   }
-  // Update the tuple; but first save the old value for rollbacks.
+  // Update the tuple; but first save the old value for rollbacks. As in MarkDelete a deleted slot is checked too.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid);
+  bool is_updated = false;
+  bool slot_deleted = false;
+  if (txn == nullptr) {
+    is_updated = page->UpdateTuple(tuple, &old_tuple, rid, log_manager_, schema, GetReservedBytes(rid.GetPageId()));
+  } else if (page->GetTuple(rid, &old_tuple, &slot_deleted) &&
+             txn->GetTransactionManager()->WriteVersion(txn, this, rid, old_tuple, false, slot_deleted)) {
+    // Size changes are tracked from the first one, until then the tuple on the page has its original size
+    uint32_t original_size = old_tuple.GetLength();
+    uint32_t held = 0;
+    uint32_t page_reserved = 0;
+    bool tracked = false;
+    {
+      std::scoped_lock<std::mutex> lock(reservation_latch_);
+      auto it = tuple_reservations_.find(rid);
+      if (it != tuple_reservations_.end()) {
+        tracked = true;
+        original_size = it->second.original_size_;
+        held = it->second.reserved_;
+      }
+      auto page_it = page_reservations_.find(rid.GetPageId());
+      page_reserved = page_it == page_reservations_.end() ? 0 : page_it->second;
+    }
+    // A rollback restores the original image, a shrinking update keeps the bytes it needs for that free
+    uint32_t reserved = original_size > tuple.GetLength() ? original_size - tuple.GetLength() : 0;
+    is_updated =
+        page->UpdateTuple(tuple, &old_tuple, rid, log_manager_, schema, page_reserved - held + reserved, txn);
+    if (is_updated && (tracked || tuple.GetLength() != original_size)) {
+      std::scoped_lock<std::mutex> lock(reservation_latch_);
+      tuple_reservations_[rid] = Reservation{original_size, reserved};
+      auto &bytes = page_reservations_[rid.GetPageId()];
+      bytes = bytes - held + reserved;
+      if (bytes == 0) {
+        page_reservations_.erase(rid.GetPageId());
+      }
+    }
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   return is_updated;
@@ -119,7 +168,7 @@ void TableHeap::ApplyDelete(const RID &rid) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
   page->WLatch();
-  page->ApplyDelete(rid);
+  page->ApplyDelete(rid, log_manager_);
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
@@ -133,11 +182,82 @@ void TableHeap::RollbackDelete(const RID &rid) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
+  page->RollbackDelete(rid, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
-auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, bool acquire_read_lock) -> bool {
+void TableHeap::RollbackWrite(const RID &rid, Transaction *txn) {
+  // Find the page which contains the tuple.
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  page->WLatch();
+  UndoVersion undo{};
+  bool page_deleted = false;
+  bool restored = true;
+  // The rollback is logged apart from the records of txn. Recovery takes a later record of the row for the rollback
+  // done already.
+  if (txn->GetTransactionManager()->RollbackVersion(txn, rid, &undo, &page_deleted)) {
+    if (undo.is_deleted_) {
+      // The tuple was inserted by txn.
+      page->ApplyDelete(rid, log_manager_);
+    } else {
+      if (page_deleted) {
+        page->RollbackDelete(rid, log_manager_);
+      }
+      // txn may have updated the tuple before deleting it, so restore the image unless it is still there. The bytes
+      // reserved for it are what the image needs on top of the current one.
+      Tuple current;
+      if (page->GetTuple(rid, &current) &&
+          (current.GetLength() != undo.tuple_.GetLength() ||
+           memcmp(current.GetData(), undo.tuple_.GetData(), current.GetLength()) != 0)) {
+        uint32_t held = 0;
+        {
+          std::scoped_lock<std::mutex> lock(reservation_latch_);
+          auto it = tuple_reservations_.find(rid);
+          held = it == tuple_reservations_.end() ? 0 : it->second.reserved_;
+        }
+        restored = page->UpdateTuple(undo.tuple_, &current, rid, log_manager_, nullptr,
+                                     GetReservedBytes(rid.GetPageId()) - held);
+      }
+    }
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  ReleaseReservation(rid);
+  // Only a bug loses the reserved space, a rollback that silently leaves the new image would be far worse
+  BUSTUB_ENSURE(restored, fmt::format("Rollback can't restore tuple {}, its page is full", rid.ToString()));
+}
+
+void TableHeap::ReleaseReservation(const RID &rid) {
+  std::scoped_lock<std::mutex> lock(reservation_latch_);
+  if (tuple_reservations_.empty()) {
+    return;
+  }
+  auto it = tuple_reservations_.find(rid);
+  if (it == tuple_reservations_.end()) {
+    return;
+  }
+  auto page_it = page_reservations_.find(rid.GetPageId());
+  if (page_it != page_reservations_.end()) {
+    page_it->second -= it->second.reserved_;
+    if (page_it->second == 0) {
+      page_reservations_.erase(page_it);
+    }
+  }
+  tuple_reservations_.erase(it);
+}
+
+auto TableHeap::GetReservedBytes(page_id_t page_id) -> uint32_t {
+  std::scoped_lock<std::mutex> lock(reservation_latch_);
+  if (page_reservations_.empty()) {
+    return 0;
+  }
+  auto it = page_reservations_.find(page_id);
+  return it == page_reservations_.end() ? 0 : it->second;
+}
+
+auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -145,18 +265,22 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, bool acquire_read_lock) -
     return false;
   }
   // Read the tuple from the page.
-  if (acquire_read_lock) {
-    page->RLatch();
-  }
-  bool res = page->GetTuple(rid, tuple);
-  if (acquire_read_lock) {
-    page->RUnlatch();
-  }
+  page->RLatch();
+  bool res = ReadTuple(page, rid, tuple, txn);
+  page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
 }
 
-auto TableHeap::Begin() -> TableIterator {
+auto TableHeap::ReadTuple(TablePage *page, const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
+  bool exists = page->GetTuple(rid, tuple);
+  if (txn == nullptr) {
+    return exists;
+  }
+  return txn->GetTransactionManager()->ReadVersion(txn, rid, !exists, tuple);
+}
+
+auto TableHeap::Begin(Transaction *txn) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
@@ -165,7 +289,7 @@ auto TableHeap::Begin() -> TableIterator {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = page->GetFirstTupleRid(&rid, txn != nullptr);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -173,9 +297,57 @@ auto TableHeap::Begin() -> TableIterator {
     }
     page_id = page->GetNextPageId();
   }
-  return {this, rid};
+  return {this, rid, txn};
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0)}; }
 
+void TableHeap::ScanPage(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn,
+                         const std::function<bool(const Tuple &)> &keep) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ENSURE(page != nullptr, "BPM full");
+  page->RLatch();
+  // A snapshot may still see tuples that were deleted after it began, as in TableIterator
+  bool include_deleted = txn != nullptr;
+  // Without a version chain on the page every row is read as stored, unless an optimistic txn remembers its reads
+  bool read_versions = txn != nullptr && (txn->IsOptimistic() || txn->GetTransactionManager()->HasVersions(page_id));
+  RID rid;
+  bool found = page->GetFirstTupleRid(&rid, include_deleted);
+  while (found) {
+    // The version is looked at in place and only copied out once it is kept
+    Tuple tuple;
+    bool exists = page->GetTupleView(rid, &tuple);
+    bool visible = read_versions ? txn->GetTransactionManager()->ReadVersion(txn, rid, !exists, &tuple) : exists;
+    if (visible) {
+      if (!keep || keep(tuple)) {
+        // An older version is a copy already, the page version is copied now
+        if (tuple.IsAllocated()) {
+          tuples->push_back(tuple);
+        } else {
+          page->GetTuple(rid, &tuples->emplace_back());
+        }
+      }
+    } else if (txn == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      throw hmssql::Exception("read non-existing tuple");
+    }
+    RID next_rid;
+    found = page->GetNextTupleRid(rid, &next_rid, include_deleted);
+    rid = next_rid;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
+auto TableHeap::GetNextPageId(page_id_t page_id) -> page_id_t {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ENSURE(page != nullptr, "BPM full");
+  page->RLatch();
+  auto next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return next_page_id;
+}
+
 }  // namespace hmssql
@@ -16,55 +16,68 @@
 
 namespace hmssql {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
+    : table_heap_(table_heap), tuple_(rid), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_)) {
-      throw hmssql::Exception("read non-existing tuple");
+    if (!table_heap_->GetTuple(tuple_.rid_, &tuple_, txn_)) {
+      if (txn_ == nullptr) {
+        throw hmssql::Exception("read non-existing tuple");
+      }
+      // Not in the snapshot, start from the next tuple that is
+      ++(*this);
     }
   }
 }
 
 auto TableIterator::operator*() -> const Tuple & {
   assert(*this != table_heap_->End());
-  return *tuple_;
+  return tuple_;
 }
 
 auto TableIterator::operator->() -> Tuple * {
   assert(*this != table_heap_->End());
-  return tuple_;
+  return &tuple_;
 }
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_.rid_.GetPageId()));
   BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
 
   cur_page->RLatch();
-  RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
-        break;
+  // A snapshot may still see tuples that were deleted after it began, so those are visited too
+  bool include_deleted = txn_ != nullptr;
+  RID cur_tuple_rid = tuple_.rid_;
+  while (true) {
+    RID next_tuple_rid;
+    if (!cur_page->GetNextTupleRid(cur_tuple_rid, &next_tuple_rid, include_deleted)) {  // end of this page
+      while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+        auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+        cur_page->RUnlatch();
+        buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+        cur_page = next_page;
+        cur_page->RLatch();
+        if (cur_page->GetFirstTupleRid(&next_tuple_rid, include_deleted)) {
+          break;
+        }
       }
     }
-  }
-  tuple_->rid_ = next_tuple_rid;
-
-  if (*this != table_heap_->End()) {
+    tuple_.rid_ = next_tuple_rid;
+    if (*this == table_heap_->End()) {
+      break;
+    }
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
-    if (!table_heap_->GetTuple(tuple_->rid_, tuple_, false)) {
+    if (table_heap_->ReadTuple(cur_page, tuple_.rid_, &tuple_, txn_)) {
+      break;
+    }
+    if (txn_ == nullptr) {
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       throw hmssql::Exception("read non-existing tuple");
     }
+    // Not in the snapshot, move on
+    cur_tuple_rid = tuple_.rid_;
   }
   // release until copy the tuple
   cur_page->RUnlatch();
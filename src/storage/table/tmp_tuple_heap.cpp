@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// tmp_tuple_heap.cpp
+//
+// Identification: src/storage/table/tmp_tuple_heap.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/storage/table/tmp_tuple_heap.h"
+
+#include "../include/common/exception.h"
+
+namespace hmssql {
+
+TmpTupleHeap::TmpTupleHeap(TmpFile *file) : file_(file) {
+  write_page_.Init(INVALID_PAGE_ID, BUSTUB_PAGE_SIZE);
+}
+
+TmpTupleHeap::~TmpTupleHeap() {
+  for (size_t i = read_pages_; i < page_ids_.size(); i++) {
+    file_->DeallocatePage(page_ids_[i]);
+  }
+}
+
+void TmpTupleHeap::Append(const Tuple &tuple) {
+  BUSTUB_ASSERT(read_page_ == nullptr && !write_page_read_, "tmp tuple heaps are written before they are read");
+  TmpTuple location(INVALID_PAGE_ID, 0);
+  if (!write_page_.Insert(tuple, &location)) {
+    FlushWritePage();
+    if (!write_page_.Insert(tuple, &location)) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "tuple does not fit in a temporary page");
+    }
+  }
+  tuple_count_++;
+}
+
+void TmpTupleHeap::FlushWritePage() {
+  auto page_id = file_->AllocatePage();
+  write_page_.SetTablePageId(page_id);
+  file_->WritePage(page_id, write_page_.GetData());
+  page_ids_.push_back(page_id);
+  write_page_.Init(INVALID_PAGE_ID, BUSTUB_PAGE_SIZE);
+}
+
+auto TmpTupleHeap::Next(Tuple *tuple) -> bool {
+  while (true) {
+    if (read_page_ != nullptr && !read_offsets_.empty()) {
+      read_page_->Get(read_offsets_.back(), tuple);
+      read_offsets_.pop_back();
+      return true;
+    }
+    // The page was read to its end, on to the next one
+    read_page_ = nullptr;
+    if (read_pages_ < page_ids_.size()) {
+      // In memory the page is free for the next one written
+      file_->ReadPage(page_ids_[read_pages_], file_page_.GetData());
+      file_->DeallocatePage(page_ids_[read_pages_]);
+      read_pages_++;
+      read_page_ = &file_page_;
+    } else if (!write_page_read_) {
+      write_page_read_ = true;
+      read_page_ = &write_page_;
+    } else {
+      return false;
+    }
+    // The page holds its tuples last one first, they are handed out the other way round
+    for (size_t offset = read_page_->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE;
+         offset = read_page_->NextOffset(offset)) {
+      read_offsets_.push_back(offset);
+    }
+  }
+}
+
+}  // namespace hmssql
@@ -13,6 +13,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "../include/storage/table/tuple.h"
@@ -20,7 +21,7 @@
 namespace hmssql {
 
 // TODO(Amadou): It does not look like nulls are supported. Add a null bitmap?
-Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true) {
+Tuple::Tuple(const std::vector<Value> &values, const Schema *schema) {
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
@@ -34,9 +35,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   }
 
   // 2. Allocate memory.
-  size_ = tuple_size;
-  data_ = new char[size_];
-  std::memset(data_, 0, size_);
+  std::memset(Allocate(tuple_size), 0, size_);
 
   // 3. Serialize each attribute based on the input value.
   uint32_t column_count = schema->GetColumnCount();
@@ -60,40 +59,68 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   }
 }
 
-Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
-  if (allocated_) {
-    delete[] data_;
-  }
-  if (allocated_) {
-    // Deep copy.
-    data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+Tuple::Tuple(const Tuple &other) : rid_(other.rid_) {
+  if (other.allocated_) {
+    CopyData(other.data_, other.size_);
   } else {
-    // Shallow copy.
-    data_ = other.data_;
+    SetView(other.data_, other.size_);
   }
 }
 
+Tuple::Tuple(Tuple &&other) noexcept { *this = std::move(other); }
+
 auto Tuple::operator=(const Tuple &other) -> Tuple & {
-  if (allocated_) {
-    delete[] data_;
+  if (this == &other) {
+    return *this;
   }
-  allocated_ = other.allocated_;
   rid_ = other.rid_;
-  size_ = other.size_;
+  if (other.allocated_) {
+    CopyData(other.data_, other.size_);
+  } else {
+    SetView(other.data_, other.size_);
+  }
+  return *this;
+}
 
-  if (allocated_) {
-    // Deep copy.
-    data_ = new char[size_];
-    memcpy(data_, other.data_, size_);
+auto Tuple::operator=(Tuple &&other) noexcept -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
+  rid_ = other.rid_;
+  allocated_ = other.allocated_;
+  size_ = other.size_;
+  delete[] heap_;
+  heap_ = std::exchange(other.heap_, nullptr);
+  capacity_ = std::exchange(other.capacity_, 0);
+  // Inline data moves along, a heap buffer or a page is handed over
+  if (other.data_ == other.inline_) {
+    memcpy(inline_, other.inline_, size_);
+    data_ = inline_;
   } else {
-    // Shallow copy.
     data_ = other.data_;
   }
-
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
   return *this;
 }
 
+auto Tuple::Allocate(uint32_t size) -> char * {
+  if (size <= TUPLE_INLINE_SIZE) {
+    data_ = inline_;
+  } else {
+    if (capacity_ < size) {
+      delete[] heap_;
+      heap_ = new char[size];
+      capacity_ = size;
+    }
+    data_ = heap_;
+  }
+  allocated_ = true;
+  size_ = size;
+  return data_;
+}
+
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
   assert(data_);
@@ -161,13 +188,7 @@ void Tuple::SerializeTo(char *storage) const {
 void Tuple::DeserializeFrom(const char *storage) {
   uint32_t size = *reinterpret_cast<const uint32_t *>(storage);
   // Construct a tuple.
-  this->size_ = size;
-  if (this->allocated_) {
-    delete[] this->data_;
-  }
-  this->data_ = new char[this->size_];
-  memcpy(this->data_, storage + sizeof(int32_t), this->size_);
-  this->allocated_ = true;
+  CopyData(storage + sizeof(int32_t), size);
 }
 
 }  // namespace hmssql
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// arena_pool.cpp
+//
+// Identification: src/type/arena_pool.cpp
+//
+//
+//===----------------------------------------------------------------------===//
+
+#include "../include/type/arena_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace hmssql {
+
+ArenaPool::ArenaPool(ArenaPool &&other) noexcept { *this = std::move(other); }
+
+auto ArenaPool::operator=(ArenaPool &&other) noexcept -> ArenaPool & {
+  if (this != &other) {
+    current_ = std::move(other.current_);
+    current_size_ = std::exchange(other.current_size_, 0);
+    retired_ = std::move(other.retired_);
+    other.retired_.clear();
+    next_ = std::exchange(other.next_, nullptr);
+    end_ = std::exchange(other.end_, nullptr);
+    memory_usage_ = std::exchange(other.memory_usage_, 0);
+  }
+  return *this;
+}
+
+void ArenaPool::Reset() {
+  retired_.clear();
+  next_ = current_.get();
+  end_ = next_ + current_size_;
+  memory_usage_ = current_size_;
+}
+
+auto ArenaPool::AllocateChunk(size_t size) -> void * {
+  if (size > ARENA_CHUNK_SIZE / 4) {
+    // The chunk being filled goes on being filled after it
+    retired_.emplace_back(new char[size]);
+    memory_usage_ += size;
+    return retired_.back().get();
+  }
+  auto chunk_size = std::min(std::max(current_size_ * 2, MIN_CHUNK_SIZE), ARENA_CHUNK_SIZE);
+  while (chunk_size < size) {
+    chunk_size *= 2;
+  }
+  if (current_ != nullptr) {
+    retired_.push_back(std::move(current_));
+  }
+  current_.reset(new char[chunk_size]);
+  current_size_ = chunk_size;
+  memory_usage_ += chunk_size;
+  next_ = current_.get() + size;
+  end_ = current_.get() + chunk_size;
+  return current_.get();
+}
+
+}  // namespace hmssql
@@ -12,9 +12,9 @@
 #include <cassert>
 #include <string>
 #include <utility>
-#include <regex>
 
 #include "../include/common/exception.h"
+#include "../include/common/util/like_matcher.h"
 #include "../include/type/value.h"
 
 namespace hmssql {
@@ -41,6 +41,13 @@ Value::Value(const Value &other) {
   }
 }
 
+Value::Value(Value &&other) noexcept
+    : value_(other.value_), size_(other.size_), manage_data_(other.manage_data_), type_id_(other.type_id_) {
+  other.manage_data_ = false;
+  other.value_.varlen_ = nullptr;
+  other.size_.len_ = BUSTUB_VALUE_NULL;
+}
+
 auto Value::ToString() const -> std::string {
   switch (type_id_) {
     case TypeId::BOOLEAN:
@@ -339,10 +346,7 @@ auto Value::Like(const Value &other) const -> CmpBool {
   if (type_id_ != TypeId::VARCHAR || other.type_id_ != TypeId::VARCHAR) {
     throw Exception("LIKE can only be applied to VARCHAR types");
   }
-  std::string pattern = other.value_.varlen_;
-  pattern = std::regex_replace(pattern, std::regex("%"), ".*");
-  pattern = std::regex_replace(pattern, std::regex("_"), ".");
-  std::regex regex_pattern(pattern);
-  return std::regex_match(value_.varlen_, regex_pattern) ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  LikeMatcher matcher(std::string(other.GetData(), other.GetLength() - 1));
+  return GetCmpBool(matcher.Match(GetData(), GetLength() - 1));
 }
 }  // namespace hmssql
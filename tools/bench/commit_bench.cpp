@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// commit_bench.cpp
+//
+// Identification: tools/bench/commit_bench.cpp
+//
+// Measures statement latency and throughput of single-row INSERTs with
+// synchronous and asynchronous commit (SET synchronous_commit = on / off).
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/hmssql_instance.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager.h"
+
+namespace {
+
+class NullWriter : public hmssql::ResultWriter {
+ public:
+  void WriteCell(const std::string &cell) override {}
+  void WriteHeaderCell(const std::string &cell) override {}
+  void BeginHeader() override {}
+  void EndHeader() override {}
+  void BeginRow() override {}
+  void EndRow() override {}
+  void BeginTable(bool simplified_output) override {}
+  void EndTable() override {}
+};
+
+void RemoveDatabaseFiles(const std::string &db_file) {
+  auto base = std::filesystem::path(db_file).stem().string();
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    if (entry.path().filename().string().rfind(base + ".", 0) == 0) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+void RunMode(bool synchronous, int statements) {
+  const std::string db_file = "commit_bench.db";
+  RemoveDatabaseFiles(db_file);
+
+  auto db = std::make_unique<hmssql::HMSSQL>(db_file);
+  NullWriter writer;
+  db->ExecuteSql("CREATE TABLE bench (id INTEGER, payload VARCHAR(64));", writer);
+  db->ExecuteSql(fmt::format("SET synchronous_commit = {};", synchronous ? "on" : "off"), writer);
+
+  int flushes_before = db->disk_manager_->GetNumFlushes();
+  std::vector<double> latencies;
+  latencies.reserve(statements);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < statements; i++) {
+    auto sql = fmt::format("INSERT INTO bench VALUES ({}, 'payload-{}');", i, i);
+    auto begin = std::chrono::steady_clock::now();
+    db->ExecuteSql(sql, writer);
+    auto end = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+  }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  int flushes = db->disk_manager_->GetNumFlushes() - flushes_before;
+
+  std::sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (auto latency : latencies) {
+    total += latency;
+  }
+  std::cout << fmt::format("{:<6} {:>10} {:>12.1f} {:>10.1f} {:>10.1f} {:>12.0f} {:>10}", synchronous ? "sync" : "async",
+                           statements, total / statements, latencies[statements / 2],
+                           latencies[std::min(statements - 1, statements * 99 / 100)], statements / elapsed, flushes)
+            << std::endl;
+
+  db.reset();
+  RemoveDatabaseFiles(db_file);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  int statements = 10000;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--statements") == 0 && i + 1 < argc) {
+      statements = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--log-timeout-ms") == 0 && i + 1 < argc) {
+      hmssql::Config::GetInstance().SetDuration(hmssql::Config::LOG_TIMEOUT_MS, std::max(1, std::stoi(argv[++i])));
+    }
+  }
+
+  hmssql::SetEnableLogging(true);
+
+  std::cout << fmt::format("single-row INSERT, log flush interval {} ms", hmssql::log_timeout.count()) << std::endl;
+  std::cout << fmt::format("{:<6} {:>10} {:>12} {:>10} {:>10} {:>12} {:>10}", "mode", "statements", "avg (us)",
+                           "p50 (us)", "p99 (us)", "stmts/s", "flushes")
+            << std::endl;
+  RunMode(true, statements);
+  RunMode(false, statements);
+  return 0;
+}
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// hash_join_bench.cpp
+//
+// Identification: tools/bench/hash_join_bench.cpp
+//
+// Hash join of the one million row mock tables __mock_t4_1m and __mock_t5_1m
+// on their first column. The serial join builds one hash table of the right
+// side. In parallel (SET max_parallel_workers = n) both sides are
+// repartitioned between the workers, each building a table of its own, or
+// radix-partitioned into partitions whose tables fit the cache.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/mock_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/gather_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/repartition_plan.h"
+#include "execution/thread_pool.h"
+#include "fmt/format.h"
+
+namespace {
+
+struct Options {
+  int max_workers_{static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+  int runs_{3};
+};
+
+struct Timing {
+  double build_seconds_{0};
+  double probe_seconds_{0};
+  uint64_t rows_{0};
+};
+
+/**
+ * @return the best build and probe times of the runs and the number of joined rows. The build of parallel joins
+ * happens in their workers and counts as probe time.
+ */
+auto RunJoin(hmssql::ExecutorContext *exec_ctx, const hmssql::AbstractPlanNodeRef &plan, const Options &options)
+    -> Timing {
+  Timing best;
+  for (int run = 0; run < options.runs_; run++) {
+    auto executor = hmssql::ExecutorFactory::CreateExecutor(exec_ctx, plan);
+    auto start = std::chrono::steady_clock::now();
+    executor->Init();
+    auto built = std::chrono::steady_clock::now();
+    hmssql::TupleBatch batch;
+    uint64_t rows = 0;
+    while (executor->NextBatch(&batch)) {
+      rows += batch.Size();
+    }
+    auto done = std::chrono::steady_clock::now();
+    auto build_seconds = std::chrono::duration<double>(built - start).count();
+    auto probe_seconds = std::chrono::duration<double>(done - built).count();
+    if (run == 0 || build_seconds + probe_seconds < best.build_seconds_ + best.probe_seconds_) {
+      best = Timing{build_seconds, probe_seconds, rows};
+    }
+  }
+  return best;
+}
+
+void PrintTiming(const std::string &join, size_t workers, const Timing &timing, double serial_seconds) {
+  auto total = timing.build_seconds_ + timing.probe_seconds_;
+  std::cout << fmt::format("{:>12} {:>8} {:>10} {:>10.1f} {:>10.1f} {:>10.1f} {:>14.0f} {:>7.2f}x", join, workers,
+                           timing.rows_, timing.build_seconds_ * 1000, timing.probe_seconds_ * 1000, total * 1000,
+                           2000000 / total, serial_seconds / total)
+            << std::endl;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+      options.max_workers_ = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      options.runs_ = std::max(1, std::stoi(argv[++i]));
+    }
+  }
+
+  // Mock scans need neither a catalog nor a buffer pool
+  hmssql::ThreadPool thread_pool;
+  hmssql::ExecutorContext exec_ctx(nullptr, nullptr, nullptr, nullptr, &thread_pool);
+
+  auto left_schema = std::make_shared<const hmssql::Schema>(hmssql::GetMockTableSchemaOf("__mock_t4_1m"));
+  auto right_schema = std::make_shared<const hmssql::Schema>(hmssql::GetMockTableSchemaOf("__mock_t5_1m"));
+  std::vector<hmssql::Column> columns = left_schema->GetColumns();
+  for (const auto &column : right_schema->GetColumns()) {
+    columns.push_back(column);
+  }
+  auto output = std::make_shared<const hmssql::Schema>(columns);
+  auto left_key = std::vector<hmssql::AbstractExpressionRef>{
+      std::make_shared<hmssql::ColumnValueExpression>(0, 0, hmssql::TypeId::INTEGER)};
+  auto right_key = std::vector<hmssql::AbstractExpressionRef>{
+      std::make_shared<hmssql::ColumnValueExpression>(0, 0, hmssql::TypeId::INTEGER)};
+  hmssql::AbstractPlanNodeRef left = std::make_shared<hmssql::MockScanPlanNode>(left_schema, "__mock_t4_1m");
+  hmssql::AbstractPlanNodeRef right = std::make_shared<hmssql::MockScanPlanNode>(right_schema, "__mock_t5_1m");
+
+  std::cout << fmt::format("__mock_t4_1m JOIN __mock_t5_1m ON first column, best of {} runs", options.runs_)
+            << std::endl;
+  std::cout << fmt::format("{:>12} {:>8} {:>10} {:>10} {:>10} {:>10} {:>14} {:>8}", "join", "workers", "rows",
+                           "build ms", "probe ms", "total ms", "input rows/s", "speedup")
+            << std::endl;
+  hmssql::AbstractPlanNodeRef plan =
+      std::make_shared<hmssql::HashJoinPlanNode>(output, left, right, left_key, right_key, hmssql::JoinType::INNER);
+  auto timing = RunJoin(&exec_ctx, plan, options);
+  auto serial_seconds = timing.build_seconds_ + timing.probe_seconds_;
+  PrintTiming("serial", 1, timing, serial_seconds);
+
+  for (size_t workers = 1; workers <= static_cast<size_t>(options.max_workers_); workers *= 2) {
+    // Every worker joins one partition of both sides with a table of its own
+    auto repartitioned = std::make_shared<hmssql::HashJoinPlanNode>(
+        output, std::make_shared<hmssql::RepartitionPlanNode>(left_schema, left, left_key, workers, workers),
+        std::make_shared<hmssql::RepartitionPlanNode>(right_schema, right, right_key, workers, workers), left_key,
+        right_key, hmssql::JoinType::INNER);
+    plan = std::make_shared<hmssql::GatherPlanNode>(output, repartitioned, workers);
+    PrintTiming("repartition", workers, RunJoin(&exec_ctx, plan, options), serial_seconds);
+
+    auto radix = std::make_shared<hmssql::HashJoinPlanNode>(output, left, right, left_key, right_key,
+                                                            hmssql::JoinType::INNER, workers);
+    plan = std::make_shared<hmssql::GatherPlanNode>(output, radix, workers);
+    PrintTiming("radix", workers, RunJoin(&exec_ctx, plan, options), serial_seconds);
+  }
+  return 0;
+}
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// log_volume_bench.cpp
+//
+// Identification: tools/bench/log_volume_bench.cpp
+//
+// Measures how many bytes of WAL a single-column UPDATE of a wide row costs
+// with full before/after images and with delta records, each with and
+// without log block compression (log_compression).
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "fmt/format.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/table/table_heap.h"
+
+namespace {
+
+void RemoveDatabaseFiles(const std::string &db_file) {
+  auto base = std::filesystem::path(db_file).stem().string();
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    if (entry.path().filename().string().rfind(base + ".", 0) == 0) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+auto MakeSchema() -> hmssql::Schema {
+  std::vector<hmssql::Column> columns{hmssql::Column("id", hmssql::TypeId::INTEGER)};
+  for (int i = 0; i < 8; i++) {
+    columns.emplace_back(fmt::format("metric_{}", i), hmssql::TypeId::BIGINT);
+  }
+  columns.emplace_back("name", hmssql::TypeId::VARCHAR, 64);
+  columns.emplace_back("description", hmssql::TypeId::VARCHAR, 128);
+  return hmssql::Schema(columns);
+}
+
+auto MakeRow(const hmssql::Schema &schema, int id, int64_t version) -> hmssql::Tuple {
+  std::vector<hmssql::Value> values{hmssql::Value(hmssql::TypeId::INTEGER, id)};
+  for (int i = 0; i < 8; i++) {
+    values.emplace_back(hmssql::TypeId::BIGINT, static_cast<int64_t>(id) * 1000 + i + (i == 3 ? version : 0));
+  }
+  values.emplace_back(hmssql::TypeId::VARCHAR, fmt::format("customer-{:06}", id));
+  values.emplace_back(hmssql::TypeId::VARCHAR, fmt::format("account opened in branch {} with plan {}", id % 17, id % 5));
+  return {values, &schema};
+}
+
+void RunMode(bool delta, bool compression, int rows, int rounds) {
+  const std::string db_file = "log_volume_bench.db";
+  RemoveDatabaseFiles(db_file);
+  hmssql::SetLogCompression(compression);
+
+  auto disk_manager = std::make_unique<hmssql::DiskManager>(db_file);
+  auto log_manager = std::make_unique<hmssql::LogManager>(disk_manager.get());
+  hmssql::enable_logging = true;
+  auto bpm = std::make_unique<hmssql::BufferPoolManagerInstance>(64, disk_manager.get(), hmssql::LRUK_REPLACER_K,
+                                                                 log_manager.get());
+  auto schema = MakeSchema();
+  auto heap = std::make_unique<hmssql::TableHeap>(bpm.get(), log_manager.get());
+
+  std::vector<hmssql::RID> rids(rows);
+  for (int i = 0; i < rows; i++) {
+    heap->InsertTuple(MakeRow(schema, i, 0), &rids[i]);
+  }
+  log_manager->FlushAllLogs();
+
+  uint64_t tail_before = disk_manager->GetLogTail();
+  int updates = 0;
+  for (int round = 1; round <= rounds; round++) {
+    for (int i = 0; i < rows; i++) {
+      if (heap->UpdateTuple(MakeRow(schema, i, round), rids[i], delta ? &schema : nullptr)) {
+        updates++;
+      }
+    }
+  }
+  log_manager->FlushAllLogs();
+  uint64_t log_bytes = disk_manager->GetLogTail() - tail_before;
+
+  std::cout << fmt::format("{:<6} {:<12} {:>10} {:>14} {:>16.1f}", delta ? "delta" : "full",
+                           compression ? "compressed" : "raw", updates, log_bytes,
+                           static_cast<double>(log_bytes) / updates)
+            << std::endl;
+
+  heap.reset();
+  bpm.reset();
+  log_manager.reset();
+  disk_manager->ShutDown();
+  disk_manager.reset();
+  RemoveDatabaseFiles(db_file);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  int rows = 10000;
+  int rounds = 5;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+      rows = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+      rounds = std::max(1, std::stoi(argv[++i]));
+    }
+  }
+
+  std::cout << fmt::format("UPDATE of one BIGINT column in an 11-column row, {} rows x {} rounds", rows, rounds)
+            << std::endl;
+  std::cout << fmt::format("{:<6} {:<12} {:>10} {:>14} {:>16}", "record", "log blocks", "updates", "log bytes",
+                           "bytes/update")
+            << std::endl;
+  for (bool delta : {false, true}) {
+    for (bool compression : {false, true}) {
+      RunMode(delta, compression, rows, rounds);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// scan_bench.cpp
+//
+// Identification: tools/bench/scan_bench.cpp
+//
+// Filtered sequential scan of a table of one million rows, serial and as a
+// Gather over morsel-driven partial scans (SET max_parallel_workers = n).
+// Each is run without a transaction, in a snapshot of the table, and in a
+// snapshot while an open transaction has updated every hundredth row, so
+// every page has version chains the scan has to look at.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/gather_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/thread_pool.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager.h"
+#include "type/value_factory.h"
+
+namespace {
+
+struct Options {
+  int rows_{1000000};
+  int max_workers_{static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+  int runs_{3};
+};
+
+void RemoveDatabaseFiles(const std::string &db_file) {
+  auto base = std::filesystem::path(db_file).stem().string();
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    if (entry.path().filename().string().rfind(base + ".", 0) == 0) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+/** @return the number of tuples the scan produced, the best time of the runs goes to seconds */
+auto RunScan(hmssql::ExecutorContext *exec_ctx, const hmssql::AbstractPlanNodeRef &plan, const Options &options,
+             double *seconds) -> uint64_t {
+  uint64_t rows = 0;
+  *seconds = 0;
+  for (int run = 0; run < options.runs_; run++) {
+    auto start = std::chrono::steady_clock::now();
+    auto executor = hmssql::ExecutorFactory::CreateExecutor(exec_ctx, plan);
+    executor->Init();
+    hmssql::TupleBatch batch;
+    rows = 0;
+    while (executor->NextBatch(&batch)) {
+      rows += batch.Size();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *seconds = run == 0 ? elapsed : std::min(*seconds, elapsed);
+  }
+  return rows;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+      options.rows_ = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+      options.max_workers_ = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+      options.runs_ = std::max(1, std::stoi(argv[++i]));
+    }
+  }
+
+  const std::string db_file = "scan_bench.db";
+  RemoveDatabaseFiles(db_file);
+  {
+    hmssql::DiskManager disk_manager(db_file);
+    // Large enough to hold the table, so the scan measures the executor and not the disk
+    hmssql::BufferPoolManagerInstance bpm(16384, &disk_manager, hmssql::LRUK_REPLACER_K, nullptr);
+    hmssql::Catalog catalog(&bpm, nullptr);
+    hmssql::ThreadPool thread_pool;
+    hmssql::TransactionManager txn_mgr;
+
+    hmssql::Schema schema({hmssql::Column("id", hmssql::TypeId::INTEGER),
+                           hmssql::Column("val", hmssql::TypeId::INTEGER)});
+    auto *table = catalog.CreateTable("scan_1m", schema);
+    auto make_row = [&](int i) {
+      std::vector<hmssql::Value> values{hmssql::ValueFactory::GetIntegerValue(i),
+                                        hmssql::ValueFactory::GetIntegerValue(i % 100)};
+      return hmssql::Tuple(values, &table->schema_);
+    };
+    std::vector<hmssql::RID> updated_rids;
+    for (int i = 0; i < options.rows_; i++) {
+      hmssql::RID rid;
+      table->table_->InsertTuple(make_row(i), &rid);
+      if (i % 100 == 0) {
+        updated_rids.push_back(rid);
+      }
+    }
+
+    // val < 10 keeps a tenth of the rows
+    auto predicate = std::make_shared<hmssql::ComparisonExpression>(
+        std::make_shared<hmssql::ColumnValueExpression>(0, 1, hmssql::TypeId::INTEGER),
+        std::make_shared<hmssql::ConstantValueExpression>(hmssql::ValueFactory::GetIntegerValue(10)),
+        hmssql::ComparisonType::LessThan);
+    auto output = std::make_shared<const hmssql::Schema>(schema);
+
+    std::cout << fmt::format("scan_1m ({} rows), filter val < 10, best of {} runs", options.rows_, options.runs_)
+              << std::endl;
+    std::cout << fmt::format("{:>10} {:>8} {:>10} {:>10} {:>14} {:>8}", "snapshot", "workers", "rows", "ms", "rows/s",
+                             "speedup")
+              << std::endl;
+    hmssql::Transaction *writer = nullptr;
+    for (const std::string &snapshot : {"none", "txn", "chains"}) {
+      if (snapshot == "chains") {
+        // The rows keep their values, the scans read the images the writer replaced
+        writer = txn_mgr.Begin();
+        for (size_t i = 0; i < updated_rids.size(); i++) {
+          table->table_->UpdateTuple(make_row(static_cast<int>(i * 100)), updated_rids[i], &table->schema_, writer);
+        }
+      }
+      auto *txn = snapshot == "none" ? nullptr : txn_mgr.Begin();
+      hmssql::ExecutorContext exec_ctx(txn, &catalog, &bpm, nullptr, &thread_pool);
+      double serial_seconds = 0;
+      for (int workers = 1; workers <= options.max_workers_; workers *= 2) {
+        hmssql::AbstractPlanNodeRef plan =
+            std::make_shared<hmssql::SeqScanPlanNode>(output, table->oid_, table->name_, predicate);
+        if (workers > 1) {
+          plan = std::make_shared<hmssql::GatherPlanNode>(output, plan, workers);
+        }
+        double seconds;
+        auto rows = RunScan(&exec_ctx, plan, options, &seconds);
+        if (workers == 1) {
+          serial_seconds = seconds;
+        }
+        std::cout << fmt::format("{:>10} {:>8} {:>10} {:>10.1f} {:>14.0f} {:>7.2f}x", snapshot, workers, rows,
+                                 seconds * 1000, static_cast<double>(options.rows_) / seconds,
+                                 serial_seconds / seconds)
+                  << std::endl;
+      }
+      if (txn != nullptr) {
+        txn_mgr.Commit(txn);
+      }
+    }
+    txn_mgr.Abort(writer);
+    disk_manager.ShutDown();
+  }
+  RemoveDatabaseFiles(db_file);
+  return 0;
+}
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// sort_bench.cpp
+//
+// Identification: tools/bench/sort_bench.cpp
+//
+// Sorts the one million row mock table __mock_t4_1m on its first column,
+// descending, once in memory and once with a work_mem of a tenth of the
+// input, so the sort spills runs and merges them. Every sort is checked:
+// the rows have to come out in order, all of them and each exactly once.
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "execution/executor_context.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/mock_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/thread_pool.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager.h"
+
+namespace {
+
+constexpr const char *MOCK_TABLE = "__mock_t4_1m";
+/** __mock_t4_1m holds the values 0 to 499999 of its first column twice, the second column is ten times the first */
+constexpr int64_t MOCK_DISTINCT = 500000;
+
+struct Options {
+  size_t work_mem_{0};
+  int max_workers_{static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))};
+};
+
+struct SortResult {
+  double seconds_{0};
+  uint64_t rows_{0};
+  bool ordered_{true};
+  int64_t sum_{0};
+};
+
+void RemoveDatabaseFiles(const std::string &db_file) {
+  auto base = std::filesystem::path(db_file).stem().string();
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    if (entry.path().filename().string().rfind(base + ".", 0) == 0) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+/** @return the bytes the rows of the mock table take while a sort holds them, their keys left out */
+auto InputBytes(hmssql::ExecutorContext *exec_ctx, const hmssql::AbstractPlanNodeRef &scan) -> size_t {
+  auto executor = hmssql::ExecutorFactory::CreateExecutor(exec_ctx, scan);
+  executor->Init();
+  size_t bytes = 0;
+  hmssql::Tuple tuple;
+  hmssql::RID rid;
+  while (executor->Next(&tuple, &rid)) {
+    bytes += sizeof(hmssql::Tuple) + tuple.GetLength();
+  }
+  return bytes;
+}
+
+auto RunSort(hmssql::ExecutorContext *exec_ctx, const hmssql::AbstractPlanNodeRef &plan) -> SortResult {
+  SortResult result;
+  auto start = std::chrono::steady_clock::now();
+  auto executor = hmssql::ExecutorFactory::CreateExecutor(exec_ctx, plan);
+  executor->Init();
+  hmssql::Tuple tuple;
+  hmssql::RID rid;
+  int32_t previous = MOCK_DISTINCT;
+  while (executor->Next(&tuple, &rid)) {
+    auto x = tuple.GetValue(&plan->OutputSchema(), 0).GetAs<int32_t>();
+    auto y = tuple.GetValue(&plan->OutputSchema(), 1).GetAs<int32_t>();
+    result.ordered_ = result.ordered_ && x <= previous && y == x * 10;
+    result.sum_ += x;
+    result.rows_++;
+    previous = x;
+  }
+  result.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+/** @return whether the sort produced every row of the mock table once, in order */
+auto PrintResult(const std::string &sort, size_t workers, size_t work_mem, const SortResult &result) -> bool {
+  bool complete = result.rows_ == 2 * MOCK_DISTINCT && result.sum_ == MOCK_DISTINCT * (MOCK_DISTINCT - 1);
+  bool ok = result.ordered_ && complete;
+  std::cout << fmt::format("{:>10} {:>8} {:>14} {:>10} {:>10.1f} {:>14.0f} {:>6}", sort, workers, work_mem / 1024,
+                           result.rows_, result.seconds_ * 1000, result.rows_ / result.seconds_, ok ? "ok" : "FAILED")
+            << std::endl;
+  return ok;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--work-mem-kb") == 0 && i + 1 < argc) {
+      options.work_mem_ = static_cast<size_t>(std::max(1, std::stoi(argv[++i]))) * 1024;
+    } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+      options.max_workers_ = std::max(1, std::stoi(argv[++i]));
+    }
+  }
+
+  const std::string db_file = "sort_bench.db";
+  RemoveDatabaseFiles(db_file);
+  bool ok = true;
+  {
+    // The spilled runs go to the temporary file of the context, the database file is left alone
+    hmssql::DiskManager disk_manager(db_file);
+    hmssql::BufferPoolManagerInstance bpm(256, &disk_manager, hmssql::LRUK_REPLACER_K, nullptr);
+    hmssql::ThreadPool thread_pool;
+    hmssql::ExecutorContext exec_ctx(nullptr, nullptr, &bpm, nullptr, &thread_pool);
+
+    auto schema = std::make_shared<const hmssql::Schema>(hmssql::GetMockTableSchemaOf(MOCK_TABLE));
+    hmssql::AbstractPlanNodeRef scan = std::make_shared<hmssql::MockScanPlanNode>(schema, MOCK_TABLE);
+    std::vector<std::pair<hmssql::OrderByType, hmssql::AbstractExpressionRef>> order_by{
+        {hmssql::OrderByType::DESC, std::make_shared<hmssql::ColumnValueExpression>(0, 0, hmssql::TypeId::INTEGER)}};
+
+    auto input_bytes = InputBytes(&exec_ctx, scan);
+    auto work_mem = options.work_mem_ != 0 ? options.work_mem_ : input_bytes / 10;
+    // Room for the keys too, so the sort does not spill
+    auto in_memory = input_bytes * 4;
+    std::cout << fmt::format("{} ORDER BY x DESC, input {} KB, spilling with work_mem {} KB", MOCK_TABLE,
+                             input_bytes / 1024, work_mem / 1024)
+              << std::endl;
+    std::cout << fmt::format("{:>10} {:>8} {:>14} {:>10} {:>10} {:>14} {:>6}", "sort", "workers", "work_mem (KB)",
+                             "rows", "ms", "rows/s", "check")
+              << std::endl;
+
+    for (int workers = 1; workers <= options.max_workers_; workers *= 2) {
+      // A serial sort is one without workers of its own
+      auto plan = std::make_shared<hmssql::SortPlanNode>(schema, scan, order_by, workers == 1 ? 0 : workers);
+      exec_ctx.SetWorkMem(in_memory);
+      ok = PrintResult("in memory", workers, in_memory, RunSort(&exec_ctx, plan)) && ok;
+      exec_ctx.SetWorkMem(work_mem);
+      ok = PrintResult("spilled", workers, work_mem, RunSort(&exec_ctx, plan)) && ok;
+    }
+    std::cout << fmt::format("temporary file {} pages, database file {} pages", exec_ctx.GetTmpFile()->GetNumPages(),
+                             disk_manager.GetNumPages())
+              << std::endl;
+    disk_manager.ShutDown();
+  }
+  RemoveDatabaseFiles(db_file);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         HMSSQL
+//
+// ycsb_bench.cpp
+//
+// Identification: tools/bench/ycsb_bench.cpp
+//
+// YCSB-style point read / update transactions on the test_1 table of
+// TableGenerator, run with row locking and with optimistic concurrency
+// control (SET concurrency_control = locking / optimistic).
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "catalog/table_generator.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager.h"
+
+namespace {
+
+using hmssql::ConcurrencyControl;
+
+/** Zipfian keys in [0, n) as in YCSB (Gray et al.), key 0 is the most popular. theta 0 gives uniform keys. */
+class ZipfGenerator {
+ public:
+  ZipfGenerator(uint64_t n, double theta) : n_(n), theta_(theta) {
+    if (theta_ == 0) {
+      return;
+    }
+    double zeta2 = Zeta(2);
+    zetan_ = Zeta(n_);
+    alpha_ = 1.0 / (1.0 - theta_);
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n_), 1.0 - theta_)) / (1.0 - zeta2 / zetan_);
+  }
+
+  auto Next(std::mt19937_64 *rng) -> uint64_t {
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    double u = dist(*rng);
+    if (theta_ == 0) {
+      return std::min(n_ - 1, static_cast<uint64_t>(u * static_cast<double>(n_)));
+    }
+    double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min(n_ - 1,
+                    static_cast<uint64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_)));
+  }
+
+ private:
+  auto Zeta(uint64_t n) const -> double {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta_);
+    }
+    return sum;
+  }
+
+  uint64_t n_;
+  double theta_;
+  double zetan_{0};
+  double alpha_{0};
+  double eta_{0};
+};
+
+struct Workload {
+  const char *name_;
+  /** Share of the operations that update a row, the rest read one. */
+  double update_ratio_;
+};
+
+struct Options {
+  int threads_{4};
+  int ops_per_txn_{4};
+  double seconds_{2};
+};
+
+struct Result {
+  uint64_t commits_{0};
+  uint64_t aborts_{0};
+};
+
+void RemoveDatabaseFiles(const std::string &db_file) {
+  auto base = std::filesystem::path(db_file).stem().string();
+  for (const auto &entry : std::filesystem::directory_iterator(".")) {
+    if (entry.path().filename().string().rfind(base + ".", 0) == 0) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+}
+
+/** One transaction of ops_per_txn point operations. The writes do what UpdateExecutor does for a row. */
+auto RunTransaction(hmssql::TransactionManager *txn_manager, hmssql::LockManager *lock_manager,
+                    hmssql::TableInfo *table, const std::vector<hmssql::RID> &rids, ConcurrencyControl mode,
+                    const Workload &workload, const Options &options, ZipfGenerator *keys, std::mt19937_64 *rng)
+    -> bool {
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  auto *txn = txn_manager->Begin(mode);
+  bool ok = lock_manager->LockTable(txn, hmssql::LockMode::INTENTION_EXCLUSIVE, table->oid_);
+  for (int i = 0; ok && i < options.ops_per_txn_; i++) {
+    // Scatter the popular keys over the table like YCSB does, so they don't share a page
+    const auto &rid = rids[(keys->Next(rng) * 0x9E3779B97F4A7C15ULL) % rids.size()];
+    hmssql::Tuple tuple;
+    if (coin(*rng) >= workload.update_ratio_) {
+      ok = table->table_->GetTuple(rid, &tuple, txn);
+      continue;
+    }
+    if (mode == ConcurrencyControl::LOCKING) {
+      ok = lock_manager->LockRow(txn, hmssql::LockMode::EXCLUSIVE, table->oid_, rid);
+    }
+    ok = ok && table->table_->GetTuple(rid, &tuple, txn);
+    if (ok) {
+      std::vector<hmssql::Value> values;
+      for (uint32_t col = 0; col < table->schema_.GetColumnCount(); col++) {
+        values.push_back(tuple.GetValue(&table->schema_, col));
+      }
+      values.back() = values.back().Add(hmssql::Value(hmssql::TypeId::INTEGER, 1));
+      ok = table->table_->UpdateTuple(hmssql::Tuple(values, &table->schema_), rid, &table->schema_, txn);
+    }
+  }
+  if (!ok) {
+    txn_manager->Abort(txn);
+    return false;
+  }
+  return txn_manager->Commit(txn);
+}
+
+void RunMode(const Workload &workload, double theta, ConcurrencyControl mode, const Options &options) {
+  const std::string db_file = "ycsb_bench.db";
+  RemoveDatabaseFiles(db_file);
+  {
+    hmssql::DiskManager disk_manager(db_file);
+    hmssql::BufferPoolManagerInstance bpm(256, &disk_manager, hmssql::LRUK_REPLACER_K, nullptr);
+    hmssql::Catalog catalog(&bpm, nullptr);
+    hmssql::LockManager lock_manager;
+    lock_manager.StartDeadlockDetection();
+    hmssql::TransactionManager txn_manager(nullptr, &lock_manager);
+
+    hmssql::ExecutorContext exec_ctx(nullptr, &catalog, &bpm);
+    hmssql::TableGenerator generator(&exec_ctx);
+    generator.GenerateTestTables();
+    auto *table = catalog.GetTable("test_1");
+    std::vector<hmssql::RID> rids;
+    for (auto it = table->table_->Begin(); it != table->table_->End(); ++it) {
+      rids.push_back(it->GetRid());
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<Result> results(options.threads_);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < options.threads_; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937_64 rng(t);
+        ZipfGenerator keys(rids.size(), theta);
+        while (!stop) {
+          if (RunTransaction(&txn_manager, &lock_manager, table, rids, mode, workload, options, &keys, &rng)) {
+            results[t].commits_++;
+          } else {
+            results[t].aborts_++;
+          }
+        }
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds_));
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    lock_manager.StopDeadlockDetection();
+
+    Result total;
+    for (const auto &result : results) {
+      total.commits_ += result.commits_;
+      total.aborts_ += result.aborts_;
+    }
+    auto attempts = std::max<uint64_t>(1, total.commits_ + total.aborts_);
+    std::cout << fmt::format("{:<10} {:>6.2f} {:<11} {:>8} {:>12.0f} {:>10.2f}", workload.name_, theta,
+                             mode == ConcurrencyControl::LOCKING ? "locking" : "optimistic", options.threads_,
+                             static_cast<double>(total.commits_) / elapsed,
+                             100.0 * static_cast<double>(total.aborts_) / static_cast<double>(attempts))
+              << std::endl;
+    disk_manager.ShutDown();
+  }
+  RemoveDatabaseFiles(db_file);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      options.threads_ = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+      options.ops_per_txn_ = std::max(1, std::stoi(argv[++i]));
+    } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      options.seconds_ = std::max(0.1, std::stod(argv[++i]));
+    }
+  }
+
+  // YCSB A is update heavy, B mostly reads
+  const std::vector<Workload> workloads{{"A (50/50)", 0.5}, {"B (95/5)", 0.05}};
+  const std::vector<double> thetas{0.0, 0.99};
+
+  std::cout << fmt::format("test_1 ({} rows), {} operations per transaction", hmssql::TEST1_SIZE,
+                           options.ops_per_txn_)
+            << std::endl;
+  std::cout << fmt::format("{:<10} {:>6} {:<11} {:>8} {:>12} {:>10}", "workload", "theta", "mode", "threads",
+                           "commits/s", "aborts %")
+            << std::endl;
+  for (const auto &workload : workloads) {
+    for (auto theta : thetas) {
+      RunMode(workload, theta, ConcurrencyControl::LOCKING, options);
+      RunMode(workload, theta, ConcurrencyControl::OPTIMISTIC, options);
+    }
+  }
+  return 0;
+}
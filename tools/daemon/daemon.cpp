@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <string>
 #include "binder/binder.h"
@@ -13,6 +17,9 @@
 
 using json = nlohmann::json;
 
+/** The HTTP header carrying the id of the session of a client, its transaction and variables */
+constexpr const char *SESSION_HEADER = "X-HMSSQL-Session";
+
 auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
   size_t computed_width = 0;
   utf8proc_ssize_t n;
@@ -29,11 +36,11 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 }
 
 // Function to handle SQL queries and return JSON response
-auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query) -> json {
+auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query, std::string *session = nullptr) -> json {
   json response;
   try {
     auto writer = hmssql::FortTableWriter();
-    hmssql.ExecuteSql(query, writer);
+    hmssql.ExecuteSql(query, writer, session);
     for (const auto &table : writer.tables_) {
       std::stringstream ss;
       ss << table;
@@ -49,9 +56,41 @@ auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query) -> json {
   return response;
 }
 
+/**
+ * @return whether name can name a backup: a single path component of letters, digits, '-', '_' and '.' that starts
+ * with a letter or digit, so it cannot leave the backup root
+ */
+auto IsValidBackupName(const std::string &name) -> bool {
+  if (name.empty() || name.size() > 128 || std::isalnum(static_cast<unsigned char>(name[0])) == 0) {
+    return false;
+  }
+  return std::all_of(name.begin(), name.end(), [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '-' || c == '_' || c == '.';
+  });
+}
+
+auto ErrorResponse(const std::string &message) -> json {
+  json response;
+  response["status"] = "error";
+  response["message"] = message;
+  return response;
+}
+
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
+  // Backups requested over HTTP are written below this directory only
+  std::string backup_root = "backups";
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--restore") == 0) {
+      hmssql::HMSSQL::RestoreBackup(argv[i + 1], "test.db");
+      std::cout << "Restored test.db from " << argv[i + 1] << std::endl;
+    }
+    if (strcmp(argv[i], "--backup-root") == 0) {
+      backup_root = argv[i + 1];
+    }
+  }
+
   auto hmssql = std::make_unique<hmssql::HMSSQL>("test.db");
 
   // Initialize spdlog
@@ -69,7 +108,34 @@ auto main(int argc, char **argv) -> int {
   svr.Post("/query", [&](const httplib::Request &req, httplib::Response &res) {
     auto query = req.body;
     spdlog::info("Received query: {}", query);
-    auto response = HandleSqlQuery(*hmssql, query);
+    // \backup writes wherever it is told to, over HTTP only /backup takes backups
+    if (hmssql::StringUtil::StartsWith(hmssql::StringUtil::Trim(query), "\\backup")) {
+      res.status = 403;
+      res.set_content(ErrorResponse("backups are taken with POST /backup").dump(), "application/json");
+      return;
+    }
+    // The first BEGIN or SET of a client issues a session id, its later statements pass it back in the same header
+    auto session = req.get_header_value(SESSION_HEADER);
+    auto response = HandleSqlQuery(*hmssql, query, &session);
+    if (!session.empty()) {
+      res.set_header(SESSION_HEADER, session);
+      response["session"] = session;
+    }
+    res.set_content(response.dump(), "application/json");
+  });
+
+  // Online backup, the body is the name of the backup, it is written to that directory of the backup root
+  svr.Post("/backup", [&](const httplib::Request &req, httplib::Response &res) {
+    auto name = hmssql::StringUtil::Trim(req.body);
+    spdlog::info("Received backup request: {}", name);
+    if (!IsValidBackupName(name)) {
+      res.status = 400;
+      res.set_content(ErrorResponse("a backup name is letters, digits, '-', '_' and '.', starting with a letter or digit")
+                          .dump(),
+                      "application/json");
+      return;
+    }
+    auto response = HandleSqlQuery(*hmssql, "\\backup " + (std::filesystem::path(backup_root) / name).string());
     res.set_content(response.dump(), "application/json");
   });
 
@@ -80,7 +146,8 @@ auto main(int argc, char **argv) -> int {
   svr.set_default_headers({
     {"Access-Control-Allow-Origin", "*"},
     {"Access-Control-Allow-Methods", "GET, POST, OPTIONS"},
-    {"Access-Control-Allow-Headers", "Content-Type"}
+    {"Access-Control-Allow-Headers", std::string("Content-Type, ") + SESSION_HEADER},
+    {"Access-Control-Expose-Headers", SESSION_HEADER}
   });
 
   // Start listening
@@ -14,6 +14,9 @@
 
 using json = nlohmann::json;
 
+/** The HTTP header carrying the id of the session of a client, its transaction and variables */
+constexpr const char *SESSION_HEADER = "X-HMSSQL-Session";
+
 auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
   size_t computed_width = 0;
   utf8proc_ssize_t n;
@@ -30,11 +33,11 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 }
 
 // Function to handle SQL queries and return JSON response
-auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query) -> json {
+auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query, std::string *session = nullptr) -> json {
   json response;
   try {
     auto writer = hmssql::FortTableWriter();
-    hmssql.ExecuteSql(query, writer);
+    hmssql.ExecuteSql(query, writer, session);
     for (const auto &table : writer.tables_) {
       std::stringstream ss;
       ss << table;
@@ -54,6 +57,13 @@ auto HandleSqlQuery(hmssql::HMSSQL &hmssql, const std::string &query) -> json {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
+  for (int i = 1; i + 1 < argc; i++) {
+    if (strcmp(argv[i], "--restore") == 0) {
+      hmssql::HMSSQL::RestoreBackup(argv[i + 1], "test.db");
+      std::cout << "Restored test.db from " << argv[i + 1] << std::endl;
+    }
+  }
+
   auto hmssql = std::make_unique<hmssql::HMSSQL>("test.db");
 
   // Initialize spdlog
@@ -98,7 +108,22 @@ auto main(int argc, char **argv) -> int {
   svr.Post("/query", [&](const httplib::Request &req, httplib::Response &res) {
     auto query = req.body;
     spdlog::info("Received query: {}", query);
-    auto response = HandleSqlQuery(*hmssql, query);
+    // \backup writes wherever it is told to, only the local prompt takes backups
+    if (hmssql::StringUtil::StartsWith(hmssql::StringUtil::Trim(query), "\\backup")) {
+      res.status = 403;
+      json response;
+      response["status"] = "error";
+      response["message"] = "backups are taken from the shell prompt";
+      res.set_content(response.dump(), "application/json");
+      return;
+    }
+    // The first BEGIN or SET of a client issues a session id, its later statements pass it back in the same header
+    auto session = req.get_header_value(SESSION_HEADER);
+    auto response = HandleSqlQuery(*hmssql, query, &session);
+    if (!session.empty()) {
+      res.set_header(SESSION_HEADER, session);
+      response["session"] = session;
+    }
     res.set_content(response.dump(), "application/json");
   });
 
@@ -110,6 +135,8 @@ auto main(int argc, char **argv) -> int {
   linenoiseSetMultiLine(1);
 
   auto prompt = use_emoji_prompt ? emoji_prompt : default_prompt;
+  // The session the shell opened with BEGIN or SET
+  std::string session;
 
   while (true) {
     std::string query;
@@ -157,7 +184,7 @@ auto main(int argc, char **argv) -> int {
 
     try {
       auto writer = hmssql::FortTableWriter();
-      hmssql->ExecuteSql(query, writer);
+      hmssql->ExecuteSql(query, writer, &session);
       for (const auto &table : writer.tables_) {
         std::cout << table;
       }
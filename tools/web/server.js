@@ -32,8 +32,10 @@ app.use(express.static('static'));
 // Proxy requests to the daemon
 app.post('/query', express.text(), async (req, res) => {
     try {
+        const session = req.get('X-HMSSQL-Session');
         const response = await fetch('http://localhost:8080/query', {
             method: 'POST',
+            headers: session ? { 'X-HMSSQL-Session': session } : {},
             body: req.body
         });
         const data = await response.json();
@@ -115,6 +115,9 @@ document.addEventListener('DOMContentLoaded', () => {
         }
     });
 
+    // The session the first BEGIN or SET opened, passed back until it ends
+    let session = '';
+
     // Execute query button handler
     executeBtn.addEventListener('click', async () => {
         const query = queryInput.value.trim();
@@ -122,9 +125,11 @@ document.addEventListener('DOMContentLoaded', () => {
             try {
                 const response = await fetch('/query', {
                     method: 'POST',
+                    headers: session ? { 'X-HMSSQL-Session': session } : {},
                     body: query
                 });
                 const data = await response.json();
+                session = data.session || '';
                 displayResults(data);
             } catch (error) {
                 console.error('Error:', error);